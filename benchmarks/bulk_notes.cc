@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+#include "music.h"
+
+#include <vector>
+
+/// @brief Notes of a long MIDI file, spread over every note
+static std::vector<uint8_t> midi_notes() {
+    std::vector<uint8_t> notes(1 << 16);
+    for ( size_t i = 0; i < notes.size(); i++ )
+        notes[i] = uint8_t((i * 37 + i / 7) % 128);
+    return notes;
+}
+
+/// @brief Baseline: one Note at a time with its own operators
+static void BM_Note_Transpose(benchmark::State& state) {
+    std::vector<Note> notes;
+    for ( uint8_t n: midi_notes() )
+        notes.push_back(Note(n));
+    for ( auto _: state ) {
+        for ( Note& n: notes )
+            n += 5;
+        benchmark::DoNotOptimize(notes.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * notes.size()));
+}
+BENCHMARK(BM_Note_Transpose);
+
+template <class L>
+static void BM_BulkNotes_Transpose(benchmark::State& state) {
+    std::vector<uint8_t> notes = midi_notes();
+    for ( auto _: state ) {
+        BulkNotes::transpose<L>(notes, 5);
+        benchmark::DoNotOptimize(notes.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * notes.size()));
+}
+
+template <class L>
+static void BM_BulkNotes_PitchClasses(benchmark::State& state) {
+    std::vector<uint8_t> notes = midi_notes();
+    std::vector<uint8_t> pcs(notes.size());
+    for ( auto _: state ) {
+        BulkNotes::pitch_classes<L>(notes, pcs.data());
+        benchmark::DoNotOptimize(pcs.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * notes.size()));
+}
+
+template <class L>
+static void BM_BulkNotes_Histogram(benchmark::State& state) {
+    std::vector<uint8_t> notes = midi_notes();
+    for ( auto _: state )
+        benchmark::DoNotOptimize(BulkNotes::histogram<L>(notes));
+    state.SetItemsProcessed(int64_t(state.iterations() * notes.size()));
+}
+
+template <class L>
+static void BM_BulkNotes_Clamp(benchmark::State& state) {
+    std::vector<uint8_t> notes = midi_notes();
+    for ( auto _: state ) {
+        BulkNotes::clamp<L>(notes, 40, 88);
+        benchmark::DoNotOptimize(notes.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * notes.size()));
+}
+
+template <class L>
+static void BM_BulkNotes_Intervals(benchmark::State& state) {
+    std::vector<uint8_t> notes = midi_notes();
+    std::vector<int8_t> steps(notes.size() - 1);
+    for ( auto _: state ) {
+        BulkNotes::intervals<L>(notes, steps.data());
+        benchmark::DoNotOptimize(steps.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * notes.size()));
+}
+
+#define BULK_NOTES_BENCHMARKS(L)                      \
+    BENCHMARK_TEMPLATE(BM_BulkNotes_Transpose, L);     \
+    BENCHMARK_TEMPLATE(BM_BulkNotes_PitchClasses, L);  \
+    BENCHMARK_TEMPLATE(BM_BulkNotes_Histogram, L);     \
+    BENCHMARK_TEMPLATE(BM_BulkNotes_Clamp, L);         \
+    BENCHMARK_TEMPLATE(BM_BulkNotes_Intervals, L)
+
+BULK_NOTES_BENCHMARKS(BulkNotes::Scalar);
+#ifdef SUPERFRET_SSE2
+BULK_NOTES_BENCHMARKS(BulkNotes::Sse2);
+#endif
+#ifdef SUPERFRET_AVX2
+BULK_NOTES_BENCHMARKS(BulkNotes::Avx2);
+#endif
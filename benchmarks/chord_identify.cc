@@ -0,0 +1,36 @@
+#include <benchmark/benchmark.h>
+#include "music.h"
+
+#include <random>
+#include <vector>
+
+/// @brief A million random voicings of 3 to 6 notes, once
+static const std::vector<Chord>& voicings() {
+    static const std::vector<Chord> chords = [] {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> size(3, 6), note(36, 84);
+        std::vector<Chord> v;
+        v.reserve(1000000);
+        for ( size_t i = 0; i < 1000000; i++ ) {
+            std::vector<Note> notes(size_t(size(rng)));
+            for ( auto& n: notes )
+                n = Note(uint8_t(note(rng)));
+            v.push_back(Chord(notes));
+        }
+        return v;
+    }();
+    return chords;
+}
+
+/// @brief Identify every voicing, as on each incoming note-on
+static void BM_Chord_Identify(benchmark::State& state) {
+    const std::vector<Chord>& chords = voicings();
+    size_t i = 0;
+    for ( auto _: state ) {
+        auto found = Chord::identify(chords[i]);
+        benchmark::DoNotOptimize(found);
+        i = i + 1 == chords.size() ? 0 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Chord_Identify);
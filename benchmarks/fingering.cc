@@ -0,0 +1,29 @@
+#include <benchmark/benchmark.h>
+#include "music.h"
+
+#include <random>
+#include <vector>
+
+/// @brief Finger a run of the major scale over the guitar's whole range
+static void BM_Fingering_ScaleRun(benchmark::State& state) {
+    Fretboard guitar = Fretboard::guitar();
+    auto run = Scale::major("E").range("E2"_note, "E6"_note);
+    for ( auto _: state )
+        benchmark::DoNotOptimize(Fingering::find(guitar, run));
+    state.SetItemsProcessed(int64_t(state.iterations() * run.size()));
+}
+BENCHMARK(BM_Fingering_ScaleRun)->Unit(benchmark::kMicrosecond);
+
+/// @brief Finger a random melody of 1024 notes in the middle of the neck
+static void BM_Fingering_Melody(benchmark::State& state) {
+    Fretboard guitar = Fretboard::guitar();
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> note(52, 76);
+    std::vector<Note> melody(1024);
+    for ( auto& n: melody )
+        n = Note(uint8_t(note(rng)));
+    for ( auto _: state )
+        benchmark::DoNotOptimize(Fingering::find(guitar, melody));
+    state.SetItemsProcessed(int64_t(state.iterations() * melody.size()));
+}
+BENCHMARK(BM_Fingering_Melody)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+#include "music.h"
+
+#include <vector>
+
+/// @brief The chord as it was, owning its notes in a std::vector
+class VectorChord {
+    std::vector<Note> _notes;
+
+    public:
+        VectorChord(Note root, const std::vector<uint8_t>& degrees) {
+            _notes.push_back(root);
+            for ( auto d: degrees )
+                _notes.push_back(root + d);
+        }
+
+        size_t size() const {
+            return _notes.size();
+        }
+
+        Note operator[](size_t i) const {
+            return _notes[i];
+        }
+
+        PcSet pcset() const {
+            PcSet set;
+            for ( auto n: _notes )
+                set = set.with(n.note());
+            return set;
+        }
+};
+
+/// @brief The scale as it was, owning its tones in a std::vector
+class VectorScale {
+    std::vector<Tone> _tones;
+
+    public:
+        VectorScale(Tone root, const std::vector<uint8_t>& degrees) {
+            for ( auto d: degrees )
+                _tones.push_back(root + d);
+        }
+
+        bool contains(Note note) const {
+            for ( auto t: _tones )
+                if ( t == note.tone() )
+                    return true;
+            return false;
+        }
+};
+
+static const std::vector<uint8_t> seventh = {4, 7, 10};
+static const std::vector<uint8_t> major = {0, 2, 4, 5, 7, 9, 11};
+
+/// @brief Build a dominant 7th on every MIDI note and take its pitch classes
+template <class C>
+static void BM_Chord_Construct(benchmark::State& state) {
+    for ( auto _: state )
+        for ( uint8_t root = 0; root < 116; root++ ) {
+            C chord(Note(root), seventh);
+            benchmark::DoNotOptimize(chord.pcset());
+        }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 116);
+}
+BENCHMARK_TEMPLATE(BM_Chord_Construct, VectorChord);
+BENCHMARK_TEMPLATE(BM_Chord_Construct, Chord);
+
+/// @brief Copy a list of 4096 candidate chords, as when caching or sorting them
+template <class C>
+static void BM_Chord_CopyList(benchmark::State& state) {
+    std::vector<C> chords;
+    for ( size_t i = 0; i < 4096; i++ )
+        chords.emplace_back(Note(uint8_t(36 + i % 60)), seventh);
+    for ( auto _: state ) {
+        std::vector<C> copy = chords;
+        benchmark::DoNotOptimize(copy.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 4096);
+}
+BENCHMARK_TEMPLATE(BM_Chord_CopyList, VectorChord);
+BENCHMARK_TEMPLATE(BM_Chord_CopyList, Chord);
+
+/// @brief Build the major scale on every tone and test every MIDI note against it
+template <class S>
+static void BM_Scale_Contains(benchmark::State& state) {
+    for ( auto _: state )
+        for ( uint8_t root = 0; root < 12; root++ ) {
+            S scale(Tone(root), major);
+            size_t found = 0;
+            for ( uint8_t n = 0; n < 128; n++ )
+                found += scale.contains(Note(n));
+            benchmark::DoNotOptimize(found);
+        }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 12 * 128);
+}
+BENCHMARK_TEMPLATE(BM_Scale_Contains, VectorScale);
+BENCHMARK_TEMPLATE(BM_Scale_Contains, Scale);
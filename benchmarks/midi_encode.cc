@@ -0,0 +1,150 @@
+#include <benchmark/benchmark.h>
+#include "midi.h"
+
+#include <memory>
+#include <vector>
+
+/// @brief Backend whose single port drops everything sent to it, so only
+/// encoding and the call into the backend are measured
+class NullBackend : public MidiBackend {
+    public:
+        class Discard : public Connection {
+            public:
+                void send(const uint8_t* bytes, size_t size) override {
+                    benchmark::DoNotOptimize(bytes);
+                    benchmark::DoNotOptimize(size);
+                }
+        };
+
+        std::string backend_name() const override { return "Null"; }
+        size_t count() override { return 1; }
+        std::string name(size_t) override { return "Null"; }
+        bool external(size_t) override { return false; }
+        size_t notes(size_t) override { return 0; }
+        uint16_t channel_mask(size_t) override { return 0xFFFF; }
+        std::unique_ptr<Connection> open(size_t) override { return std::make_unique<Discard>(); }
+};
+
+/// @brief Port 0 of the null backend for argument 0, of a memory sink for 1
+/// The sink's log is emptied every few thousand calls, which keeps its
+/// capacity, so its memory stays bounded without allocating
+struct Target {
+    std::shared_ptr<MidiMemorySink> sink;
+    MidiOut out;
+    size_t calls = 0;
+
+    explicit Target(const benchmark::State& state)
+        : sink(state.range(0) ? std::make_shared<MidiMemorySink>(1) : nullptr),
+          out(0, sink ? std::shared_ptr<MidiBackend>(sink) : std::make_shared<NullBackend>()) {
+        if ( sink )
+            sink->reserve(size_t(1) << 20);
+    }
+
+    void tick() {
+        if ( sink && ++calls % 4096 == 0 )
+            sink->clear();
+    }
+};
+
+/// @brief Note on and off, one message per call
+static void BM_MidiOut_Note(benchmark::State& state) {
+    Target t(state);
+    for ( auto _: state ) {
+        t.out << 60;
+        t.out >> 60;
+        t.tick();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 2);
+}
+BENCHMARK(BM_MidiOut_Note)->ArgName("sink")->Arg(0)->Arg(1);
+
+/// @brief Control change messages built with MidiMsg
+static void BM_MidiOut_Message(benchmark::State& state) {
+    Target t(state);
+    for ( auto _: state ) {
+        t.out << MidiMsg::control_change(MidiMsg::Sustain, 127);
+        t.tick();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_MidiOut_Message)->ArgName("sink")->Arg(0)->Arg(1);
+
+/// @brief A 4 note chord on and off, one batch each
+static void BM_MidiOut_Chord(benchmark::State& state) {
+    Target t(state);
+    Chord chord("C4"_note, {4, 7, 10});
+    for ( auto _: state ) {
+        t.out << chord;
+        t.out >> chord;
+        t.tick();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 8);
+}
+BENCHMARK(BM_MidiOut_Chord)->ArgName("sink")->Arg(0)->Arg(1);
+
+/// @brief 64 messages on every channel in one batch, with running status
+static void BM_MidiOut_Batch(benchmark::State& state) {
+    Target t(state);
+    std::vector<MidiMsg> msgs;
+    for ( uint8_t i = 0; i < 64; i++ )
+        msgs.push_back(MidiMsg::note_on(uint8_t(36 + i), 100, uint8_t(i / 4 % 16)));
+    for ( auto _: state ) {
+        benchmark::DoNotOptimize(t.out.send(msgs));
+        t.tick();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * msgs.size()));
+}
+BENCHMARK(BM_MidiOut_Batch)->ArgName("sink")->Arg(0)->Arg(1);
+
+/// @brief Note on and off with statistics counted, see BM_MidiOut_Note
+static void BM_MidiOut_NoteStats(benchmark::State& state) {
+    Target t(state);
+    t.out.enable_stats();
+    for ( auto _: state ) {
+        t.out << 60;
+        t.out >> 60;
+        t.tick();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 2);
+    state.counters["p99_ns"] = double(t.out.stats().latency.percentile(0.99).count());
+}
+BENCHMARK(BM_MidiOut_NoteStats)->ArgName("sink")->Arg(0)->Arg(1);
+
+/// @brief Same as BM_MidiOut_Note, without exceptions
+static void BM_MidiOut_TryNote(benchmark::State& state) {
+    Target t(state);
+    for ( auto _: state ) {
+        benchmark::DoNotOptimize(t.out.try_send(MidiMsg::note_on(60, 120)));
+        benchmark::DoNotOptimize(t.out.try_send(MidiMsg::note_off(60, 120)));
+        t.tick();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 2);
+}
+BENCHMARK(BM_MidiOut_TryNote)->ArgName("sink")->Arg(0)->Arg(1);
+
+/// @brief Sending to an unplugged port, catching what is thrown
+static void BM_MidiOut_FailThrow(benchmark::State& state) {
+    auto sink = std::make_shared<MidiMemorySink>(1);
+    MidiOut out(0, sink);
+    sink->set_count(0);
+    for ( auto _: state ) {
+        try {
+            out << 60;
+        } catch ( const MidiError& e ) {
+            benchmark::DoNotOptimize(e.kind());
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_MidiOut_FailThrow);
+
+/// @brief Sending to an unplugged port, checking the status returned
+static void BM_MidiOut_FailStatus(benchmark::State& state) {
+    auto sink = std::make_shared<MidiMemorySink>(1);
+    MidiOut out(0, sink);
+    sink->set_count(0);
+    for ( auto _: state )
+        benchmark::DoNotOptimize(out.try_send(MidiMsg::note_on(60, 120)));
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_MidiOut_FailStatus);
@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+#include "midi.h"
+
+#include <cstdio>
+#include <string>
+
+/// @brief Write a ~10 MB format 1 file of dense note streams, once
+static const std::string& big_file() {
+    static const std::string path = [] {
+        std::string p = "superfret_bench_10mb.mid";
+        MidiFileWriter out(p, 1, 480);
+        out.begin_track();
+        out.tempo(0, 500000);
+        for ( uint8_t track = 0; track < 16; track++ ) {
+            out.begin_track();
+            uint32_t tick = 0;
+            // ~4 bytes per event with running status and 1 byte deltas
+            for ( uint32_t i = 0; i < 110000; i++ ) {
+                uint8_t note = uint8_t(36 + (i * 7 + track) % 48);
+                out.write(tick, MidiMsg::note_on(note, 100, track));
+                tick += 30;
+                out.write(tick, MidiMsg::note_on(note, 0, track));
+            }
+        }
+        out.close();
+        return p;
+    }();
+    return path;
+}
+
+static size_t file_size(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    std::fseek(f, 0, SEEK_END);
+    size_t size = size_t(std::ftell(f));
+    std::fclose(f);
+    return size;
+}
+
+/// @brief Open, map and read a whole file, with tracks merged in time order
+static void BM_MidiFile_ReadMerged(benchmark::State& state) {
+    const std::string& path = big_file();
+    for ( auto _: state ) {
+        MidiFile file(path);
+        MidiFile::Event e;
+        size_t events = 0;
+        uint32_t last = 0;
+        for ( auto r = file.reader(); r.next(e); ) {
+            events++;
+            last = e.tick;
+        }
+        benchmark::DoNotOptimize(last);
+        state.counters["events"] = double(events);
+    }
+    state.SetBytesProcessed(int64_t(file_size(path)) * state.iterations());
+}
+BENCHMARK(BM_MidiFile_ReadMerged)->Unit(benchmark::kMillisecond);
+
+/// @brief Decoding alone, one track at a time
+static void BM_MidiFile_ReadTrack(benchmark::State& state) {
+    MidiFile file(big_file());
+    for ( auto _: state ) {
+        MidiFile::Event e;
+        size_t events = 0;
+        for ( uint16_t t = 0; t < file.tracks(); t++ )
+            for ( auto r = file.reader(t); r.next(e); )
+                events++;
+        benchmark::DoNotOptimize(events);
+    }
+}
+BENCHMARK(BM_MidiFile_ReadTrack)->Unit(benchmark::kMillisecond);
+
+/// @brief Streaming 100k events to disk
+static void BM_MidiFile_Write(benchmark::State& state) {
+    for ( auto _: state ) {
+        MidiFileWriter out("superfret_bench_write.mid", 0, 480);
+        for ( uint32_t i = 0; i < 100000; i++ )
+            out.write(i * 10, MidiMsg::control_change(1, uint8_t(i)));
+        out.close();
+    }
+    state.SetItemsProcessed(100000 * state.iterations());
+    std::remove("superfret_bench_write.mid");
+}
+BENCHMARK(BM_MidiFile_Write)->Unit(benchmark::kMillisecond);
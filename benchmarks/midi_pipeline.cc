@@ -0,0 +1,120 @@
+#include <benchmark/benchmark.h>
+#include "midi.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/// @brief A keyboard part, 64 note ons and offs over two octaves
+static std::vector<MidiMsg> part() {
+    std::vector<MidiMsg> msgs;
+    for ( uint8_t i = 0; i < 32; i++ ) {
+        msgs.push_back(MidiMsg::note_on(uint8_t(48 + i % 24), uint8_t(40 + i * 2)));
+        msgs.push_back(MidiMsg::note_off(uint8_t(48 + i % 24), 0));
+    }
+    return msgs;
+}
+
+template <class Stage>
+static void stage_bench(benchmark::State& state, Stage stage) {
+    auto msgs = part();
+    std::vector<MidiMsg> out(msgs.size() * Stage::expansion);
+    for ( auto _: state )
+        benchmark::DoNotOptimize(stage(msgs.data(), msgs.size(), out.data()));
+    state.SetItemsProcessed(int64_t(state.iterations() * msgs.size()));
+}
+
+static void BM_Stage_Transpose(benchmark::State& state) { stage_bench(state, Transpose{7}); }
+static void BM_Stage_Quantize(benchmark::State& state) { stage_bench(state, QuantizeToScale(Scale::major("D"))); }
+static void BM_Stage_Velocity(benchmark::State& state) { stage_bench(state, VelocityCurve::gamma(0.7)); }
+static void BM_Stage_Channel(benchmark::State& state) { stage_bench(state, ChannelMap(9)); }
+static void BM_Stage_Chord(benchmark::State& state) { stage_bench(state, ChordFromNote(Chord::major_triad)); }
+BENCHMARK(BM_Stage_Transpose);
+BENCHMARK(BM_Stage_Quantize);
+BENCHMARK(BM_Stage_Velocity);
+BENCHMARK(BM_Stage_Channel);
+BENCHMARK(BM_Stage_Chord);
+
+/// @brief Every stage, composed at compile time
+static void BM_Pipeline_Static(benchmark::State& state) {
+    auto msgs = part();
+    MidiPipeline pipeline(Transpose{7}, QuantizeToScale(Scale::major("D")), VelocityCurve::gamma(0.7),
+                          ChannelMap(9), ChordFromNote(Chord::major_triad));
+    std::vector<MidiMsg> out(msgs.size() * pipeline.expansion);
+    for ( auto _: state )
+        benchmark::DoNotOptimize(pipeline.process(msgs, out.data()));
+    state.SetItemsProcessed(int64_t(state.iterations() * msgs.size()));
+}
+BENCHMARK(BM_Pipeline_Static);
+
+/// @brief Baseline: the same stages behind a virtual call per message
+struct VirtualStage {
+    virtual ~VirtualStage() = default;
+    virtual size_t process(const MidiMsg& msg, MidiMsg* out) const = 0;
+};
+
+template <class Stage>
+struct Virtual : VirtualStage {
+    Stage stage;
+    explicit Virtual(Stage s): stage(std::move(s)) {}
+    size_t process(const MidiMsg& msg, MidiMsg* out) const override { return stage(&msg, 1, out); }
+};
+
+static void BM_Pipeline_Virtual(benchmark::State& state) {
+    auto msgs = part();
+    std::vector<std::unique_ptr<VirtualStage>> stages;
+    stages.push_back(std::make_unique<Virtual<Transpose>>(Transpose{7}));
+    stages.push_back(std::make_unique<Virtual<QuantizeToScale>>(QuantizeToScale(Scale::major("D"))));
+    stages.push_back(std::make_unique<Virtual<VelocityCurve>>(VelocityCurve::gamma(0.7)));
+    stages.push_back(std::make_unique<Virtual<ChannelMap>>(ChannelMap(9)));
+    stages.push_back(std::make_unique<Virtual<ChordFromNote>>(ChordFromNote(Chord::major_triad)));
+    std::vector<MidiMsg> a(msgs.size() * Chord::capacity), b(a.size());
+    for ( auto _: state ) {
+        size_t total = 0;
+        for ( auto& msg: msgs ) {
+            size_t n = 1;
+            a[0] = msg;
+            for ( auto& stage: stages ) {
+                size_t k = 0;
+                for ( size_t i = 0; i < n; i++ )
+                    k += stage->process(a[i], b.data() + k);
+                std::swap(a, b);
+                n = k;
+            }
+            total += n;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * msgs.size()));
+}
+BENCHMARK(BM_Pipeline_Virtual);
+
+/// @brief From a MidiIn to a MidiOut through a memory sink, with timing on
+static void BM_Pipeline_Pump(benchmark::State& state) {
+    auto sink = std::make_shared<MidiMemorySink>(2);
+    sink->reserve(size_t(1) << 24);
+    MidiOut controller(0, sink);
+    MidiIn in(0, sink);
+    MidiOut synth(1, sink);
+    MidiPipeline pipeline(Transpose{7}, QuantizeToScale(Scale::major("D")), VelocityCurve::gamma(0.7),
+                          ChannelMap(9), ChordFromNote(Chord::major_triad));
+    pipeline.enable_timing();
+    auto msgs = part();
+    size_t calls = 0;
+    for ( auto _: state ) {
+        controller.try_send(msgs);
+        benchmark::DoNotOptimize(pipeline.pump(in, synth));
+        if ( ++calls % 1024 == 0 )
+            sink->clear();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * msgs.size()));
+    auto timing = pipeline.timing();
+    // The budget is for the whole chain, from arrival to sent
+    if ( timing.latency.latency.percentile(0.5) > std::chrono::microseconds(100) )
+        state.SkipWithError("Median latency over the 100us budget");
+    state.counters["p50_ns"] = double(timing.latency.latency.percentile(0.5).count());
+    state.counters["p99_ns"] = double(timing.latency.latency.percentile(0.99).count());
+    for ( size_t i = 0; i < timing.stages.size(); i++ )
+        state.counters["stage" + std::to_string(i) + "_ns"] = double(timing.stages[i].per_message().count());
+}
+BENCHMARK(BM_Pipeline_Pump);
@@ -0,0 +1,154 @@
+#include <benchmark/benchmark.h>
+#include "music.h"
+
+#include <string>
+#include <vector>
+
+static const std::vector<std::string> tone_names = {"C", "C#", "Db", "D", "D#", "Eb", "E", "F",
+                                                    "F#", "Gb", "G", "G#", "Ab", "A", "A#", "Bb", "B"};
+
+/// @brief Parse tone names, sharp and flat, at run time
+static void BM_Tone_Parse(benchmark::State& state) {
+    for ( auto _: state )
+        for ( auto& name: tone_names )
+            benchmark::DoNotOptimize(Tone(name));
+    state.SetItemsProcessed(int64_t(state.iterations() * tone_names.size()));
+}
+BENCHMARK(BM_Tone_Parse);
+
+/// @brief Move every tone by every interval, up and down
+static void BM_Tone_Arithmetic(benchmark::State& state) {
+    for ( auto _: state )
+        for ( uint8_t t = 0; t < 12; t++ )
+            for ( uint8_t i = 0; i < 12; i++ ) {
+                Tone tone(t);
+                benchmark::DoNotOptimize((tone + i) - (tone - i));
+            }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 144);
+}
+BENCHMARK(BM_Tone_Arithmetic);
+
+/// @brief Name every MIDI note as a std::string
+static void BM_Note_Name(benchmark::State& state) {
+    for ( auto _: state )
+        for ( uint8_t n = 0; n < 128; n++ )
+            benchmark::DoNotOptimize(Note(n).name());
+    state.SetItemsProcessed(int64_t(state.iterations()) * 128);
+}
+BENCHMARK(BM_Note_Name);
+
+/// @brief Name every MIDI note into a buffer, without allocating
+static void BM_Note_Format(benchmark::State& state) {
+    char name[Note::max_name];
+    for ( auto _: state )
+        for ( uint8_t n = 0; n < 128; n++ ) {
+            benchmark::DoNotOptimize(Note(n).format(name));
+            benchmark::ClobberMemory();
+        }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 128);
+}
+BENCHMARK(BM_Note_Format);
+
+/// @brief Parse the name of every MIDI note
+static void BM_Note_Parse(benchmark::State& state) {
+    std::vector<std::string> names;
+    for ( uint8_t n = 0; n < 128; n++ )
+        names.push_back(Note(n).name());
+    for ( auto _: state )
+        for ( auto& name: names )
+            benchmark::DoNotOptimize(Note::parse(name));
+    state.SetItemsProcessed(int64_t(state.iterations()) * 128);
+}
+BENCHMARK(BM_Note_Parse);
+
+/// @brief Notes of a major scale over the whole MIDI range, as a vector
+static void BM_Scale_Range(benchmark::State& state) {
+    Scale scale = Scale::major("D");
+    for ( auto _: state )
+        benchmark::DoNotOptimize(scale.range(0, 127));
+    state.SetItemsProcessed(int64_t(state.iterations() * scale.range(0, 127).size()));
+}
+BENCHMARK(BM_Scale_Range);
+
+/// @brief Notes of a major scale over the whole MIDI range, walked lazily
+static void BM_Scale_NotesBetween(benchmark::State& state) {
+    Scale scale = Scale::major("D");
+    for ( auto _: state )
+        for ( Note n: scale.notes_between(0, 127) )
+            benchmark::DoNotOptimize(n);
+    state.SetItemsProcessed(int64_t(state.iterations() * scale.notes_between(0, 127).size()));
+}
+BENCHMARK(BM_Scale_NotesBetween);
+
+/// @brief Build the 4 triads on every root
+static void BM_Chord_Triads(benchmark::State& state) {
+    for ( auto _: state )
+        for ( uint8_t root = 0; root < 120; root++ ) {
+            benchmark::DoNotOptimize(Chord::major_triad(root));
+            benchmark::DoNotOptimize(Chord::minor_triad(root));
+            benchmark::DoNotOptimize(Chord::diminished_triad(root));
+            benchmark::DoNotOptimize(Chord::augmented_triad(root));
+        }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 480);
+}
+BENCHMARK(BM_Chord_Triads);
+
+/// @brief Build a 13th chord from a pitch-class set on every root
+static void BM_Chord_FromPcSet(benchmark::State& state) {
+    PcSet thirteenth = PcSet::of({0, 2, 4, 5, 7, 9, 10});
+    for ( auto _: state )
+        for ( uint8_t root = 0; root < 116; root++ )
+            benchmark::DoNotOptimize(Chord(Note(root), thirteenth));
+    state.SetItemsProcessed(int64_t(state.iterations()) * 116);
+}
+BENCHMARK(BM_Chord_FromPcSet);
+
+/// @brief Baseline: searching outwards for the nearest note of the scale
+static void BM_Scale_QuantizeSearch(benchmark::State& state) {
+    const Scale scale = Scale::major("D");
+    for ( auto _: state ) {
+        unsigned sum = 0;
+        for ( int n = 0; n < 128; n++ ) {
+            for ( int d = 0; d < 12; d++ ) {
+                if ( n - d >= 0 && scale.contains(Note(uint8_t(n - d))) ) {
+                    sum += unsigned(n - d);
+                    break;
+                }
+                if ( n + d < 128 && scale.contains(Note(uint8_t(n + d))) ) {
+                    sum += unsigned(n + d);
+                    break;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 128);
+}
+BENCHMARK(BM_Scale_QuantizeSearch);
+
+/// @brief One note at a time through the cached table
+static void BM_Scale_Quantize(benchmark::State& state) {
+    const Scale scale = Scale::major("D");
+    for ( auto _: state ) {
+        unsigned sum = 0;
+        for ( int n = 0; n < 128; n++ )
+            sum += scale.quantize(Note(uint8_t(n))).note();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 128);
+}
+BENCHMARK(BM_Scale_Quantize);
+
+/// @brief A whole buffer at once
+static void BM_Scale_QuantizeBulk(benchmark::State& state) {
+    const Scale::Quantizer& quantizer = Scale::major("D").quantizer();
+    std::vector<uint8_t> notes(4096);
+    for ( size_t i = 0; i < notes.size(); i++ )
+        notes[i] = uint8_t(i * 37 % 128);
+    for ( auto _: state ) {
+        quantizer(notes);
+        benchmark::DoNotOptimize(notes.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * notes.size()));
+}
+BENCHMARK(BM_Scale_QuantizeBulk);
@@ -0,0 +1,37 @@
+#include <benchmark/benchmark.h>
+#include "music.h"
+
+/// @brief Look up every pitch-class set in turn
+static void BM_PcCatalog_Lookup(benchmark::State& state) {
+    uint16_t bits = 0;
+    for ( auto _: state ) {
+        const PcCatalog::Entry& e = PcCatalog::lookup(PcSet(bits));
+        benchmark::DoNotOptimize(e.chord);
+        bits = (bits + 1) & PcSet::all;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PcCatalog_Lookup);
+
+/// @brief Name the chord of every pitch-class set in turn
+static void BM_PcCatalog_ChordName(benchmark::State& state) {
+    uint16_t bits = 0;
+    for ( auto _: state ) {
+        benchmark::DoNotOptimize(PcCatalog::chord_name(PcSet(bits)));
+        bits = (bits + 1) & PcSet::all;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PcCatalog_ChordName);
+
+/// @brief Name the mode of a scale starting on each of its tones
+static void BM_PcCatalog_ModeName(benchmark::State& state) {
+    PcSet set = Scale::major("C").pcset();
+    uint8_t root = 0;
+    for ( auto _: state ) {
+        benchmark::DoNotOptimize(PcCatalog::scale_name(set, Tone(root)));
+        root = set.next(root);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PcCatalog_ModeName);
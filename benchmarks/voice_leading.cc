@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+#include "music.h"
+
+#include <random>
+#include <vector>
+
+/// @brief 128 chords of a random progression, with up to 48 guitar shapes each
+static const std::vector<std::vector<Voicing>>& progression() {
+    static const std::vector<std::vector<Voicing>> steps = [] {
+        Fretboard guitar = Fretboard::guitar();
+        VoicingGenerator::Options options;
+        options.limit = 48;
+        options.threads = 1;
+        VoicingGenerator gen(options);
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> root(40, 51), quality(0, 3);
+        static const std::initializer_list<uint8_t> degrees[] = {{4, 7}, {3, 7}, {4, 7, 10}, {3, 7, 10}};
+        std::vector<std::vector<Voicing>> found;
+        while ( found.size() < 128 ) {
+            auto v = gen.voicings(guitar, Chord(Note(uint8_t(root(rng))), degrees[quality(rng)]));
+            if ( !v->empty() )
+                found.push_back(*v);
+        }
+        return found;
+    }();
+    return steps;
+}
+
+/// @brief Choose shapes for the whole progression
+static void BM_VoiceLeading_Shapes(benchmark::State& state) {
+    const auto& steps = progression();
+    size_t transitions = 0;
+    for ( size_t k = 1; k < steps.size(); k++ )
+        transitions += steps[k - 1].size() * steps[k].size();
+    for ( auto _: state )
+        benchmark::DoNotOptimize(VoiceLeading::optimize(steps));
+    state.counters["transitions"] = double(transitions);
+}
+BENCHMARK(BM_VoiceLeading_Shapes)->Unit(benchmark::kMicrosecond);
+
+/// @brief Choose MIDI voicings, from every inversion over 2 octaves
+static void BM_VoiceLeading_Voices(benchmark::State& state) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> root(48, 59);
+    std::vector<std::vector<Chord>> steps(128);
+    for ( auto& step: steps ) {
+        Chord c(Note(uint8_t(root(rng))), {4, 7, 10});
+        for ( int octave = -12; octave <= 12; octave += 12 )
+            for ( size_t inv = 0; inv < c.size(); inv++ ) {
+                std::vector<Note> notes;
+                for ( size_t n = 0; n < c.size(); n++ )
+                    notes.push_back(Note(uint8_t(c[n].note() + octave + (n < inv ? 12 : 0))));
+                step.push_back(Chord(notes));
+            }
+    }
+    for ( auto _: state )
+        benchmark::DoNotOptimize(VoiceLeading::optimize(steps));
+}
+BENCHMARK(BM_VoiceLeading_Voices)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,23 @@
+#include <benchmark/benchmark.h>
+#include "music.h"
+
+/// @brief Search every voicing of a 4 note chord, without the cache
+static void BM_Voicing_Search(benchmark::State& state) {
+    Fretboard guitar = Fretboard::guitar();
+    VoicingGenerator::Options options;
+    options.threads = unsigned(state.range(0));
+    for ( auto _: state )
+        benchmark::DoNotOptimize(VoicingGenerator::search(guitar, PcSet::of({7, 11, 2, 5}), "G", options));
+}
+BENCHMARK(BM_Voicing_Search)->Arg(1)->Arg(4)->Unit(benchmark::kMicrosecond);
+
+/// @brief The same chord, asked again
+static void BM_Voicing_Cached(benchmark::State& state) {
+    Fretboard guitar = Fretboard::guitar();
+    VoicingGenerator gen;
+    Chord g7("G2"_note, {4, 7, 10});
+    gen.voicings(guitar, g7);
+    for ( auto _: state )
+        benchmark::DoNotOptimize(gen.voicings(guitar, g7));
+}
+BENCHMARK(BM_Voicing_Cached);
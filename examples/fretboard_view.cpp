@@ -0,0 +1,28 @@
+/**
+ * @file fretboard_view.cpp
+ * @brief Draws a guitar fretboard in the terminal, walking through the
+ *        chords of a key
+ * @note Needs a terminal that understands ANSI escape sequences
+ */
+#include <music.h>
+
+#include <thread>
+#include <chrono>
+
+int main() {
+    Fretboard guitar = Fretboard::guitar(15);
+    Scale key = Scale::major("G");
+    FretboardView view;
+
+    // Accent each chord of the key in turn, each frame only redraws the
+    // positions whose colour changed
+    for ( size_t degree = 0; degree < key.length(); degree++ ) {
+        Chord chord(Note(key[degree], 4), PcSet().with(key[degree].tone())
+                                               .with(key[degree + 2].tone())
+                                               .with(key[degree + 4].tone()));
+        view.draw(guitar, key, chord.pcset());
+        view.present();
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    return 0;
+}
@@ -5,30 +5,33 @@
  */
 #include <midi.h>
 
-#include <thread>
 #include <chrono>
 #include <vector>
 
 int main() {
     std::vector<unsigned int> c_major = {60, 66, 69};
     std::vector<unsigned int> c_minor = {60, 65, 69};
-    MidiOut out(0);
+
+    // The scheduler sends from its own thread, at the times given to it
+    MidiScheduler sched(MidiOut(0));
+    auto t = MidiScheduler::Clock::now() + std::chrono::milliseconds(10);
     
     // Trigger notes via. MIDI note-on
     for ( auto note: c_major )
-        out << note;
-
-    // Let chord play for 2 seconds
-    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+        sched.schedule(t, MidiMsg::note_on(note, 120));
 
-    // End notes via. MIDI note-off
+    // Let chord play for 2 seconds, then end notes via. MIDI note-off
+    t += std::chrono::milliseconds(2000);
     for ( auto note: c_major )
-        out >> note;
+        sched.schedule(t, MidiMsg::note_off(note, 120));
 
     // Repeat for C-Minor
     for ( auto note: c_minor )
-        out << note;
-    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+        sched.schedule(t, MidiMsg::note_on(note, 120));
+    t += std::chrono::milliseconds(2000);
     for ( auto note: c_minor )
-        out >> note;
-}
\ No newline at end of file
+        sched.schedule(t, MidiMsg::note_off(note, 120));
+
+    // Block until everything was sent
+    sched.wait();
+}
@@ -25,7 +25,7 @@ int main() {
     // Go over the "notes" of the scale starting at "C4" and ending at "C5"
     // The notes are defined as having a specific frequency, while tones do not
     // Print to std-out the name of the note, and play for 1 second
-    for ( auto n: c_major.range(60, 72) ) {
+    for ( auto n: c_major.notes_between(60, 72) ) {
         std::cout << "Playing " << n << std::endl;
         out << n;
         std::this_thread::sleep_for(std::chrono::milliseconds(1000));
@@ -44,6 +44,14 @@ int main() {
     std::this_thread::sleep_for(std::chrono::milliseconds(1000));
     for ( auto n: Chord::major_triad(60) )
         out >> n;
+
+    // Do the same, but send the whole chord in one batch
+    std::cout << "C Major Chord (batched)" << std::endl;
+    out << Chord::major_triad(60);
+    std::cout << "Sent " << out.last_batch().bytes << " bytes in "
+              << out.last_batch().latency.count() << "ns" << std::endl;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    out >> Chord::major_triad(60);
     
     // Do the same for a C-minor chord
     std::cout << "C Minor Chord" << std::endl;
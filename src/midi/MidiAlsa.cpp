@@ -0,0 +1,370 @@
+/**
+ * @file MidiAlsa.cpp
+ * @brief @b MidiBackend for the ALSA sequencer
+ * @note Only built on @b Linux when ALSA was found
+ *
+ * MIDI outs are the writable sequencer ports of other clients (including
+ * hardware ports, which the sequencer exposes on top of rawmidi), and
+ * MIDI ins their readable ports, in the order the sequencer reports them.
+ */
+#include <alsa/asoundlib.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MidiBackend.hpp"
+#include "MidiError.hpp"
+
+/** === Error Handling === */
+/// @param err negative errno, as returned by the ALSA API
+static MidiErrorKind midi_error_kind(int err) noexcept {
+    switch (-err) {
+        case ENOENT:
+        case ENXIO:
+            return MidiErrorKind::NotFound;
+
+        case ENODEV:
+        case EPIPE:
+            return MidiErrorKind::Disconnected;
+
+        case EBUSY:
+        case EPERM:
+            return MidiErrorKind::Allocated;
+
+        case EINVAL:
+        case EAGAIN:
+            return MidiErrorKind::RuntimeError;
+
+        default:
+            return MidiErrorKind::SysError;
+    }
+}
+
+static void midi_out_error(int err, const std::string& method = "") {
+    if ( err >= 0 )
+        return;
+
+    std::string msg = method.empty() ? "" : method + ": ";
+    throw_midi_error(midi_error_kind(err), msg + snd_strerror(err));
+}
+
+/** === Port Enumeration === */
+/// @brief Snapshot of a sequencer port, taken while enumerating
+struct AlsaPort {
+    int client;
+    int port;
+    std::string name;
+    unsigned int type;
+    int voices;
+    int channels;
+};
+
+/// @brief Capabilities of the ports a @b MidiOut or a @b MidiIn connects to
+static constexpr unsigned int alsa_writable = SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_SUBS_WRITE;
+static constexpr unsigned int alsa_readable = SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_SUBS_READ;
+
+static std::vector<AlsaPort> alsa_ports(snd_seq_t* seq, unsigned int wanted) {
+    std::vector<AlsaPort> ports;
+    snd_seq_client_info_t* cinfo;
+    snd_seq_port_info_t* pinfo;
+    snd_seq_client_info_alloca(&cinfo);
+    snd_seq_port_info_alloca(&pinfo);
+
+    int self = snd_seq_client_id(seq);
+
+    snd_seq_client_info_set_client(cinfo, -1);
+    while ( snd_seq_query_next_client(seq, cinfo) >= 0 ) {
+        int client = snd_seq_client_info_get_client(cinfo);
+        // Skip the "System" client's timer/announce ports, and ourselves
+        if ( client == SND_SEQ_CLIENT_SYSTEM || client == self )
+            continue;
+        snd_seq_port_info_set_client(pinfo, client);
+        snd_seq_port_info_set_port(pinfo, -1);
+        while ( snd_seq_query_next_port(seq, pinfo) >= 0 ) {
+            if ( (snd_seq_port_info_get_capability(pinfo) & wanted) != wanted )
+                continue;
+            ports.push_back({
+                client,
+                snd_seq_port_info_get_port(pinfo),
+                snd_seq_port_info_get_name(pinfo),
+                snd_seq_port_info_get_type(pinfo),
+                snd_seq_port_info_get_synth_voices(pinfo),
+                snd_seq_port_info_get_midi_channels(pinfo)
+            });
+        }
+    }
+    return ports;
+}
+
+/** === Connection === */
+/**
+ * @class AlsaConnection
+ * @brief Own sequencer client, with a port subscribed to the target port
+ */
+class AlsaConnection : public MidiBackend::Connection {
+    snd_seq_t* _seq = nullptr;
+    snd_midi_event_t* _parser = nullptr;
+    int _port = -1;
+
+    public:
+        AlsaConnection(const AlsaPort& target) {
+            midi_out_error(snd_seq_open(&_seq, "default", SND_SEQ_OPEN_OUTPUT, 0), "snd_seq_open");
+            try {
+                snd_seq_set_client_name(_seq, "Superfret");
+                _port = snd_seq_create_simple_port(_seq, "Superfret Out",
+                                                   SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_SUBS_READ,
+                                                   SND_SEQ_PORT_TYPE_MIDI_GENERIC | SND_SEQ_PORT_TYPE_APPLICATION);
+                midi_out_error(_port, "snd_seq_create_simple_port");
+                midi_out_error(snd_seq_connect_to(_seq, _port, target.client, target.port), "snd_seq_connect_to");
+                midi_out_error(snd_midi_event_new(256, &_parser), "snd_midi_event_new");
+            } catch ( ... ) {
+                snd_seq_close(_seq);
+                throw;
+            }
+        }
+
+        ~AlsaConnection() override {
+            snd_midi_event_free(_parser);
+            snd_seq_close(_seq);
+        }
+
+        /// @note The event encoder keeps track of running status itself
+        bool running_status() const override {
+            return true;
+        }
+
+        /// @note Events are queued in the client's output buffer, and
+        ///       the whole batch is handed to the sequencer with one drain
+        void send(const uint8_t* bytes, size_t size) override {
+            const char* method = nullptr;
+            int err = transmit(bytes, size, method);
+            if ( err < 0 )
+                midi_out_error(err, method);
+        }
+
+        MidiStatus try_send(const uint8_t* bytes, size_t size) noexcept override {
+            const char* method = nullptr;
+            int err = transmit(bytes, size, method);
+            return err < 0 ? MidiStatus(midi_error_kind(err)) : MidiStatus();
+        }
+
+    private:
+        /// @returns negative errno on failure, with @p method the call that failed
+        int transmit(const uint8_t* bytes, size_t size, const char*& method) noexcept {
+            while ( size > 0 ) {
+                snd_seq_event_t ev;
+                snd_seq_ev_clear(&ev);
+                long used = snd_midi_event_encode(_parser, bytes, long(size), &ev);
+                if ( used <= 0 ) {
+                    method = "snd_midi_event_encode";
+                    return used < 0 ? int(used) : -EINVAL;
+                }
+                bytes += used;
+                size -= size_t(used);
+                if ( ev.type == SND_SEQ_EVENT_NONE )
+                    continue; // Incomplete message, wait for more bytes
+                snd_seq_ev_set_source(&ev, _port);
+                snd_seq_ev_set_subs(&ev);
+                snd_seq_ev_set_direct(&ev);
+                int err = snd_seq_event_output(_seq, &ev);
+                if ( err < 0 ) {
+                    method = "snd_seq_event_output";
+                    return err;
+                }
+            }
+            method = "snd_seq_drain_output";
+            return snd_seq_drain_output(_seq);
+        }
+};
+
+/**
+ * @class AlsaInput
+ * @brief Own sequencer client, with a port subscribed from the source port
+ *
+ * A thread waits on the client's file descriptors and hands every event
+ * to the receiver as soon as it is read. A pipe wakes it up to stop.
+ */
+class AlsaInput : public MidiBackend::Input {
+    snd_seq_t* _seq = nullptr;
+    snd_midi_event_t* _parser = nullptr;
+    int _port = -1;
+    int _wake[2] = {-1, -1};
+    MidiBackend::Receiver& _receiver;
+    std::thread _thread;
+
+    public:
+        AlsaInput(const AlsaPort& source, MidiBackend::Receiver& receiver): _receiver(receiver) {
+            midi_out_error(snd_seq_open(&_seq, "default", SND_SEQ_OPEN_INPUT, SND_SEQ_NONBLOCK), "snd_seq_open");
+            try {
+                snd_seq_set_client_name(_seq, "Superfret");
+                _port = snd_seq_create_simple_port(_seq, "Superfret In", alsa_writable,
+                                                   SND_SEQ_PORT_TYPE_MIDI_GENERIC | SND_SEQ_PORT_TYPE_APPLICATION);
+                midi_out_error(_port, "snd_seq_create_simple_port");
+                midi_out_error(snd_seq_connect_from(_seq, _port, source.client, source.port), "snd_seq_connect_from");
+                midi_out_error(snd_midi_event_new(256, &_parser), "snd_midi_event_new");
+                if ( pipe(_wake) < 0 )
+                    midi_out_error(-errno, "pipe");
+            } catch ( ... ) {
+                close();
+                throw;
+            }
+            _thread = std::thread(&AlsaInput::run, this);
+        }
+
+        ~AlsaInput() override {
+            char stop = 0;
+            while ( write(_wake[1], &stop, 1) < 0 && errno == EINTR ) {}
+            _thread.join();
+            close();
+        }
+
+    private:
+        void close() {
+            for ( int fd: _wake )
+                if ( fd >= 0 )
+                    ::close(fd);
+            if ( _parser )
+                snd_midi_event_free(_parser);
+            snd_seq_close(_seq);
+        }
+
+        void run() {
+            int n = snd_seq_poll_descriptors_count(_seq, POLLIN);
+            std::vector<pollfd> fds(size_t(n) + 1);
+            snd_seq_poll_descriptors(_seq, fds.data(), unsigned(n), POLLIN);
+            fds[n] = {_wake[0], POLLIN, 0};
+            uint8_t bytes[256];
+            for (;;) {
+                if ( poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR )
+                    return;
+                if ( fds[n].revents )
+                    return;
+                snd_seq_event_t* ev;
+                int err;
+                // -ENOSPC reports events lost to an overrun, and reading goes on
+                while ( (err = snd_seq_event_input(_seq, &ev)) >= 0 || err == -ENOSPC ) {
+                    if ( err < 0 )
+                        continue;
+                    auto now = std::chrono::steady_clock::now();
+                    long size = snd_midi_event_decode(_parser, bytes, sizeof(bytes), ev);
+                    if ( size > 0 )
+                        _receiver.receive(bytes, size_t(size), now);
+                }
+            }
+        }
+};
+
+/** === Backend === */
+/**
+ * @class AlsaBackend
+ * @brief Keeps one sequencer client open for enumerating ports
+ *
+ * The client is shared by every thread asking, so queries are serialised
+ */
+class AlsaBackend : public MidiBackend {
+    snd_seq_t* _seq = nullptr;
+    std::mutex _mtx;
+
+    public:
+        AlsaBackend() {
+            midi_out_error(snd_seq_open(&_seq, "default", SND_SEQ_OPEN_OUTPUT, 0), "snd_seq_open");
+            snd_seq_set_client_name(_seq, "Superfret Discovery");
+        }
+
+        ~AlsaBackend() override {
+            snd_seq_close(_seq);
+        }
+
+        std::string backend_name() const override {
+            return "alsa";
+        }
+
+        size_t count() override {
+            std::lock_guard<std::mutex> lock(_mtx);
+            return alsa_ports(_seq, alsa_writable).size();
+        }
+
+        std::string name(size_t port) override {
+            return find(port, "midi_out_name").name;
+        }
+
+        bool external(size_t port) override {
+            return find(port, "midi_out_external").type & SND_SEQ_PORT_TYPE_HARDWARE;
+        }
+
+        size_t notes(size_t port) override {
+            return find(port, "midi_out_notes").voices;
+        }
+
+        uint16_t channel_mask(size_t port) override {
+            return caps_of(find(port, "midi_out_channel_mask")).channel_mask;
+        }
+
+        Caps caps(size_t port) override {
+            return caps_of(find(port, "midi_out_caps"));
+        }
+
+        /// @note A single walk of the sequencer's clients and ports
+        std::vector<Caps> ports() override {
+            std::vector<AlsaPort> ports;
+            {
+                std::lock_guard<std::mutex> lock(_mtx);
+                ports = alsa_ports(_seq, alsa_writable);
+            }
+            std::vector<Caps> found;
+            for ( auto& p: ports )
+                found.push_back(caps_of(p));
+            return found;
+        }
+
+        std::unique_ptr<Connection> open(size_t port) override {
+            return std::make_unique<AlsaConnection>(find(port, "midi_out_open"));
+        }
+
+        size_t in_count() override {
+            std::lock_guard<std::mutex> lock(_mtx);
+            return alsa_ports(_seq, alsa_readable).size();
+        }
+
+        Caps in_caps(size_t port) override {
+            return caps_of(find(port, "midi_in_caps", alsa_readable));
+        }
+
+        std::vector<Caps> in_ports() override {
+            std::vector<AlsaPort> ports;
+            {
+                std::lock_guard<std::mutex> lock(_mtx);
+                ports = alsa_ports(_seq, alsa_readable);
+            }
+            std::vector<Caps> found;
+            for ( auto& p: ports )
+                found.push_back(caps_of(p));
+            return found;
+        }
+
+        std::unique_ptr<Input> open_in(size_t port, Receiver& receiver) override {
+            return std::make_unique<AlsaInput>(find(port, "midi_in_open", alsa_readable), receiver);
+        }
+
+    private:
+        static Caps caps_of(const AlsaPort& p) {
+            uint16_t mask = p.channels >= 16 ? 0xFFFF : uint16_t((1u << p.channels) - 1);
+            return {p.name, (p.type & SND_SEQ_PORT_TYPE_HARDWARE) != 0, size_t(p.voices), mask};
+        }
+
+        AlsaPort find(size_t port, const std::string& method, unsigned int wanted = alsa_writable) {
+            std::lock_guard<std::mutex> lock(_mtx);
+            auto ports = alsa_ports(_seq, wanted);
+            if ( port >= ports.size() )
+                throw MidiNotFound(method + ": Device ID out of range");
+            return ports[port];
+        }
+};
+
+std::shared_ptr<MidiBackend> midi_alsa_backend() {
+    return std::make_shared<AlsaBackend>();
+}
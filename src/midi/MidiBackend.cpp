@@ -0,0 +1,65 @@
+#include "MidiBackend.hpp"
+#include "MidiMemorySink.hpp"
+#include "MidiError.hpp"
+
+// Defined by the backend's own source file, when it is built
+#ifdef _WIN32
+std::shared_ptr<MidiBackend> midi_winmm_backend();
+#endif
+#ifdef SUPERFRET_MIDI_ALSA
+std::shared_ptr<MidiBackend> midi_alsa_backend();
+#endif
+
+std::shared_ptr<MidiBackend> MidiBackend::platform() {
+    #if defined(_WIN32)
+        return midi_winmm_backend();
+    #elif defined(SUPERFRET_MIDI_ALSA)
+        // Headless machines often have ALSA installed, but no sequencer
+        try {
+            return midi_alsa_backend();
+        } catch ( const MidiError& ) {
+            return std::make_shared<MidiMemorySink>();
+        }
+    #else
+        return std::make_shared<MidiMemorySink>();
+    #endif
+}
+
+MidiStatus MidiBackend::Connection::try_send(const uint8_t* bytes, size_t size) noexcept {
+    try {
+        send(bytes, size);
+        return MidiStatus();
+    } catch ( const MidiError& e ) {
+        return e.kind();
+    } catch ( ... ) {
+        return MidiErrorKind::Other;
+    }
+}
+
+MidiBackend::Caps MidiBackend::caps(size_t port) {
+    return {name(port), external(port), notes(port), channel_mask(port)};
+}
+
+std::vector<MidiBackend::Caps> MidiBackend::ports() {
+    std::vector<Caps> found;
+    size_t n = count();
+    for ( size_t i = 0; i < n; i++ )
+        found.push_back(caps(i));
+    return found;
+}
+
+MidiBackend::Caps MidiBackend::in_caps(size_t) {
+    throw MidiNotFound("MidiBackend::in_caps: Device ID out of range");
+}
+
+std::vector<MidiBackend::Caps> MidiBackend::in_ports() {
+    std::vector<Caps> found;
+    size_t n = in_count();
+    for ( size_t i = 0; i < n; i++ )
+        found.push_back(in_caps(i));
+    return found;
+}
+
+std::unique_ptr<MidiBackend::Input> MidiBackend::open_in(size_t, Receiver&) {
+    throw MidiNotFound("MidiBackend::open_in: Device ID out of range");
+}
@@ -0,0 +1,160 @@
+/**
+ * @file MidiBackend.hpp
+ * @brief Interface that @b MidiOut and @b MidiIn use to talk to the system's MIDI API
+ */
+#ifndef MIDI_BACKEND_HPP_
+#define MIDI_BACKEND_HPP_
+
+#include <string>
+#include <memory>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "MidiError.hpp"
+
+/**
+ * @class MidiBackend
+ * @brief A source of MIDI out and in ports, such as WinMM, ALSA or a @b MidiMemorySink
+ *
+ * Ports are identified by their index in `[0, count())`, following the
+ * WinMM convention. Opening a port returns a @b Connection, which is
+ * closed when it is destroyed. MIDI ins are numbered separately, in
+ * `[0, in_count())`, and backends without any keep the defaults.
+ *
+ * Methods report failures by throwing the matching @b MidiError subclass.
+ * Backends are always owned by a `std::shared_ptr`, so connections can
+ * keep their backend alive. Every method may be called from several
+ * threads, eg. by a @b MidiWatcher while the application sends.
+ *
+ * @par Example: Running without a MIDI device
+ * @code
+ * auto sink = std::make_shared<MidiMemorySink>();
+ * MidiOut::set_backend(sink);
+ *
+ * MidiOut out(0);
+ * out << 60;
+ * // sink->bytes(0) == {0x90, 60, 120}
+ * @endcode
+ */
+class MidiBackend : public std::enable_shared_from_this<MidiBackend> {
+    public:
+        /**
+         * @class MidiBackend::Connection
+         * @brief An open MIDI out port
+         */
+        class Connection {
+            public:
+                /// @brief Closes the connection, silencing any hanging notes
+                virtual ~Connection() = default;
+
+                /// @brief Send a buffer of complete MIDI messages
+                /// @param bytes wire bytes, starting with a status byte
+                ///        unless @b running_status is supported
+                virtual void send(const uint8_t* bytes, size_t size) = 0;
+
+                /// @brief Same as @b send, reporting failure instead of throwing
+                /// Defaults to catching what @b send throws; backends override
+                /// it so a failing real-time send does not unwind at all
+                virtual MidiStatus try_send(const uint8_t* bytes, size_t size) noexcept;
+
+                /// @brief Whether @b send accepts messages without their
+                ///        status byte, following MIDI running status
+                virtual bool running_status() const {
+                    return false;
+                }
+        };
+
+        /**
+         * @class MidiBackend::Receiver
+         * @brief Where an open MIDI in delivers the bytes that arrive
+         *
+         * Called one call at a time, from the backend's own thread or
+         * whichever thread produced the bytes, so it must not block
+         */
+        class Receiver {
+            public:
+                virtual ~Receiver() = default;
+
+                /// @param time when the bytes arrived, as close to the driver as the backend gets
+                virtual void receive(const uint8_t* bytes, size_t size, std::chrono::steady_clock::time_point time) noexcept = 0;
+        };
+
+        /**
+         * @class MidiBackend::Input
+         * @brief An open MIDI in port
+         * Stops calling its @b Receiver before its destructor returns
+         */
+        class Input {
+            public:
+                virtual ~Input() = default;
+        };
+
+        /**
+         * @struct MidiBackend::Caps
+         * @brief Everything known about a port, read in one query
+         */
+        struct Caps {
+            std::string name;
+            bool external = false;
+            size_t notes = 0;
+            uint16_t channel_mask = 0;
+        };
+
+        virtual ~MidiBackend() = default;
+
+        /// @brief Short identifier of the backend, eg. "winmm" or "alsa"
+        virtual std::string backend_name() const = 0;
+
+        /// @brief Number of ports currently available
+        virtual size_t count() = 0;
+
+        /// @brief Name of the port
+        virtual std::string name(size_t port) = 0;
+
+        /// @brief Whether the port is a physical MIDI connection
+        virtual bool external(size_t port) = 0;
+
+        /// @brief How many simultaneous notes the port can play
+        virtual size_t notes(size_t port) = 0;
+
+        /// @brief Mask of the channels available on the port
+        virtual uint16_t channel_mask(size_t port) = 0;
+
+        /// @brief Everything about the port at once
+        /// Defaults to the 4 queries above; backends override it when the
+        /// system returns them together, eg. `midiOutGetDevCaps`
+        virtual Caps caps(size_t port);
+
+        /// @brief Capabilities of every port, in port order, from a single
+        ///        enumeration of the system's ports
+        virtual std::vector<Caps> ports();
+
+        /// @brief Open the port for sending
+        /// @throws MidiNotFound if @p port is out of range
+        /// @throws MidiAllocated if the port can not be shared and is in use
+        virtual std::unique_ptr<Connection> open(size_t port) = 0;
+
+        /// @brief Number of MIDI in ports currently available
+        virtual size_t in_count() {
+            return 0;
+        }
+
+        /// @brief Everything about the MIDI in port at once
+        virtual Caps in_caps(size_t port);
+
+        /// @brief Capabilities of every MIDI in port, in port order
+        virtual std::vector<Caps> in_ports();
+
+        /// @brief Start delivering what arrives at the port to @p receiver
+        /// @throws MidiNotFound if @p port is out of range
+        /// @throws MidiAllocated if the port can not be shared and is in use
+        virtual std::unique_ptr<Input> open_in(size_t port, Receiver& receiver);
+
+        /// @brief The system's MIDI API
+        /// WinMM on @b Windows, ALSA where available, otherwise a @b MidiMemorySink
+        static std::shared_ptr<MidiBackend> platform();
+};
+
+#endif // MIDI_BACKEND_HPP_
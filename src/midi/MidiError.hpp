@@ -7,6 +7,28 @@
 
 #include <exception>
 #include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @enum MidiErrorKind
+ * @brief Which @b MidiError subclass a failure is, for counting failures
+ * without catching them by type
+ */
+enum class MidiErrorKind : uint8_t {
+    NotFound,
+    Unconnected,
+    Allocated,
+    Disconnected,
+    RuntimeError,
+    SysError,
+    FileError,
+    /// @brief Any exception that is not a @b MidiError
+    Other,
+};
+
+/// @brief Number of @b MidiErrorKind values
+constexpr size_t midi_error_kinds = size_t(MidiErrorKind::Other) + 1;
 
 /**
  * @class MidiError
@@ -22,6 +44,9 @@ class MidiError : public std::exception {
         /// @brief Description of the error
         const char* what() const noexcept override { return _msg.c_str(); }
 
+        /// @brief The subclass of this error
+        virtual MidiErrorKind kind() const noexcept { return MidiErrorKind::Other; }
+
 };
 
 /**
@@ -32,6 +57,7 @@ class MidiError : public std::exception {
 class MidiNotFound : public MidiError {
     public:
         explicit MidiNotFound(const std::string& msg): MidiError("MidiNotFound: " + msg) {}
+        MidiErrorKind kind() const noexcept override { return MidiErrorKind::NotFound; }
 };
 
 /**
@@ -41,6 +67,7 @@ class MidiNotFound : public MidiError {
 class MidiUnconnected : public MidiError {
     public:
         explicit MidiUnconnected(const std::string& msg): MidiError("MidiUnconnected: " + msg) {}
+        MidiErrorKind kind() const noexcept override { return MidiErrorKind::Unconnected; }
 };
 
 /**
@@ -50,6 +77,7 @@ class MidiUnconnected : public MidiError {
 class MidiAllocated : public MidiError {
     public:
         explicit MidiAllocated(const std::string& msg): MidiError("MidiAllocated: " + msg) {}
+        MidiErrorKind kind() const noexcept override { return MidiErrorKind::Allocated; }
 };
 
 /**
@@ -59,6 +87,7 @@ class MidiAllocated : public MidiError {
 class MidiDisconnected : public MidiError {
     public:
         explicit MidiDisconnected(const std::string& msg): MidiError("MidiDisconnected: " + msg) {}
+        MidiErrorKind kind() const noexcept override { return MidiErrorKind::Disconnected; }
 };
 
 /**
@@ -68,6 +97,7 @@ class MidiDisconnected : public MidiError {
 class MidiRuntimeError : public MidiError {
     public:
         explicit MidiRuntimeError(const std::string& msg): MidiError("MidiRuntimeError: " + msg) {}
+        MidiErrorKind kind() const noexcept override { return MidiErrorKind::RuntimeError; }
 };
 
 /**
@@ -77,6 +107,81 @@ class MidiRuntimeError : public MidiError {
 class MidiSysError : public MidiError {
     public:
         explicit MidiSysError(const std::string& msg): MidiError("MidiSysError: " + msg) {}
+        MidiErrorKind kind() const noexcept override { return MidiErrorKind::SysError; }
 };
 
+/**
+ * @class MidiFileError
+ * @brief A MIDI file could not be opened, or is not a valid Standard MIDI File
+ */
+class MidiFileError : public MidiError {
+    public:
+        explicit MidiFileError(const std::string& msg): MidiError("MidiFileError: " + msg) {}
+        MidiErrorKind kind() const noexcept override { return MidiErrorKind::FileError; }
+};
+
+/** === Non-throwing Calls === */
+/**
+ * @class MidiStatus
+ * @brief Outcome of a call that reports failure instead of throwing,
+ * eg. @b MidiOut::try_send
+ *
+ * A failure carries the @b MidiErrorKind of the @b MidiError the
+ * throwing version of the call would raise, and converts to `false`.
+ *
+ * @code
+ * if ( MidiStatus s = out.try_send(MidiMsg::note_on(60, 100)); !s )
+ *     failures[size_t(s.kind())]++;
+ * @endcode
+ */
+class MidiStatus {
+    bool _ok = true;
+    MidiErrorKind _kind = MidiErrorKind::Other;
+
+    public:
+        /// @brief Success
+        constexpr MidiStatus() noexcept = default;
+
+        /// @brief Failure of the given kind
+        constexpr MidiStatus(MidiErrorKind kind) noexcept: _ok(false), _kind(kind) {}
+
+        /// @brief Whether the call succeeded
+        constexpr bool ok() const noexcept { return _ok; }
+        constexpr explicit operator bool() const noexcept { return _ok; }
+
+        /// @brief Kind of failure, only meaningful when not @b ok
+        constexpr MidiErrorKind kind() const noexcept { return _kind; }
+
+        constexpr bool operator==(MidiErrorKind kind) const noexcept { return !_ok && _kind == kind; }
+        constexpr bool operator!=(MidiErrorKind kind) const noexcept { return !(*this == kind); }
+};
+
+/// @brief Short description of a kind of failure, without allocating
+constexpr const char* midi_error_text(MidiErrorKind kind) noexcept {
+    switch ( kind ) {
+        case MidiErrorKind::NotFound:     return "Device not found";
+        case MidiErrorKind::Unconnected:  return "Must connect first!";
+        case MidiErrorKind::Allocated:    return "Device already in use";
+        case MidiErrorKind::Disconnected: return "Device disconnected";
+        case MidiErrorKind::RuntimeError: return "Unexpected error";
+        case MidiErrorKind::SysError:     return "System error";
+        case MidiErrorKind::FileError:    return "Invalid MIDI file";
+        default:                          return "Unknown error";
+    }
+}
+
+/// @brief Throw the @b MidiError subclass matching @p kind
+/// @b MidiErrorKind::Other has no subclass, and throws a @b MidiRuntimeError
+[[noreturn]] inline void throw_midi_error(MidiErrorKind kind, const std::string& msg) {
+    switch ( kind ) {
+        case MidiErrorKind::NotFound:     throw MidiNotFound(msg);
+        case MidiErrorKind::Unconnected:  throw MidiUnconnected(msg);
+        case MidiErrorKind::Allocated:    throw MidiAllocated(msg);
+        case MidiErrorKind::Disconnected: throw MidiDisconnected(msg);
+        case MidiErrorKind::SysError:     throw MidiSysError(msg);
+        case MidiErrorKind::FileError:    throw MidiFileError(msg);
+        default:                          throw MidiRuntimeError(msg);
+    }
+}
+
 #endif // MIDI_EXCEPTIONS_HPP_
\ No newline at end of file
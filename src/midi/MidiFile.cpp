@@ -0,0 +1,458 @@
+#ifdef _WIN32
+    extern "C" {
+        #include <Windows.h>
+    }
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#include "MidiFile.hpp"
+#include "MidiError.hpp"
+
+/** === Memory Mapping === */
+/**
+ * @struct MidiFile::Mapping
+ * @brief Read-only mapping of the whole file
+ */
+struct MidiFile::Mapping {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    #ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = NULL;
+
+        Mapping(const std::string& path) {
+            file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            if ( file == INVALID_HANDLE_VALUE )
+                throw MidiFileError(path + ": Could not open file");
+            LARGE_INTEGER len;
+            if ( !GetFileSizeEx(file, &len) || len.QuadPart == 0 ) {
+                CloseHandle(file);
+                throw MidiFileError(path + ": Empty or unreadable file");
+            }
+            size = size_t(len.QuadPart);
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if ( mapping != NULL )
+                data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            if ( data == nullptr ) {
+                if ( mapping != NULL )
+                    CloseHandle(mapping);
+                CloseHandle(file);
+                throw MidiFileError(path + ": Could not map file");
+            }
+        }
+
+        ~Mapping() {
+            UnmapViewOfFile(data);
+            CloseHandle(mapping);
+            CloseHandle(file);
+        }
+    #else
+        Mapping(const std::string& path) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if ( fd < 0 )
+                throw MidiFileError(path + ": Could not open file");
+            struct stat st;
+            if ( fstat(fd, &st) != 0 || st.st_size == 0 ) {
+                ::close(fd);
+                throw MidiFileError(path + ": Empty or unreadable file");
+            }
+            size = size_t(st.st_size);
+            void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            // The mapping keeps its own reference to the file
+            ::close(fd);
+            if ( addr == MAP_FAILED )
+                throw MidiFileError(path + ": Could not map file");
+            madvise(addr, size, MADV_SEQUENTIAL);
+            data = static_cast<const uint8_t*>(addr);
+        }
+
+        ~Mapping() {
+            munmap(const_cast<uint8_t*>(data), size);
+        }
+    #endif
+};
+
+/** === Decoding Helpers === */
+/// @brief Kept out of line, so the decoding loop stays small
+[[noreturn]] static void malformed(const char* what) {
+    throw MidiFileError(what);
+}
+
+static uint32_t read_be(const uint8_t* p, size_t n) {
+    uint32_t v = 0;
+    for ( size_t i = 0; i < n; i++ )
+        v = (v << 8) | p[i];
+    return v;
+}
+
+/// @brief Variable-length quantity, at most 4 bytes
+static inline uint32_t read_vlq(const uint8_t*& pos, const uint8_t* end) {
+    // Most deltas and lengths fit in a single byte
+    if ( pos < end && !(*pos & 0x80) )
+        return *pos++;
+    uint32_t v = 0;
+    for ( int i = 0; i < 4; i++ ) {
+        if ( pos >= end )
+            malformed("Truncated variable-length quantity");
+        uint8_t b = *pos++;
+        v = (v << 7) | (b & 0x7F);
+        if ( !(b & 0x80) )
+            return v;
+    }
+    malformed("Variable-length quantity longer than 4 bytes");
+}
+
+/// @brief Largest value of a variable-length quantity
+static constexpr uint32_t max_vlq = 0x0FFFFFFF;
+
+/// @return number of bytes written to @p out, at most 4
+/// @note Callers check @p v is at most @b max_vlq
+static size_t write_vlq(uint32_t v, uint8_t* out) {
+    uint8_t reversed[4];
+    size_t n = 0;
+    do {
+        reversed[n++] = v & 0x7F;
+        v >>= 7;
+    } while ( v > 0 && n < 4 );
+    for ( size_t i = 0; i < n; i++ )
+        out[i] = reversed[n - 1 - i] | (i + 1 < n ? 0x80 : 0);
+    return n;
+}
+
+/** === Reader === */
+/// @brief Decode the next event of the cursor's track into `pending`
+/// @return `false` at the end of the track
+bool MidiFile::Reader::advance(Cursor& c) {
+    if ( c.pos >= c.end )
+        return false;
+    Event& e = c.pending;
+    c.tick += read_vlq(c.pos, c.end);
+    e.tick = c.tick;
+    e.track = c.track;
+    e.data = nullptr;
+    e.size = 0;
+
+    if ( c.pos >= c.end )
+        malformed("Truncated event");
+    uint8_t status = *c.pos;
+    if ( status & 0x80 ) {
+        c.pos++;
+    } else if ( c.running ) {
+        status = c.running;
+    } else {
+        malformed("Data byte without running status");
+    }
+
+    if ( status == 0xFF ) {
+        if ( c.pos >= c.end )
+            malformed("Truncated meta event");
+        uint8_t type = *c.pos++;
+        uint32_t len = read_vlq(c.pos, c.end);
+        if ( len > size_t(c.end - c.pos) )
+            malformed("Meta event runs past the end of its track");
+        e.msg = {0xFF, type, 0, 0};
+        e.data = c.pos;
+        e.size = len;
+        c.pos += len;
+        // Anything after "End of Track" is ignored
+        if ( type == 0x2F )
+            c.end = c.pos;
+    } else if ( status == 0xF0 || status == 0xF7 ) {
+        uint32_t len = read_vlq(c.pos, c.end);
+        if ( len > size_t(c.end - c.pos) )
+            malformed("System exclusive runs past the end of its track");
+        e.msg = {status, 0, 0, 0};
+        e.data = c.pos;
+        e.size = len;
+        c.pos += len;
+    } else {
+        e.msg = {status, 0, 0, 0};
+        size_t data = e.msg.size() - 1;
+        if ( data > size_t(c.end - c.pos) )
+            malformed("Truncated channel message");
+        if ( data > 0 )
+            e.msg.data0 = c.pos[0] & 0x7F;
+        if ( data > 1 )
+            e.msg.data1 = c.pos[1] & 0x7F;
+        c.pos += data;
+        // Real-time keeps running status, system common cancels it
+        if ( status < 0xF0 )
+            c.running = status;
+        else if ( status < 0xF8 )
+            c.running = 0;
+    }
+    return true;
+}
+
+/**
+ * Cursors are kept as a binary min-heap on (tick, track), so each event
+ * costs O(log tracks) rather than a scan over every track
+ */
+bool MidiFile::Reader::next(Event& e) {
+    if ( _heap.empty() )
+        return false;
+    Cursor& c = _cursors[_heap[0]];
+    e = c.pending;
+    if ( !advance(c) ) {
+        _heap[0] = _heap.back();
+        _heap.pop_back();
+    }
+    sift_down(0);
+    return true;
+}
+
+bool MidiFile::Reader::before(uint16_t a, uint16_t b) const {
+    const Event& x = _cursors[a].pending;
+    const Event& y = _cursors[b].pending;
+    return x.tick < y.tick || (x.tick == y.tick && x.track < y.track);
+}
+
+void MidiFile::Reader::sift_down(size_t i) {
+    size_t n = _heap.size();
+    for (;;) {
+        size_t least = i;
+        size_t l = 2 * i + 1;
+        size_t r = l + 1;
+        if ( l < n && before(_heap[l], _heap[least]) )
+            least = l;
+        if ( r < n && before(_heap[r], _heap[least]) )
+            least = r;
+        if ( least == i )
+            return;
+        std::swap(_heap[i], _heap[least]);
+        i = least;
+    }
+}
+
+void MidiFile::Reader::start() {
+    _heap.clear();
+    for ( size_t i = 0; i < _cursors.size(); i++ )
+        if ( advance(_cursors[i]) )
+            _heap.push_back(uint16_t(i));
+    for ( size_t i = _heap.size() / 2; i-- > 0; )
+        sift_down(i);
+}
+
+/** === MidiFile Methods === */
+MidiFile::MidiFile(const std::string& path): _map(std::make_unique<Mapping>(path)) {
+    const uint8_t* pos = _map->data;
+    const uint8_t* end = pos + _map->size;
+
+    if ( _map->size < 14 || std::memcmp(pos, "MThd", 4) != 0 )
+        throw MidiFileError(path + ": Not a Standard MIDI File");
+    uint32_t header = read_be(pos + 4, 4);
+    if ( header < 6 || header > _map->size - 8 )
+        throw MidiFileError(path + ": Bad header length");
+    _format = uint16_t(read_be(pos + 8, 2));
+    uint16_t ntracks = uint16_t(read_be(pos + 10, 2));
+    _division = uint16_t(read_be(pos + 12, 2));
+    if ( _format > 1 )
+        throw MidiFileError(path + ": Only format 0 and 1 are supported");
+    if ( _division & 0x8000 )
+        throw MidiFileError(path + ": SMPTE time division is not supported");
+    if ( _division == 0 )
+        throw MidiFileError(path + ": Division of 0 ticks per quarter note");
+    pos += 8 + header;
+
+    // Unknown chunk types are skipped, as the specification asks
+    while ( _tracks.size() < ntracks && size_t(end - pos) >= 8 ) {
+        uint32_t len = read_be(pos + 4, 4);
+        const uint8_t* data = pos + 8;
+        if ( len > size_t(end - data) )
+            throw MidiFileError(path + ": Chunk runs past the end of the file");
+        if ( std::memcmp(pos, "MTrk", 4) == 0 )
+            _tracks.emplace_back(data, data + len);
+        pos = data + len;
+    }
+    if ( _tracks.size() != ntracks )
+        throw MidiFileError(path + ": Missing tracks");
+
+    // Tempo changes are kept in the first track
+    _tempo.push_back({0, 500000, 0});
+    if ( !_tracks.empty() ) {
+        Event e;
+        for ( auto r = reader(0); r.next(e); ) {
+            if ( !e.meta() || e.msg.data0 != 0x51 || e.size != 3 )
+                continue;
+            Tempo& last = _tempo.back();
+            uint64_t usec = last.usec + uint64_t(e.tick - last.tick) * last.usec_per_quarter / _division;
+            uint32_t tempo = read_be(e.data, 3);
+            if ( e.tick == last.tick )
+                last.usec_per_quarter = tempo;
+            else
+                _tempo.push_back({e.tick, tempo, usec});
+        }
+    }
+}
+
+MidiFile::~MidiFile() = default;
+
+uint16_t MidiFile::format() const {
+    return _format;
+}
+
+uint16_t MidiFile::tracks() const {
+    return uint16_t(_tracks.size());
+}
+
+uint16_t MidiFile::division() const {
+    return _division;
+}
+
+MidiFile::Reader MidiFile::reader() const {
+    Reader r;
+    r._cursors.reserve(_tracks.size());
+    for ( size_t i = 0; i < _tracks.size(); i++ )
+        r._cursors.push_back({_tracks[i].first, _tracks[i].second, 0, uint16_t(i), 0, {}});
+    r.start();
+    return r;
+}
+
+MidiFile::Reader MidiFile::reader(uint16_t track) const {
+    if ( track >= _tracks.size() )
+        throw MidiFileError("Track " + std::to_string(track) + " out of range");
+    Reader r;
+    r._cursors.push_back({_tracks[track].first, _tracks[track].second, 0, track, 0, {}});
+    r.start();
+    return r;
+}
+
+const std::vector<MidiFile::Tempo>& MidiFile::tempo_map() const {
+    return _tempo;
+}
+
+double MidiFile::seconds(uint32_t tick) const {
+    auto it = std::upper_bound(_tempo.begin(), _tempo.end(), tick,
+                               [](uint32_t t, const Tempo& tempo) { return t < tempo.tick; });
+    const Tempo& t = *(it - 1);
+    double usec = double(t.usec) + double(tick - t.tick) * t.usec_per_quarter / _division;
+    return usec / 1e6;
+}
+
+/** === MidiFileWriter Methods === */
+MidiFileWriter::MidiFileWriter(const std::string& path, uint16_t format, uint16_t division): _format(format) {
+    if ( format > 1 )
+        throw MidiFileError("Only format 0 and 1 can be written");
+    if ( division == 0 || division & 0x8000 )
+        throw MidiFileError("Division must be between 1 and 32767 ticks per quarter note");
+    _file = std::fopen(path.c_str(), "wb");
+    if ( _file == nullptr )
+        throw MidiFileError(path + ": Could not create file");
+    std::setvbuf(_file, nullptr, _IOFBF, 1 << 16);
+    const uint8_t header[14] = {
+        'M', 'T', 'h', 'd', 0, 0, 0, 6,
+        0, uint8_t(format), 0, 0, // Number of tracks is filled in by close()
+        uint8_t(division >> 8), uint8_t(division & 0xFF)
+    };
+    put(header, sizeof(header));
+}
+
+MidiFileWriter::~MidiFileWriter() {
+    if ( _file == nullptr )
+        return;
+    try {
+        close();
+    } catch ( const MidiFileError& ) {
+        // Nothing can be reported from a destructor
+    }
+}
+
+void MidiFileWriter::put(const uint8_t* bytes, size_t size) {
+    if ( std::fwrite(bytes, 1, size, _file) != size )
+        throw MidiFileError("Could not write to file");
+}
+
+void MidiFileWriter::delta(uint32_t tick) {
+    if ( _track_start < 0 )
+        begin_track();
+    if ( tick < _tick )
+        throw MidiFileError("Events must be written in time order");
+    if ( tick - _tick > max_vlq )
+        throw MidiFileError("Delta time of " + std::to_string(tick - _tick) + " ticks is too long");
+    uint8_t buffer[4];
+    size_t n = write_vlq(tick - _tick, buffer);
+    _tick = tick;
+    put(buffer, n);
+}
+
+void MidiFileWriter::begin_track() {
+    if ( _track_start >= 0 )
+        end_track();
+    if ( _format == 0 && _tracks > 0 )
+        throw MidiFileError("Format 0 files have a single track");
+    const uint8_t chunk[8] = {'M', 'T', 'r', 'k', 0, 0, 0, 0};
+    put(chunk, sizeof(chunk));
+    _track_start = std::ftell(_file);
+    _tick = 0;
+    _encoder.reset();
+    _tracks++;
+}
+
+void MidiFileWriter::write(uint32_t tick, const MidiMsg& msg) {
+    // Anything else is a system message, which a file can not hold as is
+    if ( msg.status < 0x80 || msg.status >= 0xF0 )
+        throw MidiFileError("Not a channel message: status " + std::to_string(msg.status));
+    delta(tick);
+    uint8_t buffer[MidiEncoder::max_size(1)];
+    put(buffer, _encoder.encode(msg, buffer));
+}
+
+void MidiFileWriter::meta(uint32_t tick, uint8_t type, const uint8_t* data, uint32_t size) {
+    if ( size > max_vlq )
+        throw MidiFileError("Meta event of " + std::to_string(size) + " bytes is too long");
+    delta(tick);
+    // Not every reader keeps running status across meta events
+    _encoder.reset();
+    uint8_t buffer[6] = {0xFF, type};
+    put(buffer, 2 + write_vlq(size, buffer + 2));
+    if ( size > 0 )
+        put(data, size);
+}
+
+void MidiFileWriter::tempo(uint32_t tick, uint32_t usec_per_quarter) {
+    const uint8_t data[3] = {
+        uint8_t(usec_per_quarter >> 16), uint8_t(usec_per_quarter >> 8), uint8_t(usec_per_quarter)
+    };
+    meta(tick, 0x51, data, 3);
+}
+
+void MidiFileWriter::end_track() {
+    if ( _track_start < 0 )
+        return;
+    meta(_tick, 0x2F, nullptr, 0);
+    long end = std::ftell(_file);
+    uint32_t len = uint32_t(end - _track_start);
+    const uint8_t length[4] = {uint8_t(len >> 24), uint8_t(len >> 16), uint8_t(len >> 8), uint8_t(len)};
+    std::fseek(_file, _track_start - 4, SEEK_SET);
+    put(length, 4);
+    std::fseek(_file, end, SEEK_SET);
+    _track_start = -1;
+}
+
+void MidiFileWriter::close() {
+    if ( _file == nullptr )
+        return;
+    try {
+        end_track();
+        const uint8_t tracks[2] = {uint8_t(_tracks >> 8), uint8_t(_tracks & 0xFF)};
+        std::fseek(_file, 10, SEEK_SET);
+        put(tracks, 2);
+    } catch ( const MidiFileError& ) {
+        std::fclose(_file);
+        _file = nullptr;
+        throw;
+    }
+    bool ok = std::fclose(_file) == 0;
+    _file = nullptr;
+    if ( !ok )
+        throw MidiFileError("Could not finish writing file");
+}
@@ -0,0 +1,196 @@
+/**
+ * @file MidiFile.hpp
+ * @brief Provides `MidiFile` and `MidiFileWriter` for Standard MIDI Files
+ */
+#ifndef MIDI_FILE_HPP_
+#define MIDI_FILE_HPP_
+
+#include <cstdio>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MidiMsg.hpp"
+
+/**
+ * @class MidiFile
+ * @brief Reads a Standard MIDI File (format 0 or 1) straight from a memory mapping
+ *
+ * Opening the file maps it and finds its tracks and tempo map. Events
+ * are then decoded one at a time by a @b Reader, in place, so reading
+ * does not allocate per event. Meta and system exclusive payloads point
+ * into the mapping, and stay valid as long as the @b MidiFile does.
+ *
+ * @code
+ * MidiFile file("song.mid");
+ * MidiFile::Event e;
+ * for ( auto r = file.reader(); r.next(e); )
+ *     if ( e.msg.type() == MidiMsg::NoteOn )
+ *         std::cout << file.seconds(e.tick) << "s: " << int(e.msg.data0) << std::endl;
+ * @endcode
+ */
+class MidiFile {
+    public:
+        /// @brief A single event, with its absolute time in ticks
+        struct Event {
+            uint32_t tick = 0;
+            uint16_t track = 0;
+            /// @brief Status `0xFF` for meta events (with the meta type in
+            ///        @b data0), `0xF0`/`0xF7` for system exclusive
+            MidiMsg msg;
+            /// @brief Payload of meta and system exclusive events
+            const uint8_t* data = nullptr;
+            uint32_t size = 0;
+
+            bool meta() const {
+                return msg.status == 0xFF;
+            }
+
+            bool sysex() const {
+                return msg.status == 0xF0 || msg.status == 0xF7;
+            }
+        };
+
+        /// @brief A change of tempo, in microseconds per quarter note
+        struct Tempo {
+            uint32_t tick;
+            uint32_t usec_per_quarter;
+            /// @brief Time of the change since the start of the song
+            uint64_t usec;
+        };
+
+        /// @brief Walks one track, or all tracks merged in time order
+        class Reader {
+            public:
+                /// @brief Decode the next event into @p e
+                /// @return `false` once all events were read
+                /// @throws MidiFileError if the track data is malformed
+                bool next(Event& e);
+
+            private:
+                friend MidiFile;
+                struct Cursor {
+                    const uint8_t* pos;
+                    const uint8_t* end;
+                    uint32_t tick;
+                    uint16_t track;
+                    uint8_t running;
+                    Event pending;
+                };
+                std::vector<Cursor> _cursors;
+                /// @brief Cursors that still have events, ordered by their next event
+                std::vector<uint16_t> _heap;
+
+                static bool advance(Cursor& c);
+                bool before(uint16_t a, uint16_t b) const;
+                void sift_down(size_t i);
+                void start();
+        };
+
+        /// @brief Map @p path and read its header, track list and tempo map
+        /// @throws MidiFileError if the file can not be read or is not a MIDI file
+        explicit MidiFile(const std::string& path);
+        ~MidiFile();
+
+        MidiFile(const MidiFile&) = delete;
+        MidiFile& operator=(const MidiFile&) = delete;
+
+        /// @brief `0` for a single track, `1` for simultaneous tracks
+        uint16_t format() const;
+
+        /// @brief Number of tracks
+        uint16_t tracks() const;
+
+        /// @brief Ticks per quarter note
+        uint16_t division() const;
+
+        /// @brief Read all tracks merged, ordered by tick, then by track
+        Reader reader() const;
+
+        /// @brief Read only track @p track
+        Reader reader(uint16_t track) const;
+
+        /// @brief Every tempo change, starting with one at tick `0`
+        const std::vector<Tempo>& tempo_map() const;
+
+        /// @brief Time since the start of the song of @p tick, following the tempo map
+        double seconds(uint32_t tick) const;
+
+    private:
+        struct Mapping;
+        std::unique_ptr<Mapping> _map;
+        uint16_t _format = 0;
+        uint16_t _division = 0;
+        std::vector<std::pair<const uint8_t*, const uint8_t*>> _tracks;
+        std::vector<Tempo> _tempo;
+};
+
+/**
+ * @class MidiFileWriter
+ * @brief Streams events into a Standard MIDI File, one track after another
+ *
+ * Events are written as they come, using running status, and each
+ * track's length is filled in when it ends, so songs of any length can
+ * be recorded without keeping them in memory.
+ *
+ * @code
+ * MidiFileWriter out("session.mid", 1, 480);
+ * out.begin_track();
+ * out.tempo(0, 500000); // 120 BPM
+ * out.write(0, MidiMsg::note_on(60, 100));
+ * out.write(480, MidiMsg::note_off(60, 0));
+ * out.end_track();
+ * out.close();
+ * @endcode
+ */
+class MidiFileWriter {
+    public:
+        /// @param format `0` (single track) or `1`
+        /// @param division ticks per quarter note
+        /// @throws MidiFileError if @p path can not be created
+        MidiFileWriter(const std::string& path, uint16_t format = 1, uint16_t division = 480);
+
+        /// @brief Closes the file, see @b close
+        ~MidiFileWriter();
+
+        MidiFileWriter(const MidiFileWriter&) = delete;
+        MidiFileWriter& operator=(const MidiFileWriter&) = delete;
+
+        /// @brief Start a new track, ending the current one if needed
+        void begin_track();
+
+        /// @brief Add @p msg, a channel message, to the current track at
+        /// absolute @p tick. Meta events are added with @b meta
+        /// @throws MidiFileError if @p msg is not a channel message, if
+        ///         @p tick is before the previous event, or more than
+        ///         `0x0FFFFFFF` ticks after it
+        void write(uint32_t tick, const MidiMsg& msg);
+
+        /// @brief Add a meta event of @p type to the current track
+        /// @throws MidiFileError as @b write, or if @p size is over `0x0FFFFFFF`
+        void meta(uint32_t tick, uint8_t type, const uint8_t* data, uint32_t size);
+
+        /// @brief Add a tempo change, in microseconds per quarter note
+        void tempo(uint32_t tick, uint32_t usec_per_quarter);
+
+        /// @brief Write the end of track, and fill in the track's length
+        void end_track();
+
+        /// @brief End the current track, and fill in the number of tracks
+        /// @throws MidiFileError if the file could not be written
+        void close();
+
+    private:
+        std::FILE* _file = nullptr;
+        uint16_t _format;
+        uint16_t _tracks = 0;
+        long _track_start = -1;
+        uint32_t _tick = 0;
+        MidiEncoder _encoder;
+
+        void delta(uint32_t tick);
+        void put(const uint8_t* bytes, size_t size);
+};
+
+#endif // MIDI_FILE_HPP_
@@ -0,0 +1,132 @@
+#include <atomic>
+
+#include "MidiIn.hpp"
+#include "MidiOut.hpp"
+#include "SpscRing.hpp"
+
+/** === MidiIn Impl === */
+/**
+ * @class MidiIn::Impl
+ * @brief Receives from the backend, and owns the ring it fills
+ *
+ * @b receive runs on the backend's thread, and is the ring's only
+ * producer; @b MidiIn::receive is its only consumer
+ */
+struct MidiIn::Impl : public MidiBackend::Receiver {
+    Impl(std::shared_ptr<MidiBackend> b, size_t p, size_t capacity)
+        : backend(std::move(b)), port(p), ring(capacity) {
+        in = backend->open_in(port, *this);
+    }
+
+    /// @note The input goes first, so nothing is delivered into a dead ring
+    ~Impl() override {
+        in = nullptr;
+    }
+
+    void receive(const uint8_t* bytes, size_t size, Clock::time_point time) noexcept override {
+        MidiMsg msg;
+        for ( size_t i = 0; i < size; i++ )
+            if ( decoder.decode(bytes[i], msg) && !ring.push({time, msg}) )
+                dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<MidiBackend> backend;
+    size_t port;
+    SpscRing<Event> ring;
+    std::atomic<uint64_t> dropped{0};
+
+    private:
+        // Only touched by the backend's thread
+        MidiDecoder decoder;
+        std::unique_ptr<MidiBackend::Input> in;
+};
+
+/** === Info Methods === */
+MidiIn::Info::Info(std::shared_ptr<MidiBackend> backend, size_t port, MidiBackend::Caps caps)
+    : _backend(std::move(backend)), _port(port), _caps(std::move(caps)) {}
+
+bool MidiIn::Info::external() const {
+    return _caps.external;
+}
+
+std::string MidiIn::Info::name() const {
+    return _caps.name;
+}
+
+const MidiBackend::Caps& MidiIn::Info::caps() const {
+    return _caps;
+}
+
+size_t MidiIn::Info::port() const {
+    return _port;
+}
+
+/** === MidiIn Methods === */
+std::vector<MidiIn::Info> MidiIn::discover() {
+    return discover(MidiOut::backend());
+}
+
+std::vector<MidiIn::Info> MidiIn::discover(std::shared_ptr<MidiBackend> backend) {
+    // One enumeration for every port's capabilities
+    std::vector<MidiBackend::Caps> ports = backend->in_ports();
+    std::vector<Info> found;
+    found.reserve(ports.size());
+    for ( size_t i = 0; i < ports.size(); i++ )
+        found.emplace_back(backend, i, std::move(ports[i]));
+    return found;
+}
+
+size_t MidiIn::count() {
+    return MidiOut::backend()->in_count();
+}
+
+MidiIn::MidiIn() = default;
+MidiIn::~MidiIn() = default;
+MidiIn::MidiIn(MidiIn&&) = default;
+MidiIn& MidiIn::operator=(MidiIn&&) = default;
+
+MidiIn::MidiIn(size_t port, size_t capacity): MidiIn(port, MidiOut::backend(), capacity) {}
+
+MidiIn::MidiIn(size_t port, std::shared_ptr<MidiBackend> backend, size_t capacity)
+    : _pimpl(std::make_unique<Impl>(std::move(backend), port, capacity)) {}
+
+MidiIn& MidiIn::operator=(const Info& in) {
+    // Let go of the port first, in case it is the same one
+    _pimpl = nullptr;
+    _pimpl = std::make_unique<Impl>(in._backend, in._port, default_capacity);
+    return *this;
+}
+
+bool MidiIn::connected() const {
+    return _pimpl != nullptr;
+}
+
+bool MidiIn::external() const {
+    if ( _pimpl )
+        return _pimpl->backend->in_caps(_pimpl->port).external;
+    throw MidiUnconnected("MidiIn::external - Must connect first!");
+}
+
+std::string MidiIn::name() const {
+    if ( _pimpl )
+        return _pimpl->backend->in_caps(_pimpl->port).name;
+    throw MidiUnconnected("MidiIn::name - Must connect first!");
+}
+
+size_t MidiIn::receive(Span<Event> events) noexcept {
+    if ( !_pimpl )
+        return 0;
+    return _pimpl->ring.pop(events.data(), events.size());
+}
+
+bool MidiIn::receive(Event& event) noexcept {
+    return receive(Span<Event>(&event, 1)) == 1;
+}
+
+size_t MidiIn::pending() const noexcept {
+    return _pimpl ? _pimpl->ring.size() : 0;
+}
+
+uint64_t MidiIn::dropped() const noexcept {
+    return _pimpl ? _pimpl->dropped.load(std::memory_order_relaxed) : 0;
+}
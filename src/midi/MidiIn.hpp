@@ -0,0 +1,187 @@
+/**
+ * @file MidiIn.hpp
+ * @brief Provides `MidiIn` class for receiving MIDI messages
+ */
+#ifndef MIDI_IN_HPP_
+#define MIDI_IN_HPP_
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <chrono>
+
+#include "MidiBackend.hpp"
+#include "MidiError.hpp"
+#include "MidiMsg.hpp"
+#include "Span.hpp"
+
+/**
+ * @class MidiIn
+ * @brief Class for receiving MIDI messages and discovering MIDI in sources
+ *
+ * The backend's callback only decodes the bytes that arrive, and pushes
+ * them with their arrival time into a lock-free ring allocated when
+ * connecting. The application drains the ring in batches, from one
+ * thread, without locking or allocating. When the application falls
+ * behind, messages that do not fit are counted by @b dropped.
+ *
+ * Discovery and errors follow @b MidiOut, using the same default
+ * backend, see @b MidiOut::set_backend.
+ *
+ * @par Example 1: Polling from an audio callback
+ * @code
+ * MidiIn in(0);
+ * MidiIn::Event events[64];
+ * // Each block
+ * size_t n = in.receive(events);
+ * for ( size_t i = 0; i < n; i++ )
+ *     if ( events[i].msg.type() == MidiMsg::NoteOn )
+ *         play(events[i].msg.data0);
+ * @endcode
+ *
+ * @par Example 2: Searching through devices
+ * @code
+ * MidiIn in;
+ * for ( auto& info: MidiIn::discover() )
+ *     if ( info.name() == "My Keyboard" )
+ *         in = info;
+ * @endcode
+ */
+class MidiIn {
+    public:
+        // Docs provided in later declaration
+        struct Info;
+
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @struct MidiIn::Event
+         * @brief A message, and when it arrived
+         */
+        struct Event {
+            Clock::time_point time;
+            MidiMsg msg;
+        };
+
+        /// @brief Size of the ring unless given, about a second of dense input
+        static constexpr size_t default_capacity = 1024;
+
+    /** @name Connect
+     * These methods allow for connecting to inputs
+     * @{
+     */
+        /// @brief Construct an unconnected instance
+        /// Connect using `in = std::move(other)` or `in = info`
+        MidiIn();
+
+        /// @brief Stops receiving, dropping what was not drained
+        ~MidiIn();
+
+        /// @brief Connect to the desired MIDI in port
+        /// @param capacity messages the ring holds, rounded up to a power of two
+        explicit MidiIn(size_t port, size_t capacity = default_capacity);
+
+        /// @brief Connect to the desired port of a specific backend
+        MidiIn(size_t port, std::shared_ptr<MidiBackend> backend, size_t capacity = default_capacity);
+
+        /// @brief Try to connect to the desired MIDI in, with a ring of @b default_capacity
+        MidiIn& operator=(const Info& in);
+
+        /// @brief Take over the connection of @p other
+        MidiIn(MidiIn&& other);
+        MidiIn& operator=(MidiIn&& other);
+    /**
+     * @}
+     */
+
+    /** @name Information
+     * Get information on the input connected
+     * @{
+     */
+        /// @brief Whether this @b MidiIn has connected
+        bool connected() const;
+
+        /// @brief Whether this is an external MIDI device
+        bool external() const;
+
+        /// @brief The name of the MIDI in source
+        std::string name() const;
+    /**
+     * @}
+     */
+
+    /** @name Receiving
+     * Drain what has arrived, oldest first. Only call these from one
+     * thread at a time; an unconnected instance has nothing to receive
+     * @{
+     */
+        /// @brief Take up to `events.size()` events
+        /// @return number of events written
+        size_t receive(Span<Event> events) noexcept;
+
+        /// @brief Take the oldest event, if any
+        bool receive(Event& event) noexcept;
+
+        /// @brief Number of events waiting
+        size_t pending() const noexcept;
+
+        /// @brief Number of messages lost because the ring was full
+        uint64_t dropped() const noexcept;
+    /**
+     * @}
+     */
+
+    protected:
+        struct Impl;
+        std::unique_ptr<Impl> _pimpl;
+
+    public:
+    /** @name Discovery
+     * Methods for discovering available MIDI inputs
+     * @{
+     */
+        /// @brief Discover all currently connected/available inputs
+        static std::vector<Info> discover();
+
+        /// @brief Discover all inputs of a specific backend
+        static std::vector<Info> discover(std::shared_ptr<MidiBackend> backend);
+
+        /// @brief Count the number of currently connected/available inputs
+        static size_t count();
+    /**
+     * @}
+     */
+
+        /**
+         * @struct MidiIn::Info
+         * @brief This is provided for use in searching for MIDI ins
+         *
+         * @note This is intended to be constructed using `MidiIn::discover`,
+         * which reads the capabilities of every port once
+         */
+        struct Info {
+            protected:
+                friend MidiIn;
+                std::shared_ptr<MidiBackend> _backend;
+                size_t _port;
+                MidiBackend::Caps _caps;
+
+            public:
+                /// @brief Returns `true` if this represents is a physical MIDI connection
+                bool external() const;
+
+                /// @brief Read the name of the MIDI in
+                std::string name() const;
+
+                /// @brief All of the above, as read when discovered
+                const MidiBackend::Caps& caps() const;
+
+                /// @brief Index of the port in its backend, when discovered
+                size_t port() const;
+
+                Info(std::shared_ptr<MidiBackend> backend, size_t port, MidiBackend::Caps caps);
+        };
+};
+
+#endif // MIDI_IN_HPP_
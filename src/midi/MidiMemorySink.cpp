@@ -0,0 +1,193 @@
+#include <new>
+
+#include "MidiMemorySink.hpp"
+#include "MidiError.hpp"
+
+/** === Connection === */
+/**
+ * @class MidiMemorySink::Port
+ * @brief Connection appending into the sink's log for one port
+ *
+ * Holds a @b shared_ptr to the sink, so the sink outlives every
+ * connection made to it
+ */
+class MidiMemorySink::Port : public MidiBackend::Connection {
+    std::shared_ptr<MidiMemorySink> _sink;
+    size_t _port;
+
+    public:
+        Port(std::shared_ptr<MidiMemorySink> sink, size_t port): _sink(std::move(sink)), _port(port) {}
+
+        ~Port() override {
+            std::lock_guard<std::mutex> lock(_sink->_mtx);
+            _sink->_ports[_port].open = false;
+        }
+
+        bool running_status() const override {
+            return _sink->_running_status;
+        }
+
+        void send(const uint8_t* bytes, size_t size) override {
+            MidiStatus s = try_send(bytes, size);
+            if ( !s )
+                throw_midi_error(s.kind(), std::string("MidiMemorySink::send: ") + midi_error_text(s.kind()));
+        }
+
+        /// @note Only allocates when the log outgrows what was @b reserve d
+        MidiStatus try_send(const uint8_t* bytes, size_t size) noexcept override {
+            auto now = Clock::now();
+            std::lock_guard<std::mutex> lock(_sink->_mtx);
+            if ( _port >= _sink->_count )
+                return MidiErrorKind::Disconnected;
+            Log& l = _sink->_ports[_port];
+            size_t events = l.events.size();
+            try {
+                l.events.push_back({now, l.bytes.size(), size});
+                l.bytes.insert(l.bytes.end(), bytes, bytes + size);
+            } catch ( const std::bad_alloc& ) {
+                l.events.resize(events);
+                return MidiErrorKind::SysError;
+            }
+            if ( l.receiver )
+                l.receiver->receive(bytes, size, now);
+            return MidiStatus();
+        }
+};
+
+/**
+ * @class MidiMemorySink::Loopback
+ * @brief MIDI in receiving what is sent to the port of the same index
+ */
+class MidiMemorySink::Loopback : public MidiBackend::Input {
+    std::shared_ptr<MidiMemorySink> _sink;
+    size_t _port;
+
+    public:
+        Loopback(std::shared_ptr<MidiMemorySink> sink, size_t port): _sink(std::move(sink)), _port(port) {}
+
+        /// @note Sends hold the same lock, so none is still delivering
+        ~Loopback() override {
+            std::lock_guard<std::mutex> lock(_sink->_mtx);
+            _sink->_ports[_port].receiver = nullptr;
+        }
+};
+
+/** === MidiMemorySink Methods === */
+MidiMemorySink::MidiMemorySink(size_t ports, bool running_status): _running_status(running_status), _ports(ports), _count(ports) {}
+
+MidiMemorySink::Log& MidiMemorySink::log(size_t port, const char* method) {
+    if ( port >= _count )
+        throw MidiNotFound(std::string(method) + ": Device ID out of range");
+    return _ports[port];
+}
+
+const MidiMemorySink::Log& MidiMemorySink::log(size_t port, const char* method) const {
+    if ( port >= _count )
+        throw MidiNotFound(std::string(method) + ": Device ID out of range");
+    return _ports[port];
+}
+
+std::string MidiMemorySink::backend_name() const {
+    return "memory";
+}
+
+size_t MidiMemorySink::count() {
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _count;
+}
+
+std::string MidiMemorySink::name(size_t port) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    log(port, "MidiMemorySink::name");
+    return "Superfret Memory Sink " + std::to_string(port);
+}
+
+bool MidiMemorySink::external(size_t port) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    log(port, "MidiMemorySink::external");
+    return false;
+}
+
+size_t MidiMemorySink::notes(size_t port) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    log(port, "MidiMemorySink::notes");
+    return 128;
+}
+
+uint16_t MidiMemorySink::channel_mask(size_t port) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    log(port, "MidiMemorySink::channel_mask");
+    return 0xFFFF;
+}
+
+std::unique_ptr<MidiBackend::Connection> MidiMemorySink::open(size_t port) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    Log& l = log(port, "MidiMemorySink::open");
+    if ( l.open )
+        throw MidiAllocated("MidiMemorySink::open: Device already in use");
+    l.open = true;
+    // The sink is always owned by a shared_ptr, see MidiOut::set_backend
+    return std::make_unique<Port>(std::static_pointer_cast<MidiMemorySink>(shared_from_this()), port);
+}
+
+size_t MidiMemorySink::in_count() {
+    return count();
+}
+
+MidiBackend::Caps MidiMemorySink::in_caps(size_t port) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    log(port, "MidiMemorySink::in_caps");
+    return {"Superfret Memory Sink " + std::to_string(port), false, 0, 0xFFFF};
+}
+
+std::unique_ptr<MidiBackend::Input> MidiMemorySink::open_in(size_t port, Receiver& receiver) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    Log& l = log(port, "MidiMemorySink::open_in");
+    if ( l.receiver )
+        throw MidiAllocated("MidiMemorySink::open_in: Device already in use");
+    l.receiver = &receiver;
+    return std::make_unique<Loopback>(std::static_pointer_cast<MidiMemorySink>(shared_from_this()), port);
+}
+
+std::vector<uint8_t> MidiMemorySink::bytes(size_t port) const {
+    std::lock_guard<std::mutex> lock(_mtx);
+    return log(port, "MidiMemorySink::bytes").bytes;
+}
+
+std::vector<MidiMemorySink::Record> MidiMemorySink::records(size_t port) const {
+    std::lock_guard<std::mutex> lock(_mtx);
+    const Log& l = log(port, "MidiMemorySink::records");
+    std::vector<Record> found;
+    found.reserve(l.events.size());
+    for ( auto& e: l.events )
+        found.push_back({e.time, std::vector<uint8_t>(l.bytes.begin() + e.offset, l.bytes.begin() + e.offset + e.size)});
+    return found;
+}
+
+size_t MidiMemorySink::sends(size_t port) const {
+    std::lock_guard<std::mutex> lock(_mtx);
+    return log(port, "MidiMemorySink::sends").events.size();
+}
+
+void MidiMemorySink::reserve(size_t bytes) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    for ( auto& l: _ports ) {
+        l.bytes.reserve(bytes);
+        l.events.reserve(bytes / 3 + 1);
+    }
+}
+
+void MidiMemorySink::clear() {
+    std::lock_guard<std::mutex> lock(_mtx);
+    for ( auto& l: _ports ) {
+        l.bytes.clear();
+        l.events.clear();
+    }
+}
+
+void MidiMemorySink::set_count(size_t ports) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    if ( ports > _ports.size() )
+        _ports.resize(ports);
+    _count = ports;
+}
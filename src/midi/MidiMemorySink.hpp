@@ -0,0 +1,111 @@
+/**
+ * @file MidiMemorySink.hpp
+ * @brief Provides `MidiMemorySink`, a MIDI backend that records to memory
+ */
+#ifndef MIDI_MEMORY_SINK_HPP_
+#define MIDI_MEMORY_SINK_HPP_
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "MidiBackend.hpp"
+
+/**
+ * @class MidiMemorySink
+ * @brief In-process backend recording the timestamped wire bytes sent to it
+ *
+ * Useful for tests and benchmarks, where no MIDI device is available.
+ * Each port can only be opened once at a time, like a WinMM port.
+ *
+ * Every port also loops back to the MIDI in of the same index, so what
+ * a @b MidiOut sends arrives at a @b MidiIn, timestamped as it is
+ * recorded. Delivery happens on the sending thread.
+ *
+ * @code
+ * auto sink = std::make_shared<MidiMemorySink>(2);
+ * MidiOut out(1, sink);
+ * out << 60;
+ * for ( auto& r: sink->records(1) )
+ *     std::cout << r.bytes.size() << " bytes" << std::endl;
+ *
+ * MidiIn in(1, sink);
+ * out >> 60;
+ * MidiIn::Event e;
+ * in.receive(e); // e.msg == MidiMsg::note_off(60, 120)
+ * @endcode
+ */
+class MidiMemorySink : public MidiBackend {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /// @brief A single call to @b Connection::send
+        struct Record {
+            Clock::time_point time;
+            std::vector<uint8_t> bytes;
+        };
+
+        /// @brief Create a sink with @p ports ports
+        /// @param running_status whether the ports accept MIDI running status,
+        ///        like a serial/USB link would
+        explicit MidiMemorySink(size_t ports = 1, bool running_status = true);
+
+        std::string backend_name() const override;
+        size_t count() override;
+        std::string name(size_t port) override;
+        bool external(size_t port) override;
+        size_t notes(size_t port) override;
+        uint16_t channel_mask(size_t port) override;
+        std::unique_ptr<Connection> open(size_t port) override;
+
+        size_t in_count() override;
+        Caps in_caps(size_t port) override;
+        std::unique_ptr<Input> open_in(size_t port, Receiver& receiver) override;
+
+        /// @brief All bytes sent to @p port, in order
+        std::vector<uint8_t> bytes(size_t port) const;
+
+        /// @brief Every send to @p port, with the time it was received
+        std::vector<Record> records(size_t port) const;
+
+        /// @brief Number of sends made to @p port
+        size_t sends(size_t port) const;
+
+        /// @brief Pre-allocate space for @p bytes bytes on every port
+        /// Keeps allocations out of throughput measurements
+        void reserve(size_t bytes);
+
+        /// @brief Forget everything recorded
+        void clear();
+
+        /// @brief Plug in or unplug ports, keeping the first @p ports
+        /// Sending to an unplugged port throws @b MidiDisconnected, and
+        /// plugging it back in keeps what it had recorded
+        void set_count(size_t ports);
+
+    private:
+        class Port;
+        class Loopback;
+        struct Event {
+            Clock::time_point time;
+            size_t offset;
+            size_t size;
+        };
+        struct Log {
+            bool open = false;
+            Receiver* receiver = nullptr;
+            std::vector<uint8_t> bytes;
+            std::vector<Event> events;
+        };
+
+        bool _running_status;
+        mutable std::mutex _mtx;
+        // Logs of unplugged ports are kept, as connections may still use them
+        std::vector<Log> _ports;
+        size_t _count;
+
+        Log& log(size_t port, const char* method);
+        const Log& log(size_t port, const char* method) const;
+};
+
+#endif // MIDI_MEMORY_SINK_HPP_
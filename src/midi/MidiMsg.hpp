@@ -0,0 +1,312 @@
+/**
+ * @file MidiMsg.hpp
+ * @brief Provides `MidiMsg`, a single MIDI message, and `MidiEncoder` and
+ *        `MidiDecoder` for turning them into wire bytes and back
+ */
+#ifndef MIDI_MSG_HPP_
+#define MIDI_MSG_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @struct MidiMsg
+ * @brief A MIDI channel-voice message, stored as its wire bytes
+ *
+ * Trivially copyable and 4 bytes in size, so batches of messages can be
+ * stored and copied cheaply. Channels are `0` through `15`, and data
+ * bytes are masked to 7 bits.
+ *
+ * @code
+ * std::vector<MidiMsg> burst = {
+ *     MidiMsg::program_change(24),
+ *     MidiMsg::note_on(60, 100),
+ *     MidiMsg::control_change(MidiMsg::Sustain, 127, 0),
+ *     MidiMsg::pitch_bend(-2048, 0)
+ * };
+ * out.send(burst);
+ * @endcode
+ */
+struct MidiMsg {
+    uint8_t status = 0;
+    uint8_t data0 = 0;
+    uint8_t data1 = 0;
+    uint8_t reserved = 0;
+
+    /// @brief Upper nibble of the status byte of each channel-voice message
+    enum Type : uint8_t {
+        NoteOff         = 0x80,
+        NoteOn          = 0x90,
+        PolyPressure    = 0xA0,
+        ControlChange   = 0xB0,
+        ProgramChange   = 0xC0,
+        ChannelPressure = 0xD0,
+        PitchBend       = 0xE0,
+        System          = 0xF0
+    };
+
+    /// @brief Some common controllers for @b control_change
+    enum Controller : uint8_t {
+        ModWheel      = 1,
+        Volume        = 7,
+        Pan           = 10,
+        Expression    = 11,
+        Sustain       = 64,
+        AllSoundOff   = 120,
+        ResetAll      = 121,
+        AllNotesOff   = 123
+    };
+
+    /** @name Channel-voice messages
+     * @{
+     */
+        static constexpr MidiMsg note_on(uint8_t note, uint8_t vel, uint8_t channel = 0) {
+            return make(NoteOn, channel, note, vel);
+        }
+
+        static constexpr MidiMsg note_off(uint8_t note, uint8_t vel, uint8_t channel = 0) {
+            return make(NoteOff, channel, note, vel);
+        }
+
+        /// @brief Aftertouch of a single note
+        static constexpr MidiMsg poly_pressure(uint8_t note, uint8_t pressure, uint8_t channel = 0) {
+            return make(PolyPressure, channel, note, pressure);
+        }
+
+        static constexpr MidiMsg control_change(uint8_t controller, uint8_t value, uint8_t channel = 0) {
+            return make(ControlChange, channel, controller, value);
+        }
+
+        static constexpr MidiMsg program_change(uint8_t program, uint8_t channel = 0) {
+            return make(ProgramChange, channel, program, 0);
+        }
+
+        /// @brief Aftertouch of the whole channel
+        static constexpr MidiMsg channel_pressure(uint8_t pressure, uint8_t channel = 0) {
+            return make(ChannelPressure, channel, pressure, 0);
+        }
+
+        /// @param bend from `-8192` (down) through `8191` (up), `0` is centered
+        static constexpr MidiMsg pitch_bend(int16_t bend, uint8_t channel = 0) {
+            uint16_t raw = uint16_t(bend + 8192);
+            return make(PitchBend, channel, uint8_t(raw & 0x7F), uint8_t((raw >> 7) & 0x7F));
+        }
+    /**
+     * @}
+     */
+
+    /// @brief Kind of message, eg. @b NoteOn
+    constexpr Type type() const {
+        return status >= System ? Type(status) : Type(status & 0xF0);
+    }
+
+    /// @brief Whether @b data0 is a note, ie. a note on, note off or poly pressure
+    constexpr bool has_note() const {
+        return status >= NoteOff && status < ControlChange;
+    }
+
+    /// @brief Channel `0` through `15` of a channel-voice message
+    constexpr uint8_t channel() const {
+        return status & 0x0F;
+    }
+
+    /// @brief Value of a @b PitchBend message, see @b pitch_bend
+    constexpr int16_t bend() const {
+        return int16_t((data0 | (data1 << 7)) - 8192);
+    }
+
+    /// @brief Number of wire bytes, including the status byte
+    /// @note System exclusive is not supported, and reported as `1`
+    constexpr size_t size() const {
+        switch ( status & 0xF0 ) {
+            case ProgramChange:
+            case ChannelPressure:
+                return 2;
+            case System:
+                switch ( status ) {
+                    case 0xF1: // MTC quarter frame
+                    case 0xF3: // Song select
+                        return 2;
+                    case 0xF2: // Song position
+                        return 3;
+                    default:
+                        return 1;
+                }
+            default:
+                return 3;
+        }
+    }
+
+    constexpr bool operator==(const MidiMsg& other) const {
+        return status == other.status && data0 == other.data0 && data1 == other.data1;
+    }
+
+    constexpr bool operator!=(const MidiMsg& other) const {
+        return !(*this == other);
+    }
+
+    private:
+        static constexpr MidiMsg make(Type type, uint8_t channel, uint8_t d0, uint8_t d1) {
+            return {uint8_t(type | (channel & 0x0F)), uint8_t(d0 & 0x7F), uint8_t(d1 & 0x7F), 0};
+        }
+};
+
+static_assert(sizeof(MidiMsg) == 4, "MidiMsg should stay 4 bytes");
+static_assert(std::is_trivially_copyable<MidiMsg>::value, "MidiMsg should be trivially copyable");
+
+/**
+ * @class MidiEncoder
+ * @brief Writes messages as wire bytes, using MIDI running status
+ *
+ * A channel-voice message with the same status byte as the message
+ * before it is sent without its status byte, so a run of note-ons or
+ * control changes on one channel is a third smaller. System common
+ * messages cancel running status, real-time messages leave it alone.
+ *
+ * The receiver must see every byte written, so use one encoder per
+ * connection, and @b reset it whenever bytes may have been lost.
+ *
+ * @code
+ * MidiEncoder enc;
+ * uint8_t buffer[MidiEncoder::max_size(3)];
+ * const MidiMsg chord[] = {MidiMsg::note_on(60, 100), MidiMsg::note_on(64, 100), MidiMsg::note_on(67, 100)};
+ * size_t n = enc.encode(chord, 3, buffer); // 7 bytes instead of 9
+ * @endcode
+ */
+class MidiEncoder {
+    private:
+        uint8_t _status = 0;
+        bool _running;
+
+    public:
+        /// @param running_status `false` always writes the status byte
+        constexpr MidiEncoder(bool running_status = true): _running(running_status) { }
+
+        /// @brief Worst case number of bytes for @p count messages
+        static constexpr size_t max_size(size_t count) {
+            return 3 * count;
+        }
+
+        /// @brief Write @p msg to @p out
+        /// @return number of bytes written, at most 3
+        constexpr size_t encode(const MidiMsg& msg, uint8_t* out) {
+            size_t n = 0;
+            size_t size = msg.size();
+            if ( msg.status >= 0xF8 ) {
+                // Real-time, may be interleaved anywhere
+            } else if ( msg.status >= MidiMsg::System ) {
+                _status = 0;
+            } else if ( msg.status < 0x80 ) {
+                // Not a status byte, eg. a default MidiMsg, so never running
+                _status = 0;
+            } else if ( _running && msg.status == _status ) {
+                out[0] = msg.data0;
+                if ( size == 3 )
+                    out[1] = msg.data1;
+                return size - 1;
+            } else {
+                _status = msg.status;
+            }
+            out[n++] = msg.status;
+            if ( size > 1 )
+                out[n++] = msg.data0;
+            if ( size > 2 )
+                out[n++] = msg.data1;
+            return n;
+        }
+
+        /// @brief Write all of @p msgs to @p out
+        /// @param out must have space for @b max_size(count) bytes
+        /// @return number of bytes written
+        constexpr size_t encode(const MidiMsg* msgs, size_t count, uint8_t* out) {
+            size_t n = 0;
+            for ( size_t i = 0; i < count; i++ )
+                n += encode(msgs[i], out + n);
+            return n;
+        }
+
+        /// @brief Forget the running status, so the next message is sent in full
+        constexpr void reset() {
+            _status = 0;
+        }
+};
+
+/**
+ * @class MidiDecoder
+ * @brief Reads messages from wire bytes, following MIDI running status
+ *
+ * The counterpart of @b MidiEncoder, for bytes received from a MIDI in.
+ * Real-time messages are returned as soon as they are seen, even between
+ * the bytes of another message. System exclusive is skipped, as are data
+ * bytes without a status byte to go with them.
+ *
+ * @code
+ * MidiDecoder dec;
+ * MidiMsg msgs[6];
+ * const uint8_t bytes[] = {0x90, 60, 100, 64, 100, 67, 100};
+ * size_t n = dec.decode(bytes, sizeof(bytes), msgs); // 3 note-ons
+ * @endcode
+ */
+class MidiDecoder {
+    private:
+        uint8_t _status = 0;
+        uint8_t _data0 = 0;
+        bool _has_data0 = false;
+        bool _sysex = false;
+
+    public:
+        /// @brief Read one byte
+        /// @return `true` when it completes @p msg
+        constexpr bool decode(uint8_t byte, MidiMsg& msg) {
+            if ( byte >= 0xF8 ) {
+                // Real-time, may be interleaved anywhere
+                msg = {byte, 0, 0, 0};
+                return true;
+            }
+            if ( byte & 0x80 ) {
+                _has_data0 = false;
+                _sysex = byte == 0xF0;
+                _status = byte == 0xF0 || byte == 0xF7 ? 0 : byte;
+                if ( _status && MidiMsg{_status}.size() == 1 ) {
+                    // Eg. tune request, which has no data
+                    msg = {_status, 0, 0, 0};
+                    _status = 0;
+                    return true;
+                }
+                return false;
+            }
+            if ( _sysex || !_status )
+                return false;
+            if ( !_has_data0 && MidiMsg{_status}.size() == 3 ) {
+                _data0 = byte;
+                _has_data0 = true;
+                return false;
+            }
+            msg = _has_data0 ? MidiMsg{_status, _data0, byte, 0} : MidiMsg{_status, byte, 0, 0};
+            _has_data0 = false;
+            // System common messages cancel running status
+            if ( _status >= MidiMsg::System )
+                _status = 0;
+            return true;
+        }
+
+        /// @brief Read all of @p bytes
+        /// @param out must have space for @p size messages
+        /// @return number of messages written to @p out
+        constexpr size_t decode(const uint8_t* bytes, size_t size, MidiMsg* out) {
+            size_t n = 0;
+            for ( size_t i = 0; i < size; i++ )
+                n += decode(bytes[i], out[n]);
+            return n;
+        }
+
+        /// @brief Forget any partial message and the running status
+        constexpr void reset() {
+            _status = 0;
+            _has_data0 = false;
+            _sysex = false;
+        }
+};
+
+#endif // MIDI_MSG_HPP_
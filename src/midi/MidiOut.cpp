@@ -1,95 +1,11 @@
-#ifdef _WIN32
-    extern "C" {
-        #include <Windows.h>
-        #include <mmeapi.h>
-    }
-#else
-    #error "Only Window's MIDI API is implemented!"
-#endif
-
 #include <cstdint>
+#include <mutex>
+#include <chrono>
+#include <new>
 
 #include "MidiOut.hpp"
 #include "MidiError.hpp"
-#include "MidiError.cpp"
-
-/** === System Specific APIs === */
-/// @note Provides the following methods:
-///
-/// std::string midi_out_name(t port)
-/// @returns "" if not a real port, or unavailable
-///
-/// bool midi_out_open(*out, port)
-/// @param out should be NULL, and will be set to a valid port
-/// @note does not actually check for NULL at the moment,
-///       nor automatically close it if open 
-/// @return false in case of error, true on success
-///
-/// bool midi_out_close(*out)
-/// @param out is set to NULL on success, assumes is valid output
-/// @return false in case of error, true on success
-
-#ifdef _WIN32
-    /// @note Windows MultiMedia implementation
-std::string midi_out_name(UINT port) {
-    char buffer[4096];
-    MIDIOUTCAPS moc;
-    midi_out_error(midiOutGetDevCaps(port, &moc, sizeof(moc)), "midi_out_name");
-    if ( snprintf(buffer, sizeof(buffer), "%s", moc.szPname) >= sizeof(buffer) )
-        throw MidiRuntimeError("midi_out_name: buffer overflow");
-    return std::string(buffer);
-}
-
-bool midi_out_external(UINT port) {
-    MIDIOUTCAPS moc;
-    midi_out_error(midiOutGetDevCaps(port, &moc, sizeof(moc)), "midi_out_external");
-    return moc.wTechnology == MOD_MIDIPORT;
-}
-
-size_t midi_out_notes(UINT port) {
-    MIDIOUTCAPS moc;
-    midi_out_error(midiOutGetDevCaps(port, &moc, sizeof(moc)), "midi_out_notes");
-    return moc.wNotes;
-}
-
-uint16_t midi_out_channel_mask(UINT port) {
-    MIDIOUTCAPS moc;
-    midi_out_error(midiOutGetDevCaps(port, &moc, sizeof(moc)), "midi_out_channel_mask");
-    return moc.wChannelMask;
-}
-
-bool midi_out_open(HMIDIOUT* out, UINT port) {
-    midi_out_error(midiOutOpen(out, port, 0, 0, CALLBACK_NULL), "midiOutOpen");
-    return true;
-}
-
-bool midi_out_close(HMIDIOUT* out) {
-    midi_out_error(midiOutReset(*out), "midiOutReset");
-    midi_out_error(midiOutClose(*out), "midiOutClose");
-    *out = NULL;
-    return true;
-}
-
-size_t midi_out_count() {
-    return midiOutGetNumDevs();
-}
-
-bool midi_out_send(HMIDIOUT out, uint8_t status_byte, uint8_t data0, uint8_t data1) {
-    union {
-        DWORD w;
-        BYTE  b[4];
-    } msg;
-    msg.b[0] = status_byte;
-    msg.b[1] = data0 & 0x7F;
-    msg.b[2] = data1 & 0x7F;
-    msg.b[3] = 0;
-
-    midi_out_error(midiOutShortMsg(out, msg.w), "midiOutShortMsg");
-    return true;
-}
-#else
-    #error "Only implemented for WIN32 at the moment!"
-#endif // _WIN32
+#include "MidiBackend.hpp"
 
 /** === MidiOut Impl === */
 /**
@@ -101,6 +17,9 @@ bool midi_out_send(HMIDIOUT out, uint8_t status_byte, uint8_t data0, uint8_t dat
  *   with a separate "port" value identifying the specific obejct,
  *   and handles for the "connection" established to the port
  * 
+ * The system specific parts live behind @b MidiBackend, see
+ * MidiWinMM.cpp, MidiAlsa.cpp and MidiMemorySink.cpp
+ * 
  * Importantly implements the following methods that Info needs
  * 
  * std::string name() const;
@@ -108,62 +27,89 @@ bool midi_out_send(HMIDIOUT out, uint8_t status_byte, uint8_t data0, uint8_t dat
  * uint16_t channels() const;
  */
 struct MidiOut::Impl {
-    #ifndef _WIN32
-        #warning "Assumes MIDI implementation has separate 'port' and 'connection handle'"
-    #endif
     /// @brief Create "shallow instance" - not actually connected to the port 
-    Impl(UINT p): port(p), out(NULL) {}
+    Impl(std::shared_ptr<MidiBackend> b, size_t p): backend(std::move(b)), port(p) {}
 
     /// @brief Create a "shallow" copy of self - utility for later 
     std::unique_ptr<Impl> shallow_copy() const {
-        return std::make_unique<Impl>(port);
+        return std::make_unique<Impl>(backend, port);
     }
 
     bool external() const {
-        return midi_out_external(port);
+        return backend->external(port);
     }
 
     std::string name() const {
-        return midi_out_name(port);
+        return backend->name(port);
     }
 
     size_t notes() const {
-        return midi_out_notes(port);
+        return backend->notes(port);
     }
 
     uint16_t channel_mask() const {
-        return midi_out_channel_mask(port);
+        return backend->channel_mask(port);
+    }
+
+    MidiBackend::Caps caps() const {
+        return backend->caps(port);
+    }
+
+    size_t index() const {
+        return port;
     }
 
     bool close() {
-        if ( connected() )
-            return midi_out_close(&out);
+        out = nullptr;
         return true;
     }
 
     bool connect() {
         if ( connected() )
             return true;
-        return midi_out_open(&out, port);
+        out = backend->open(port);
+        encoder = MidiEncoder(out->running_status());
+        return true;
     }
 
     // Returns if this has at any point been connected
     bool connected() const {
-        return out != NULL;
+        return out != nullptr;
     }
 
-    bool send(uint8_t status, uint8_t d0, uint8_t d1, uint8_t channel) {
-        status |= channel;
-        return midi_out_send(out, status, d0, d1);
+    /// @note Only throws when @p raise is set, see @b flush
+    MidiStatus send(const MidiMsg& msg, bool raise) {
+        uint8_t bytes[MidiEncoder::max_size(1)];
+        return flush(bytes, encoder.encode(msg, bytes), 1, raise);
+    }
+
+    /// @brief Encode all messages into one buffer, and flush it once
+    MidiStatus send(const MidiMsg* msgs, size_t count, size_t& sent, bool raise) {
+        if ( !fit(MidiEncoder::max_size(count)) )
+            return failed(MidiErrorKind::SysError);
+        sent = encoder.encode(msgs, count, buffer.data());
+        return flush(buffer.data(), sent, count, raise);
+    }
+
+    /// @brief Same as @b send, for one message per note of a chord
+    MidiStatus send(MidiMsg::Type type, const Chord& chord, uint8_t vel, uint8_t channel, size_t& sent, bool raise) {
+        uint8_t bytes[MidiEncoder::max_size(Chord::capacity)];
+        sent = 0;
+        for ( auto note: chord ) {
+            MidiMsg msg = type == MidiMsg::NoteOn ? MidiMsg::note_on(note, vel, channel) : MidiMsg::note_off(note, vel, channel);
+            sent += encoder.encode(msg, bytes + sent);
+        }
+        return flush(bytes, sent, chord.size(), raise);
     }
 
     // Check if connection is still good
     // bool test_connection() ...
 
-    Impl(const Impl& o): port(o.port), out(NULL) { }
+    Impl(const Impl& o): backend(o.backend), port(o.port) { }
 
     Impl& operator=(const Impl& o) {
         close();
+        backend = o.backend;
         port = o.port;
         return *this;
     }
@@ -172,21 +118,100 @@ struct MidiOut::Impl {
         close();
     }
 
+    /// @brief Where sends are counted, if anywhere
+    MidiStats* stats = nullptr;
+
     private:
-        #ifdef _WIN32
-            UINT     port;
-            HMIDIOUT out;
-        #endif
+        std::shared_ptr<MidiBackend> backend;
+        size_t port;
+        std::unique_ptr<MidiBackend::Connection> out;
+        // Running status is per connection, as it depends on what the receiver saw
+        MidiEncoder encoder;
+        // Reused between batches, so steady sending does not allocate
+        std::vector<uint8_t> buffer;
+
+        /// @brief Grow @b buffer to at least @p size bytes
+        bool fit(size_t size) noexcept {
+            try {
+                if ( buffer.size() < size )
+                    buffer.resize(size);
+                return true;
+            } catch ( const std::bad_alloc& ) {
+                return false;
+            }
+        }
+
+        /// @brief Hand @p bytes to the connection
+        /// @param raise Rethrow what the connection's @b send throws, so the
+        ///        error keeps the backend's own message, eg. from WinMM
+        MidiStatus flush(const uint8_t* bytes, size_t size, size_t messages, bool raise) {
+            if ( size == 0 )
+                return MidiStatus();
+            auto start = stats ? MidiStats::Clock::now() : MidiStats::Clock::time_point();
+            MidiStatus status;
+            if ( raise ) {
+                try {
+                    out->send(bytes, size);
+                } catch ( const MidiError& e ) {
+                    failed(e.kind());
+                    throw;
+                } catch ( ... ) {
+                    failed(MidiErrorKind::Other);
+                    throw;
+                }
+            } else {
+                status = out->try_send(bytes, size);
+            }
+            if ( !status )
+                return failed(status.kind());
+            if ( stats )
+                stats->record(messages, size, MidiStats::Clock::now() - start);
+            return status;
+        }
+
+        MidiStatus failed(MidiErrorKind kind) noexcept {
+            // Unknown how much the receiver got, so start over with a status byte
+            encoder.reset();
+            if ( stats )
+                stats->error(kind);
+            return kind;
+        }
 };
 
+/** === Backend Selection === */
+static std::mutex& backend_mutex() {
+    static std::mutex mtx;
+    return mtx;
+}
+
+static std::shared_ptr<MidiBackend>& backend_instance() {
+    static std::shared_ptr<MidiBackend> backend;
+    return backend;
+}
+
+std::shared_ptr<MidiBackend> MidiOut::backend() {
+    std::lock_guard<std::mutex> lock(backend_mutex());
+    auto& backend = backend_instance();
+    if ( !backend )
+        backend = MidiBackend::platform();
+    return backend;
+}
+
+void MidiOut::set_backend(std::shared_ptr<MidiBackend> backend) {
+    std::lock_guard<std::mutex> lock(backend_mutex());
+    backend_instance() = std::move(backend);
+}
+
 /** === Info Methods === */
-MidiOut::Info::Info(std::unique_ptr<Impl>&& pimpl): _pimpl(std::move(pimpl)) {};
+MidiOut::Info::Info(std::unique_ptr<Impl>&& pimpl): _pimpl(std::move(pimpl)), _caps(_pimpl->caps()) {};
+MidiOut::Info::Info(std::unique_ptr<Impl>&& pimpl, MidiBackend::Caps caps): _pimpl(std::move(pimpl)), _caps(std::move(caps)) {};
 MidiOut::Info::~Info() = default;
 
-MidiOut::Info::Info(const Info& o): _pimpl(o._pimpl->shallow_copy()) {};
+MidiOut::Info::Info(const Info& o): _pimpl(o._pimpl->shallow_copy()), _caps(o._caps) {};
 
 MidiOut::Info& MidiOut::Info::operator=(const Info& o) {
     _pimpl = o._pimpl->shallow_copy();
+    _caps = o._caps;
     return *this;
 };
 
@@ -195,31 +220,46 @@ MidiOut::Info& MidiOut::Info::operator=(Info&&) = default;
 
 // The MidiOut::Info will never have a NULL _pimpl field
 bool MidiOut::Info::external() const {
-    return _pimpl->external();
+    return _caps.external;
 }
 
 std::string MidiOut::Info::name() const {
-    return _pimpl->name();
+    return _caps.name;
 }
 
 size_t MidiOut::Info::notes() const {
-    return _pimpl->notes();
+    return _caps.notes;
 }
 
 uint16_t MidiOut::Info::channel_mask() const {
-    return _pimpl->channel_mask();
+    return _caps.channel_mask;
+}
+
+const MidiBackend::Caps& MidiOut::Info::caps() const {
+    return _caps;
+}
+
+size_t MidiOut::Info::port() const {
+    return _pimpl->index();
 }
 
 /** === MidiOut Methods === */
 std::vector<MidiOut::Info> MidiOut::discover() {
+    return discover(backend());
+}
+
+std::vector<MidiOut::Info> MidiOut::discover(std::shared_ptr<MidiBackend> backend) {
+    // One enumeration for every port's capabilities
+    std::vector<MidiBackend::Caps> ports = backend->ports();
     std::vector<Info> found;
-    for ( size_t i = 0; i < midi_out_count(); i++ )
-        found.emplace_back(std::make_unique<Impl>(i));
+    found.reserve(ports.size());
+    for ( size_t i = 0; i < ports.size(); i++ )
+        found.emplace_back(std::make_unique<Impl>(backend, i), std::move(ports[i]));
     return found;
 }
 
 size_t MidiOut::count() {
-    return midi_out_count();
+    return backend()->count();
 }
 
 bool MidiOut::connected() const {
@@ -254,51 +294,145 @@ uint16_t MidiOut::channel_mask() const {
 
 MidiOut::MidiOut() = default;
 MidiOut::~MidiOut() = default;
+MidiOut::MidiOut(MidiOut&&) = default;
+MidiOut& MidiOut::operator=(MidiOut&&) = default;
+
+MidiOut::MidiOut(size_t port): MidiOut(port, backend()) {}
 
-MidiOut::MidiOut(size_t port): _pimpl(std::make_unique<Impl>(port)) {
+MidiOut::MidiOut(size_t port, std::shared_ptr<MidiBackend> backend): _pimpl(std::make_unique<Impl>(std::move(backend), port)) {
     if ( !_pimpl->connect() )
         _pimpl = nullptr;
 }
 
 MidiOut& MidiOut::operator=(const Info& out) {
     _pimpl = out._pimpl->shallow_copy();
+    _pimpl->stats = _stats_enabled ? _stats.get() : nullptr;
     _pimpl->connect();
     return *this;
 }
 
+MidiOut& MidiOut::enable_stats(bool enable) {
+    if ( enable && !_stats )
+        _stats = std::make_unique<MidiStats>();
+    _stats_enabled = enable;
+    if ( _pimpl )
+        _pimpl->stats = enable ? _stats.get() : nullptr;
+    return *this;
+}
+
+MidiStats::Snapshot MidiOut::stats() const {
+    return _stats ? _stats->snapshot() : MidiStats::Snapshot();
+}
+
+MidiStatus MidiOut::unconnected() noexcept {
+    if ( _stats_enabled )
+        _stats->error(MidiErrorKind::Unconnected);
+    return MidiErrorKind::Unconnected;
+}
+
+void MidiOut::check(MidiStatus status, const char* method) {
+    if ( !status )
+        throw_midi_error(status.kind(), std::string(method) + " - " + midi_error_text(status.kind()));
+}
+
 MidiOut& MidiOut::set_velocity(uint8_t vel) {
     _vel = 0x7F & vel;
     return *this;
 }
 
+MidiOut& MidiOut::set_channel(uint8_t channel) {
+    _channel = 0x0F & channel;
+    return *this;
+}
+
+MidiStatus MidiOut::try_send(const MidiMsg& msg) noexcept {
+    return transmit(msg, false);
+}
+
+MidiStatus MidiOut::try_send(Span<const MidiMsg> msgs) noexcept {
+    return transmit(msgs, false);
+}
+
+MidiStatus MidiOut::transmit(const MidiMsg& msg, bool raise) {
+    if ( !_pimpl )
+        return unconnected();
+    return _pimpl->send(msg, raise);
+}
+
+MidiStatus MidiOut::transmit(Span<const MidiMsg> msgs, bool raise) {
+    if ( !_pimpl )
+        return unconnected();
+    auto start = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    MidiStatus status = _pimpl->send(msgs.data(), msgs.size(), bytes, raise);
+    if ( status )
+        _last_batch = {msgs.size(), bytes, std::chrono::steady_clock::now() - start};
+    return status;
+}
+
+MidiStatus MidiOut::try_chord(MidiMsg::Type type, const Chord& chord, bool raise) {
+    if ( !_pimpl )
+        return unconnected();
+    auto start = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    MidiStatus status = _pimpl->send(type, chord, _vel, _channel, bytes, raise);
+    if ( status )
+        _last_batch = {chord.size(), bytes, std::chrono::steady_clock::now() - start};
+    return status;
+}
+
+MidiStatus MidiOut::try_note_on(const Chord& chord) noexcept {
+    return try_chord(MidiMsg::NoteOn, chord, false);
+}
+
+MidiStatus MidiOut::try_note_off(const Chord& chord) noexcept {
+    return try_chord(MidiMsg::NoteOff, chord, false);
+}
+
 MidiOut& MidiOut::operator<<(uint8_t note_on) {
-    if ( _pimpl )
-        _pimpl->send(0x90, note_on, 120, 0);
-    else
-        throw MidiUnconnected("MidiOut << - Must connect first!");
+    check(transmit(MidiMsg::note_on(note_on, _vel, _channel), true), "MidiOut <<");
     return *this;
 }
 
 MidiOut& MidiOut::operator<<(std::pair<uint8_t, uint8_t> note_n_vel) {
-    if ( _pimpl )
-        _pimpl->send(0x90, note_n_vel.first, note_n_vel.second, 0);
-    else
-        throw MidiUnconnected("MidiOut << - Must connect first!");
+    check(transmit(MidiMsg::note_on(note_n_vel.first, note_n_vel.second, _channel), true), "MidiOut <<");
     return *this;
 }
 
 MidiOut& MidiOut::operator>>(uint8_t note_off) {
-    if ( _pimpl )
-        _pimpl->send(0x80, note_off, 120, 0);
-    else
-        throw MidiUnconnected("MidiOut >> - Must connect first!");
+    check(transmit(MidiMsg::note_off(note_off, _vel, _channel), true), "MidiOut >>");
     return *this;
 }
 
 MidiOut& MidiOut::operator>>(std::pair<uint8_t, uint8_t> note_n_vel) {
-    if ( _pimpl )
-        _pimpl->send(0x80, note_n_vel.first, note_n_vel.second, 0);
-    else
-        throw MidiUnconnected("MidiOut >> - Must connect first!");
+    check(transmit(MidiMsg::note_off(note_n_vel.first, note_n_vel.second, _channel), true), "MidiOut >>");
+    return *this;
+}
+
+MidiOut& MidiOut::operator<<(const MidiMsg& msg) {
+    check(transmit(msg, true), "MidiOut <<");
     return *this;
-}
\ No newline at end of file
+}
+
+MidiOut::Batch MidiOut::send(Span<const MidiMsg> msgs) {
+    check(transmit(msgs, true), "MidiOut::send");
+    return _last_batch;
+}
+
+MidiOut::Batch MidiOut::send(std::initializer_list<MidiMsg> msgs) {
+    return send(Span<const MidiMsg>(msgs.begin(), msgs.size()));
+}
+
+MidiOut& MidiOut::operator<<(const Chord& chord) {
+    check(try_chord(MidiMsg::NoteOn, chord, true), "MidiOut <<");
+    return *this;
+}
+
+MidiOut& MidiOut::operator>>(const Chord& chord) {
+    check(try_chord(MidiMsg::NoteOff, chord, true), "MidiOut >>");
+    return *this;
+}
+
+const MidiOut::Batch& MidiOut::last_batch() const {
+    return _last_batch;
+}
@@ -11,6 +11,15 @@
 #include <vector>
 #include <cstdint>
 #include <utility>
+#include <chrono>
+#include <initializer_list>
+
+#include "MidiBackend.hpp"
+#include "MidiError.hpp"
+#include "MidiMsg.hpp"
+#include "MidiStats.hpp"
+#include "Span.hpp"
+#include "Chord.hpp"
 
 /**
  * @class MidiOut
@@ -45,9 +54,13 @@
  * out >> 60;
  * @endcode
  * 
- * @todo Implement void set_velocity(uint8_t);
- * @todo Implement broader MidiMsg type
- * @todo Implement MidiIn
+ * @par Example 3: Sending a chord in one go
+ * @code
+ * MidiOut out(0);
+ * out << Chord::major_triad(60);
+ * std::cout << out.last_batch().latency.count() << "ns" << std::endl;
+ * out >> Chord::major_triad(60);
+ * @endcode
  */
 class MidiOut {
     public:
@@ -68,8 +81,15 @@ class MidiOut {
         /// @brief Connect to the desired MIDI port
         MidiOut(size_t port);
 
+        /// @brief Connect to the desired port of a specific backend
+        MidiOut(size_t port, std::shared_ptr<MidiBackend> backend);
+
         /// @brief Try to connect to the desired MIDI out 
         MidiOut& operator=(const Info& out);
+
+        /// @brief Take over the connection of @p other
+        MidiOut(MidiOut&& other);
+        MidiOut& operator=(MidiOut&& other);
     /**
      * @}
      */
@@ -114,6 +134,10 @@ class MidiOut {
         /// @endcode
         MidiOut& set_velocity(uint8_t vel);
 
+        /// @brief Set the channel, `0` through `15`, for use with @b << and @b >>
+        /// Messages built with @b MidiMsg keep their own channel
+        MidiOut& set_channel(uint8_t channel);
+
         /// @brief Turn on note with default velocity 
         MidiOut& operator<<(uint8_t note_on);
 
@@ -127,6 +151,91 @@ class MidiOut {
         /// @brief Turn off note with desired velocity
         /// @param note_n_vel {note_off, velocity}
         MidiOut& operator>>(std::pair<uint8_t, uint8_t> note_n_vel);
+
+        /// @brief Send any channel-voice message
+        /// @code
+        /// out << MidiMsg::control_change(MidiMsg::Sustain, 127);
+        /// @endcode
+        MidiOut& operator<<(const MidiMsg& msg);
+    /**
+     * @}
+     */
+
+    /** @name Batches
+     * Send several messages with a single call to the backend, which
+     * hands them over in one go where the MIDI API allows it, eg. ALSA
+     * @{
+     */
+        /// @brief Outcome of sending a batch of messages
+        struct Batch {
+            size_t messages = 0;
+            size_t bytes = 0;
+            /// @brief Time spent encoding and handing the batch to the backend
+            std::chrono::nanoseconds latency{0};
+        };
+
+        /// @brief Send all messages at once
+        Batch send(Span<const MidiMsg> msgs);
+
+        /// @brief Send all messages at once
+        /// @code
+        /// out.send({MidiMsg::note_on(60, 100), MidiMsg::note_on(64, 100)});
+        /// @endcode
+        Batch send(std::initializer_list<MidiMsg> msgs);
+
+        /// @brief Turn on all notes of the chord with default velocity
+        MidiOut& operator<<(const Chord& chord);
+
+        /// @brief Turn off all notes of the chord with default velocity
+        MidiOut& operator>>(const Chord& chord);
+
+        /// @brief Outcome of the latest @b send, or chord @b << / @b >>
+        const Batch& last_batch() const;
+    /**
+     * @}
+     */
+
+    /** @name Non-throwing
+     * Same as the sends above, for real-time threads where an exception
+     * must not unwind. Failures come back as a @b MidiStatus holding the
+     * kind of @b MidiError the throwing call raises, and are counted in
+     * @b stats alike; the throwing calls are wrappers of these.
+     * Single messages and chords never allocate, and batches only when
+     * they are bigger than any sent before
+     * @code
+     * MidiStatus s = out.try_send(MidiMsg::note_on(60, 100));
+     * if ( s == MidiErrorKind::Disconnected )
+     *     reconnect_later = true;
+     * @endcode
+     * @{
+     */
+        /// @brief Send any channel-voice message
+        MidiStatus try_send(const MidiMsg& msg) noexcept;
+
+        /// @brief Send all messages at once, updating @b last_batch on success
+        MidiStatus try_send(Span<const MidiMsg> msgs) noexcept;
+
+        /// @brief Turn on all notes of the chord with default velocity
+        MidiStatus try_note_on(const Chord& chord) noexcept;
+
+        /// @brief Turn off all notes of the chord with default velocity
+        MidiStatus try_note_off(const Chord& chord) noexcept;
+    /**
+     * @}
+     */
+
+    /** @name Statistics
+     * Opt-in counters of what is sent, see @b MidiStats
+     * @{
+     */
+        /// @brief Start or stop counting sends, errors and latencies
+        /// Counters are kept while stopped, and across reconnecting.
+        /// Enable before sharing the @b MidiOut with other threads
+        MidiOut& enable_stats(bool enable = true);
+
+        /// @brief Copy of the counters, all zero if never enabled
+        /// Safe to call from another thread while this one sends
+        MidiStats::Snapshot stats() const;
     /**
      * @}
      */
@@ -135,7 +244,24 @@ class MidiOut {
         friend Info;     
         struct Impl;
         std::unique_ptr<Impl> _pimpl;
-        uint8_t _vel = 60;
+        uint8_t _vel = 120;
+        uint8_t _channel = 0;
+        Batch _last_batch;
+        std::unique_ptr<MidiStats> _stats;
+        bool _stats_enabled = false;
+
+        /// @brief Count the error, if counting
+        MidiStatus unconnected() noexcept;
+
+        /// @brief Throw the error matching a failed @p status, for failures
+        /// caught before reaching the backend, eg. not connected
+        static void check(MidiStatus status, const char* method);
+
+        /// @brief Send, throwing what the backend throws when @p raise is set,
+        /// and otherwise reporting failures as @b try_send does
+        MidiStatus transmit(const MidiMsg& msg, bool raise);
+        MidiStatus transmit(Span<const MidiMsg> msgs, bool raise);
+        MidiStatus try_chord(MidiMsg::Type type, const Chord& chord, bool raise);
 
     public:
     /** @name Discovery 
@@ -146,12 +272,35 @@ class MidiOut {
         /// @memberof midiout_discovery
         static std::vector<Info> discover();
 
+        /// @brief Discover all outputs of a specific backend
+        static std::vector<Info> discover(std::shared_ptr<MidiBackend> backend);
+
         /// @brief Count the number of currently connected/available outs
         static size_t count();
     /**
      * @}
      */
 
+    /** @name Backend
+     * Select the MIDI API used by @b MidiOut instances
+     * @{
+     */
+        /// @brief The backend used when none is given explicitly
+        /// Defaults to @b MidiBackend::platform
+        static std::shared_ptr<MidiBackend> backend();
+
+        /// @brief Replace the default backend
+        /// Existing connections keep using the backend they were made with,
+        /// and `nullptr` restores @b MidiBackend::platform
+        /// @code
+        /// // Run without a MIDI device, eg. on CI
+        /// MidiOut::set_backend(std::make_shared<MidiMemorySink>());
+        /// @endcode
+        static void set_backend(std::shared_ptr<MidiBackend> backend);
+    /**
+     * @}
+     */
+
         /**
          * @struct MidiOut::Info
          * @brief This is provided for use in searching for MIDI outs
@@ -162,6 +311,10 @@ class MidiOut {
          * (physical) MIDI outputs slightly differently - see methods
          * for specific implications
          * 
+         * The port's capabilities are read once, when it is discovered,
+         * so reading them again does not query the driver. They describe
+         * the port as it was then.
+         * 
          * @internal
          * @note Consider the following features that the Windows MIDI
          * API also provides:
@@ -176,6 +329,7 @@ class MidiOut {
             protected:
                 friend MidiOut;
                 std::unique_ptr<Impl> _pimpl;
+                MidiBackend::Caps _caps;
 
             public:
                 /// @brief Returns `true` if this represents is a physical MIDI connection
@@ -194,8 +348,17 @@ class MidiOut {
                 /// For @b Windows this returns `0` for external devices
                 uint16_t channel_mask() const;
 
+                /// @brief All of the above, as read when discovered
+                const MidiBackend::Caps& caps() const;
+
+                /// @brief Index of the port in its backend, when discovered
+                size_t port() const;
+
             public:
+                /// @brief Reads the capabilities of the port
                 Info(std::unique_ptr<Impl>&& pimpl);
+                /// @brief Uses capabilities already read, eg. by @b MidiBackend::ports
+                Info(std::unique_ptr<Impl>&& pimpl, MidiBackend::Caps caps);
                 ~Info();
 
                 Info(const Info& o);
@@ -0,0 +1,417 @@
+/**
+ * @file MidiPipeline.hpp
+ * @brief Provides `MidiPipeline`, which transforms what a @b MidiIn
+ *        receives and sends it to a @b MidiOut
+ */
+#ifndef MIDI_PIPELINE_HPP_
+#define MIDI_PIPELINE_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <tuple>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "MidiIn.hpp"
+#include "MidiOut.hpp"
+#include "MidiMsg.hpp"
+#include "MidiStats.hpp"
+#include "Chord.hpp"
+#include "Scale.hpp"
+
+/** === Stages === */
+/**
+ * @name Pipeline stages
+ * Each stage turns a batch of messages into another, and says how many
+ * messages one input can become at most:
+ *
+ * @code
+ * struct Stage {
+ *     static constexpr size_t expansion = 1;
+ *     size_t operator()(const MidiMsg* in, size_t count, MidiMsg* out) const noexcept;
+ * };
+ * @endcode
+ *
+ * Note off goes through the same mapping as note on, so whatever a
+ * stage turns a held note into is released with it.
+ * @{
+ */
+
+/**
+ * @struct Transpose
+ * @brief Move notes by a number of semitones, dropping those that leave `0` through `127`
+ */
+struct Transpose {
+    static constexpr size_t expansion = 1;
+
+    int8_t semitones = 0;
+
+    size_t operator()(const MidiMsg* in, size_t count, MidiMsg* out) const noexcept {
+        size_t n = 0;
+        for ( size_t i = 0; i < count; i++ ) {
+            MidiMsg msg = in[i];
+            if ( msg.has_note() ) {
+                int note = msg.data0 + semitones;
+                if ( note < 0 || note > 127 )
+                    continue;
+                msg.data0 = uint8_t(note);
+            }
+            out[n++] = msg;
+        }
+        return n;
+    }
+};
+
+/**
+ * @class QuantizeToScale
+ * @brief Move notes into a scale, to the nearest note by default
+ */
+class QuantizeToScale {
+    Scale::Quantizer _quantizer;
+
+    public:
+        static constexpr size_t expansion = 1;
+
+        explicit QuantizeToScale(const Scale& scale, Scale::Round round = Scale::Round::Nearest)
+            : _quantizer(scale.quantizer(round)) {}
+
+        size_t operator()(const MidiMsg* in, size_t count, MidiMsg* out) const noexcept {
+            for ( size_t i = 0; i < count; i++ ) {
+                out[i] = in[i];
+                if ( out[i].has_note() )
+                    out[i].data0 = _quantizer[out[i].data0];
+            }
+            return count;
+        }
+};
+
+/**
+ * @class VelocityCurve
+ * @brief Map the velocity of note ons through a table
+ * Note ons stay note ons, so no velocity is mapped to `0`
+ */
+class VelocityCurve {
+    std::array<uint8_t, 128> _table;
+
+    public:
+        static constexpr size_t expansion = 1;
+
+        /// @brief Leaves velocities as they are
+        VelocityCurve() {
+            for ( int v = 0; v < 128; v++ )
+                _table[v] = uint8_t(v);
+        }
+
+        /// @brief `127 * (v / 127)^gamma`, so below `1` is softer to play loud
+        static VelocityCurve gamma(double gamma) {
+            VelocityCurve curve;
+            for ( int v = 1; v < 128; v++ )
+                curve._table[v] = clamp(std::lround(127.0 * std::pow(v / 127.0, gamma)));
+            return curve;
+        }
+
+        /// @brief Spread velocities evenly over `[min, max]`
+        static VelocityCurve range(uint8_t min, uint8_t max) {
+            VelocityCurve curve;
+            for ( int v = 1; v < 128; v++ )
+                curve._table[v] = clamp(min + std::lround((max - min) * (v - 1) / 126.0));
+            return curve;
+        }
+
+        /// @brief Every note at the same velocity
+        static VelocityCurve fixed(uint8_t velocity) {
+            return range(velocity, velocity);
+        }
+
+        uint8_t operator[](uint8_t velocity) const {
+            return _table[velocity & 0x7F];
+        }
+
+        size_t operator()(const MidiMsg* in, size_t count, MidiMsg* out) const noexcept {
+            for ( size_t i = 0; i < count; i++ ) {
+                out[i] = in[i];
+                if ( out[i].type() == MidiMsg::NoteOn && out[i].data1 )
+                    out[i].data1 = _table[out[i].data1];
+            }
+            return count;
+        }
+
+    private:
+        static uint8_t clamp(long v) {
+            return uint8_t(v < 1 ? 1 : v > 127 ? 127 : v);
+        }
+};
+
+/**
+ * @class ChannelMap
+ * @brief Move channel-voice messages from one channel to another
+ */
+class ChannelMap {
+    std::array<uint8_t, 16> _table;
+
+    public:
+        static constexpr size_t expansion = 1;
+
+        /// @brief Leaves every channel as it is
+        ChannelMap() {
+            for ( uint8_t c = 0; c < 16; c++ )
+                _table[c] = c;
+        }
+
+        /// @brief Everything to @p channel
+        explicit ChannelMap(uint8_t channel) {
+            _table.fill(channel & 0x0F);
+        }
+
+        /// @brief Send @p from to @p to as well
+        ChannelMap& map(uint8_t from, uint8_t to) {
+            _table[from & 0x0F] = to & 0x0F;
+            return *this;
+        }
+
+        size_t operator()(const MidiMsg* in, size_t count, MidiMsg* out) const noexcept {
+            for ( size_t i = 0; i < count; i++ ) {
+                out[i] = in[i];
+                if ( out[i].status < MidiMsg::System )
+                    out[i].status = uint8_t((out[i].status & 0xF0) | _table[out[i].status & 0x0F]);
+            }
+            return count;
+        }
+};
+
+/**
+ * @class ChordFromNote
+ * @brief Play a chord for each note, eg. `ChordFromNote(Chord::major_triad)`
+ *
+ * The chord of every note is built once, up front, by the factory given.
+ * @note Two held notes whose chords share a note also share its note off
+ */
+class ChordFromNote {
+    std::array<Chord, 128> _chords;
+
+    public:
+        static constexpr size_t expansion = Chord::capacity;
+
+        /// @param factory anything callable as `Chord(Note)`
+        template <class Factory>
+        explicit ChordFromNote(Factory factory) {
+            for ( int note = 0; note < 128; note++ )
+                _chords[note] = factory(Note(uint8_t(note)));
+        }
+
+        size_t operator()(const MidiMsg* in, size_t count, MidiMsg* out) const noexcept {
+            size_t n = 0;
+            for ( size_t i = 0; i < count; i++ ) {
+                if ( in[i].type() != MidiMsg::NoteOn && in[i].type() != MidiMsg::NoteOff ) {
+                    out[n++] = in[i];
+                    continue;
+                }
+                for ( Note note: _chords[in[i].data0] ) {
+                    out[n] = in[i];
+                    out[n++].data0 = note.note();
+                }
+            }
+            return n;
+        }
+};
+
+/**
+ * @}
+ */
+
+/** === Pipeline === */
+/**
+ * @class MidiPipeline
+ * @brief Chain of stages between a @b MidiIn and a @b MidiOut, run on one thread
+ *
+ * Stages are composed at compile time, so every call is direct and can
+ * be inlined. Each @b pump drains a batch from the @b MidiIn, passes it
+ * through every stage in turn, and sends the result as one batch. The
+ * buffers are sized from the stages' @b expansion up front, so running
+ * never allocates and never throws.
+ *
+ * With timing enabled, each stage's time per batch is counted, and
+ * the end-to-end latency from the message's arrival to its send is
+ * recorded in a @b MidiStats histogram. Both can be read from another
+ * thread while running.
+ *
+ * @code
+ * MidiIn in(0);
+ * MidiOut out(1);
+ * MidiPipeline pipeline(Transpose{-12}, QuantizeToScale(Scale::minor("A")),
+ *                       VelocityCurve::gamma(0.7), ChordFromNote(Chord::minor_triad));
+ * std::atomic<bool> running{true};
+ * std::thread thread([&] { pipeline.run(in, out, running); });
+ * @endcode
+ */
+template <class... Stages>
+class MidiPipeline {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr size_t stage_count = sizeof...(Stages);
+
+        /// @brief Most messages one received message can become
+        static constexpr size_t expansion = (size_t(1) * ... * Stages::expansion);
+
+        /// @brief Most messages drained from the @b MidiIn per @b pump
+        static constexpr size_t batch = 64;
+
+        /**
+         * @struct MidiPipeline::StageTiming
+         * @brief Time spent in one stage
+         */
+        struct StageTiming {
+            uint64_t batches = 0;
+            /// @brief Messages given to the stage
+            uint64_t messages = 0;
+            std::chrono::nanoseconds total{0};
+            /// @brief Longest batch
+            std::chrono::nanoseconds max{0};
+
+            std::chrono::nanoseconds per_message() const {
+                return messages ? total / int64_t(messages) : std::chrono::nanoseconds(0);
+            }
+        };
+
+        /**
+         * @struct MidiPipeline::Timing
+         * @brief Snapshot of the counters, see @b timing
+         */
+        struct Timing {
+            std::array<StageTiming, stage_count> stages;
+            /// @brief From arrival to sent, one sample per received message
+            MidiStats::Snapshot latency;
+            /// @brief Batches the @b MidiOut failed to send
+            uint64_t errors = 0;
+        };
+
+        explicit MidiPipeline(Stages... stages)
+            : _stages(std::move(stages)...), _a(batch * expansion), _b(batch * expansion) {}
+
+        /// @brief Access a stage, eg. to change it between pumps
+        /// Stages are not synchronized: only change them from the thread
+        /// calling @b pump, or while @b run is stopped
+        template <size_t I>
+        auto& stage() {
+            return std::get<I>(_stages);
+        }
+
+        /// @brief Run @p in through every stage into @p out
+        /// @param out must have space for `in.size() * expansion` messages
+        /// @return number of messages written to @p out
+        size_t process(Span<const MidiMsg> in, MidiMsg* out) noexcept {
+            MidiMsg* a = _a.data();
+            MidiMsg* b = _b.data();
+            size_t n = 0;
+            for ( size_t done = 0; done < in.size(); done += batch ) {
+                size_t count = std::min(batch, in.size() - done);
+                std::copy(in.data() + done, in.data() + done + count, a);
+                size_t k = apply(a, b, count, std::index_sequence_for<Stages...>());
+                const MidiMsg* result = stage_count % 2 ? b : a;
+                std::copy(result, result + k, out + n);
+                n += k;
+            }
+            return n;
+        }
+
+        /// @brief Move one batch from @p in to @p out
+        /// @return number of messages received, `0` when there were none
+        size_t pump(MidiIn& in, MidiOut& out) noexcept {
+            size_t count = in.receive(Span<MidiIn::Event>(_events.data(), _events.size()));
+            if ( count == 0 )
+                return 0;
+            MidiMsg* a = _a.data();
+            MidiMsg* b = _b.data();
+            for ( size_t i = 0; i < count; i++ )
+                a[i] = _events[i].msg;
+            size_t n = apply(a, b, count, std::index_sequence_for<Stages...>());
+            const MidiMsg* result = stage_count % 2 ? b : a;
+            if ( n && !out.try_send(Span<const MidiMsg>(result, n)) ) {
+                _errors.fetch_add(1, std::memory_order_relaxed);
+                return count;
+            }
+            if ( _timed.load(std::memory_order_relaxed) ) {
+                auto sent = Clock::now();
+                for ( size_t i = 0; i < count; i++ )
+                    _latency.record(1, 0, sent - _events[i].time);
+            }
+            return count;
+        }
+
+        /// @brief @b pump until @p running is cleared, yielding while there is nothing to do
+        void run(MidiIn& in, MidiOut& out, const std::atomic<bool>& running) noexcept {
+            while ( running.load(std::memory_order_relaxed) )
+                if ( pump(in, out) == 0 )
+                    std::this_thread::yield();
+        }
+
+        /// @brief Start or stop timing stages and latency
+        /// Costs two clock reads per stage and batch while on. Safe to
+        /// call while running, taking effect from the next batch
+        void enable_timing(bool enable = true) {
+            _timed.store(enable, std::memory_order_relaxed);
+        }
+
+        /// @brief Copy of the counters, safe to call while running
+        Timing timing() const {
+            Timing t;
+            for ( size_t i = 0; i < stage_count; i++ ) {
+                t.stages[i].batches = _timing[i].batches.load(std::memory_order_relaxed);
+                t.stages[i].messages = _timing[i].messages.load(std::memory_order_relaxed);
+                t.stages[i].total = std::chrono::nanoseconds(_timing[i].total.load(std::memory_order_relaxed));
+                t.stages[i].max = std::chrono::nanoseconds(_timing[i].max.load(std::memory_order_relaxed));
+            }
+            t.latency = _latency.snapshot();
+            t.errors = _errors.load(std::memory_order_relaxed);
+            return t;
+        }
+
+    private:
+        /// @brief Counters written by the pipeline's thread only
+        struct Counters {
+            std::atomic<uint64_t> batches{0};
+            std::atomic<uint64_t> messages{0};
+            std::atomic<int64_t> total{0};
+            std::atomic<int64_t> max{0};
+        };
+
+        std::tuple<Stages...> _stages;
+        std::vector<MidiMsg> _a;
+        std::vector<MidiMsg> _b;
+        std::array<MidiIn::Event, batch> _events;
+        std::atomic<bool> _timed{false};
+        std::array<Counters, stage_count> _timing;
+        MidiStats _latency;
+        std::atomic<uint64_t> _errors{0};
+
+        /// @brief Every stage in order, from @p a into @p b and then swapped
+        /// The result ends in @p b after an odd number of stages, else @p a
+        template <size_t... I>
+        size_t apply(MidiMsg* a, MidiMsg* b, size_t count, std::index_sequence<I...>) noexcept {
+            ((count = step<I>(a, b, count), std::swap(a, b)), ...);
+            return count;
+        }
+
+        template <size_t I>
+        size_t step(const MidiMsg* in, MidiMsg* out, size_t count) noexcept {
+            if ( !_timed.load(std::memory_order_relaxed) )
+                return std::get<I>(_stages)(in, count, out);
+            auto start = Clock::now();
+            size_t n = std::get<I>(_stages)(in, count, out);
+            int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            Counters& c = _timing[I];
+            c.batches.store(c.batches.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            c.messages.store(c.messages.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+            c.total.store(c.total.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+            if ( ns > c.max.load(std::memory_order_relaxed) )
+                c.max.store(ns, std::memory_order_relaxed);
+            return n;
+        }
+};
+
+#endif // MIDI_PIPELINE_HPP_
@@ -0,0 +1,233 @@
+#ifdef _WIN32
+    extern "C" {
+        #include <Windows.h>
+        #include <timeapi.h>
+    }
+#else
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+#include <algorithm>
+
+#include "MidiScheduler.hpp"
+#include "MidiError.hpp"
+
+/** === Thread Priority === */
+/**
+ * Low among real-time priorities, so audio and input threads, which
+ * usually run higher, still preempt the sender
+ */
+static constexpr int midi_sched_rt_priority = 10;
+
+/// @brief Best effort, as real-time priority usually needs privileges
+static bool midi_sched_priority(std::thread& thread, bool realtime) {
+    #ifdef _WIN32
+        return SetThreadPriority(thread.native_handle(), realtime ? THREAD_PRIORITY_HIGHEST : THREAD_PRIORITY_NORMAL) != 0;
+    #else
+        sched_param param{};
+        int policy = SCHED_OTHER;
+        if ( realtime ) {
+            policy = SCHED_FIFO;
+            param.sched_priority = std::min(std::max(midi_sched_rt_priority, sched_get_priority_min(SCHED_FIFO)),
+                                            sched_get_priority_max(SCHED_FIFO));
+        }
+        return pthread_setschedparam(thread.native_handle(), policy, &param) == 0;
+    #endif
+}
+
+/** === Queue === */
+static size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while ( p < n )
+        p <<= 1;
+    return p;
+}
+
+bool MidiScheduler::push(const Event& e) {
+    size_t pos = _tail.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = _slots[pos & _mask];
+        size_t turn = slot.turn.load(std::memory_order_acquire);
+        intptr_t diff = intptr_t(turn) - intptr_t(pos);
+        if ( diff == 0 ) {
+            if ( _tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) ) {
+                slot.event = e;
+                slot.turn.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if ( diff < 0 ) {
+            return false; // Full
+        } else {
+            pos = _tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// Only called by the sender thread
+bool MidiScheduler::pop(Event& e) {
+    size_t pos = _head.load(std::memory_order_relaxed);
+    Slot& slot = _slots[pos & _mask];
+    if ( slot.turn.load(std::memory_order_acquire) != pos + 1 )
+        return false; // Empty, or a producer is still writing
+    e = slot.event;
+    slot.turn.store(pos + _slots.size(), std::memory_order_release);
+    _head.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+/** === MidiScheduler Methods === */
+MidiScheduler::MidiScheduler(MidiOut&& out, size_t capacity):
+        _out(std::move(out)),
+        _slots(round_up_pow2(std::max<size_t>(capacity, 2))),
+        _mask(_slots.size() - 1),
+        _spin_ns(0) {
+    if ( !_out.connected() )
+        throw MidiUnconnected("MidiScheduler - Must connect first!");
+    for ( size_t i = 0; i < _slots.size(); i++ )
+        _slots[i].turn.store(i, std::memory_order_relaxed);
+    #ifdef _WIN32
+        // Default timer resolution is ~15ms, which sleep_until would inherit
+        timeBeginPeriod(1);
+    #endif
+    _thread = std::thread(&MidiScheduler::run, this);
+}
+
+MidiScheduler::~MidiScheduler() {
+    _running.store(false);
+    _thread.join();
+    #ifdef _WIN32
+        timeEndPeriod(1);
+    #endif
+}
+
+bool MidiScheduler::schedule(Clock::time_point when, MidiMsg msg) {
+    // A time already past means now, so jitter is counted from here
+    return enqueue(std::max(when, Clock::now()), msg);
+}
+
+size_t MidiScheduler::schedule(Clock::time_point when, Span<const MidiMsg> msgs) {
+    // Clamped once, and held back from the sender until all are queued,
+    // so they go out as one batch even when already due
+    when = std::max(when, Clock::now());
+    _batching.fetch_add(1, std::memory_order_acq_rel);
+    size_t accepted = 0;
+    for ( auto& m: msgs )
+        accepted += enqueue(when, m);
+    _batching.fetch_sub(1, std::memory_order_acq_rel);
+    return accepted;
+}
+
+bool MidiScheduler::enqueue(Clock::time_point when, const MidiMsg& msg) {
+    // Counted first, so wait() never sees a sent event as unscheduled
+    _scheduled.fetch_add(1, std::memory_order_relaxed);
+    if ( !push({when, 0, msg}) ) {
+        _scheduled.fetch_sub(1, std::memory_order_relaxed);
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void MidiScheduler::wait() const {
+    while ( _sent.load() + _errors.load() < _scheduled.load() )
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void MidiScheduler::set_spin(std::chrono::microseconds spin) {
+    _spin_ns.store(std::chrono::nanoseconds(spin).count(), std::memory_order_relaxed);
+}
+
+bool MidiScheduler::set_realtime(bool enable) {
+    return midi_sched_priority(_thread, enable);
+}
+
+MidiScheduler::Stats MidiScheduler::stats() const {
+    Stats s;
+    s.scheduled = _scheduled.load(std::memory_order_relaxed);
+    s.sent = _sent.load(std::memory_order_relaxed);
+    s.dropped = _dropped.load(std::memory_order_relaxed);
+    s.errors = _errors.load(std::memory_order_relaxed);
+    s.max_jitter = std::chrono::nanoseconds(_max_jitter_ns.load(std::memory_order_relaxed));
+    for ( size_t i = 0; i < _histogram.size(); i++ )
+        s.jitter_histogram[i] = _histogram[i].load(std::memory_order_relaxed);
+    return s;
+}
+
+void MidiScheduler::record(std::chrono::nanoseconds jitter) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(jitter).count();
+    size_t bucket = 0;
+    while ( bucket + 1 < jitter_buckets.size() && uint64_t(us) >= jitter_buckets[bucket] )
+        bucket++;
+    _histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    if ( jitter.count() > _max_jitter_ns.load(std::memory_order_relaxed) )
+        _max_jitter_ns.store(jitter.count(), std::memory_order_relaxed);
+}
+
+/**
+ * Sender thread: moves events from the queue into a min-heap ordered by
+ * (time, arrival), then fires everything that is due as one batch.
+ * Both the heap and the batch are allocated up-front.
+ */
+void MidiScheduler::run() {
+    const auto poll = std::chrono::milliseconds(1);
+    auto later = [](const Event& a, const Event& b) {
+        return a.time > b.time || (a.time == b.time && a.seq > b.seq);
+    };
+
+    std::vector<Event> heap;
+    std::vector<MidiMsg> batch;
+    std::vector<Clock::time_point> due;
+    heap.reserve(_slots.size());
+    batch.reserve(_slots.size());
+    due.reserve(_slots.size());
+    uint64_t seq = 0;
+
+    while ( _running.load(std::memory_order_relaxed) ) {
+        Event e;
+        while ( heap.size() < heap.capacity() && pop(e) ) {
+            e.seq = seq++;
+            heap.push_back(e);
+            std::push_heap(heap.begin(), heap.end(), later);
+        }
+
+        if ( heap.empty() ) {
+            std::this_thread::sleep_for(poll);
+            continue;
+        }
+
+        // Sleep in slices no longer than a poll, so earlier events can still arrive
+        auto next = heap.front().time;
+        auto spin = std::chrono::nanoseconds(_spin_ns.load(std::memory_order_relaxed));
+        auto now = Clock::now();
+        if ( next - now > spin ) {
+            std::this_thread::sleep_until(std::min<Clock::time_point>(next - spin, now + poll));
+            continue;
+        }
+        while ( (now = Clock::now()) < next )
+            std::this_thread::yield();
+        // A batch is being queued, take the rest of it first
+        if ( _batching.load(std::memory_order_acquire) > 0 ) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        batch.clear();
+        due.clear();
+        while ( !heap.empty() && heap.front().time <= now ) {
+            batch.push_back(heap.front().msg);
+            due.push_back(heap.front().time);
+            std::pop_heap(heap.begin(), heap.end(), later);
+            heap.pop_back();
+        }
+        // Never unwinds through this thread
+        if ( !_out.try_send(batch) ) {
+            _errors.fetch_add(batch.size(), std::memory_order_relaxed);
+            continue;
+        }
+        auto sent = Clock::now();
+        for ( auto t: due )
+            record(sent - t);
+        _sent.fetch_add(batch.size(), std::memory_order_relaxed);
+    }
+}
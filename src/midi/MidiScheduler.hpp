@@ -0,0 +1,148 @@
+/**
+ * @file MidiScheduler.hpp
+ * @brief Provides `MidiScheduler` for sending MIDI messages at set times
+ */
+#ifndef MIDI_SCHEDULER_HPP_
+#define MIDI_SCHEDULER_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include "MidiOut.hpp"
+#include "MidiMsg.hpp"
+#include "Span.hpp"
+
+/**
+ * @class MidiScheduler
+ * @brief Sends messages at absolute @b steady_clock times, from its own thread
+ *
+ * Events are handed over through a lock-free queue, so scheduling never
+ * blocks on the sender. The sender thread sleeps until the next event,
+ * and can be given real-time priority with @b set_realtime, and spin for
+ * the last moments before each event with @b set_spin, for lower jitter
+ * at the cost of CPU. Times are absolute, so timing does not drift over
+ * a long sequence.
+ *
+ * Events with the same time are sent in the order they were scheduled,
+ * as a single batch.
+ *
+ * @code
+ * MidiScheduler sched(MidiOut(0));
+ * auto t = MidiScheduler::Clock::now() + std::chrono::milliseconds(10);
+ * for ( auto n: Scale::major("C").notes_between(60, 72) ) {
+ *     sched.schedule(t, MidiMsg::note_on(n, 100));
+ *     t += std::chrono::milliseconds(250);
+ *     sched.schedule(t, MidiMsg::note_off(n, 0));
+ * }
+ * sched.wait();
+ * @endcode
+ */
+class MidiScheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /// @brief Upper bound (exclusive) of each jitter histogram bucket, in µs
+        /// The last bucket collects everything later than 5ms
+        static constexpr std::array<uint32_t, 10> jitter_buckets = {
+            10, 20, 50, 100, 200, 500, 1000, 2000, 5000, UINT32_MAX
+        };
+
+        /// @brief Counters of the sender thread
+        struct Stats {
+            /// @brief Accepted by @b schedule
+            uint64_t scheduled = 0;
+            /// @brief Handed to the @b MidiOut
+            uint64_t sent = 0;
+            /// @brief Rejected by @b schedule, as the queue was full
+            uint64_t dropped = 0;
+            /// @brief Failed to send, see @b MidiOut::try_send
+            uint64_t errors = 0;
+            /// @brief Latest send compared to its scheduled time
+            std::chrono::nanoseconds max_jitter{0};
+            /// @brief Count of sends per bucket of @b jitter_buckets
+            std::array<uint64_t, jitter_buckets.size()> jitter_histogram{};
+        };
+
+        /// @brief Start the sender thread, taking over @p out
+        /// @param capacity how many events can be waiting at once
+        explicit MidiScheduler(MidiOut&& out, size_t capacity = 4096);
+
+        /// @brief Stops the sender thread, dropping unsent events
+        ~MidiScheduler();
+
+        MidiScheduler(const MidiScheduler&) = delete;
+        MidiScheduler& operator=(const MidiScheduler&) = delete;
+
+        /// @brief Send @p msg at @p when
+        /// Safe to call from any thread, never blocks. A @p when already
+        /// past, eg. `Clock::time_point{}`, sends as soon as possible
+        /// and counts its jitter from the call
+        /// @return `false` if the queue is full
+        bool schedule(Clock::time_point when, MidiMsg msg);
+
+        /// @brief Send all of @p msgs together at @p when
+        /// @return how many of @p msgs fit in the queue
+        size_t schedule(Clock::time_point when, Span<const MidiMsg> msgs);
+
+        /// @brief Block until every scheduled event has been sent
+        void wait() const;
+
+        /// @brief How long the sender spins before an event, instead of sleeping
+        /// Longer is more precise, but burns more CPU, and with @b set_realtime
+        /// keeps other threads off the core. Defaults to 0, never spinning
+        void set_spin(std::chrono::microseconds spin);
+
+        /// @brief Run the sender at a low real-time priority, or back at normal
+        /// Off by default. Still below the usual audio thread priorities
+        /// @return `false` if not permitted, eg. without RT privileges
+        bool set_realtime(bool enable = true);
+
+        /// @brief Snapshot of the counters, readable while sending
+        Stats stats() const;
+
+    private:
+        struct Event {
+            Clock::time_point time;
+            uint64_t seq;
+            MidiMsg msg;
+        };
+
+        /// @brief Bounded multi-producer queue, see Dmitry Vyukov's MPMC queue
+        struct Slot {
+            std::atomic<size_t> turn;
+            Event event;
+        };
+
+        MidiOut _out;
+        std::vector<Slot> _slots;
+        size_t _mask;
+        alignas(64) std::atomic<size_t> _head{0};
+        alignas(64) std::atomic<size_t> _tail{0};
+
+        std::atomic<bool> _running{true};
+        /// @brief Spans part way through being queued
+        std::atomic<int> _batching{0};
+        std::atomic<int64_t> _spin_ns;
+
+        std::atomic<uint64_t> _scheduled{0};
+        std::atomic<uint64_t> _sent{0};
+        std::atomic<uint64_t> _dropped{0};
+        std::atomic<uint64_t> _errors{0};
+        std::atomic<int64_t> _max_jitter_ns{0};
+        std::array<std::atomic<uint64_t>, jitter_buckets.size()> _histogram{};
+
+        std::thread _thread;
+
+        bool push(const Event& e);
+        /// @brief Queue and count an event, at @p when as given
+        bool enqueue(Clock::time_point when, const MidiMsg& msg);
+        bool pop(Event& e);
+        void run();
+        void record(std::chrono::nanoseconds jitter);
+};
+
+#endif // MIDI_SCHEDULER_HPP_
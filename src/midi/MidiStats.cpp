@@ -0,0 +1,41 @@
+#include <algorithm>
+
+#include "MidiStats.hpp"
+
+/** === Histogram Methods === */
+std::chrono::nanoseconds MidiStats::Histogram::percentile(double q) const {
+    if ( total == 0 )
+        return std::chrono::nanoseconds(0);
+    if ( q <= 0 )
+        return min;
+    // Rank of the sample wanted, from 1
+    uint64_t rank = q >= 1 ? total : uint64_t(q * double(total) + 0.999999);
+    if ( rank == 0 )
+        rank = 1;
+    uint64_t seen = 0;
+    for ( size_t b = 0; b < buckets; b++ ) {
+        seen += counts[b];
+        if ( seen >= rank )
+            return std::min(std::chrono::nanoseconds(bucket_top(b)), max);
+    }
+    return max;
+}
+
+/** === MidiStats Methods === */
+MidiStats::Snapshot MidiStats::snapshot() const {
+    Snapshot s;
+    s.messages = _messages.load(std::memory_order_relaxed);
+    s.bytes = _bytes.load(std::memory_order_relaxed);
+    s.sends = _sends.load(std::memory_order_relaxed);
+    for ( size_t i = 0; i < midi_error_kinds; i++ )
+        s.errors[i] = _errors[i].load(std::memory_order_relaxed);
+    for ( size_t b = 0; b < buckets; b++ ) {
+        s.latency.counts[b] = _latency[b].load(std::memory_order_relaxed);
+        s.latency.total += s.latency.counts[b];
+    }
+    uint64_t min = _min.load(std::memory_order_relaxed);
+    s.latency.min = std::chrono::nanoseconds(s.latency.total ? min : 0);
+    s.latency.max = std::chrono::nanoseconds(_max.load(std::memory_order_relaxed));
+    s.latency.sum = std::chrono::nanoseconds(_sum.load(std::memory_order_relaxed));
+    return s;
+}
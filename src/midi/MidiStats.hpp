@@ -0,0 +1,151 @@
+/**
+ * @file MidiStats.hpp
+ * @brief Provides `MidiStats`, counters and a latency histogram for a MIDI connection
+ */
+#ifndef MIDI_STATS_HPP_
+#define MIDI_STATS_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "MidiError.hpp"
+
+/**
+ * @class MidiStats
+ * @brief What a connection has sent, how often it failed and how long
+ * the backend took to take each send
+ *
+ * Written by the thread sending, and read with @b snapshot by any other
+ * thread without stopping it: every counter is a relaxed atomic, so
+ * recording costs a few uncontended additions plus the two clock reads
+ * around the send, and a snapshot is a copy of ~4 KB.
+ *
+ * Latencies are counted in an HDR-style histogram: exact below 16 ns,
+ * then 16 buckets per power of 2, so any value is within 1/16 (~6%) of
+ * its bucket, from nanoseconds up to about a minute.
+ *
+ * @code
+ * MidiOut out(0);
+ * out.enable_stats();
+ * out << 60;
+ * MidiStats::Snapshot s = out.stats(); // From any thread
+ * std::cout << s.latency.percentile(0.99).count() << "ns" << std::endl;
+ * @endcode
+ */
+class MidiStats {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /// @brief Buckets per power of 2, and values counted exactly
+        static constexpr size_t sub_buckets = 16;
+        /// @brief Largest latency counted, as a power of 2 of nanoseconds
+        static constexpr size_t max_bits = 36;
+        static constexpr size_t buckets = (max_bits - 3) * sub_buckets;
+
+        /**
+         * @struct MidiStats::Histogram
+         * @brief Counts of latencies per bucket, see @b MidiStats
+         */
+        struct Histogram {
+            std::array<uint64_t, buckets> counts{};
+            uint64_t total = 0;
+            std::chrono::nanoseconds min{0};
+            std::chrono::nanoseconds max{0};
+            std::chrono::nanoseconds sum{0};
+
+            /// @brief Latency that @p q of the sends took at most, eg. 0.99
+            /// Returns the top of the bucket it falls in, capped to @b max
+            std::chrono::nanoseconds percentile(double q) const;
+
+            std::chrono::nanoseconds mean() const {
+                return total ? sum / int64_t(total) : std::chrono::nanoseconds(0);
+            }
+        };
+
+        /**
+         * @struct MidiStats::Snapshot
+         * @brief Copy of the counters, read counter by counter, so sends
+         * made while copying may show in some counters and not others
+         */
+        struct Snapshot {
+            /// @brief Messages handed to the backend
+            uint64_t messages = 0;
+            /// @brief Bytes handed to the backend
+            uint64_t bytes = 0;
+            /// @brief Calls to the backend, one per message or batch
+            uint64_t sends = 0;
+            /// @brief Failed sends per @b MidiErrorKind
+            std::array<uint64_t, midi_error_kinds> errors{};
+            /// @brief Time taken by each successful call to the backend
+            Histogram latency;
+
+            uint64_t error_count(MidiErrorKind kind) const {
+                return errors[size_t(kind)];
+            }
+        };
+
+        /// @brief Bucket holding a latency of @p ns nanoseconds
+        static constexpr size_t bucket(uint64_t ns) {
+            if ( ns < sub_buckets )
+                return size_t(ns);
+            size_t bits = 0;
+            for ( uint64_t v = ns; v >>= 1; )
+                bits++;
+            if ( bits >= max_bits )
+                return buckets - 1;
+            // 2^bits <= ns < 2^(bits + 1), split in 16 by the next 4 bits
+            return (bits - 3) * sub_buckets + size_t((ns >> (bits - 4)) & (sub_buckets - 1));
+        }
+
+        /// @brief Largest latency in nanoseconds counted in bucket @p b
+        static constexpr uint64_t bucket_top(size_t b) {
+            if ( b < sub_buckets )
+                return b;
+            size_t bits = b / sub_buckets + 3;
+            uint64_t width = uint64_t(1) << (bits - 4);
+            return (uint64_t(1) << bits) + (b % sub_buckets + 1) * width - 1;
+        }
+
+        /// @brief Count a successful send, taking @p latency
+        void record(size_t messages, size_t bytes, Clock::duration latency) {
+            uint64_t ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+            add(_messages, messages);
+            add(_bytes, bytes);
+            add(_sends, 1);
+            add(_latency[bucket(ns)], 1);
+            add(_sum, ns);
+            if ( ns > _max.load(std::memory_order_relaxed) )
+                _max.store(ns, std::memory_order_relaxed);
+            if ( ns < _min.load(std::memory_order_relaxed) )
+                _min.store(ns, std::memory_order_relaxed);
+        }
+
+        /// @brief Count a failed send
+        void error(MidiErrorKind kind) {
+            add(_errors[size_t(kind)], 1);
+        }
+
+        /// @brief Copy the counters, without blocking the sender
+        Snapshot snapshot() const;
+
+    private:
+        std::atomic<uint64_t> _messages{0};
+        std::atomic<uint64_t> _bytes{0};
+        std::atomic<uint64_t> _sends{0};
+        std::array<std::atomic<uint64_t>, midi_error_kinds> _errors{};
+        std::array<std::atomic<uint64_t>, buckets> _latency{};
+        std::atomic<uint64_t> _sum{0};
+        std::atomic<uint64_t> _min{UINT64_MAX};
+        std::atomic<uint64_t> _max{0};
+
+        /// @brief There is one writer, so a relaxed load and store is enough,
+        /// and is cheaper than an atomic add
+        static void add(std::atomic<uint64_t>& counter, uint64_t n) {
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+};
+
+#endif // MIDI_STATS_HPP_
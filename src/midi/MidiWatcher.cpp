@@ -0,0 +1,118 @@
+#include "MidiWatcher.hpp"
+#include "MidiError.hpp"
+
+/** === Matching === */
+static bool same_port(const MidiBackend::Caps& a, const MidiBackend::Caps& b) {
+    return a.name == b.name && a.external == b.external && a.notes == b.notes && a.channel_mask == b.channel_mask;
+}
+
+/** === MidiWatcher Methods === */
+MidiWatcher::MidiWatcher(std::chrono::milliseconds interval): MidiWatcher(MidiOut::backend(), nullptr, interval) {}
+
+MidiWatcher::MidiWatcher(Callback callback, std::chrono::milliseconds interval)
+    : MidiWatcher(MidiOut::backend(), std::move(callback), interval) {}
+
+MidiWatcher::MidiWatcher(std::shared_ptr<MidiBackend> backend, Callback callback, std::chrono::milliseconds interval)
+    : _backend(std::move(backend)), _callback(std::move(callback)), _interval(interval) {
+    _thread = std::thread(&MidiWatcher::run, this);
+}
+
+MidiWatcher::~MidiWatcher() {
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _stop = true;
+    }
+    _cv.notify_all();
+    _thread.join();
+}
+
+std::vector<MidiOut::Info> MidiWatcher::devices() const {
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _devices;
+}
+
+bool MidiWatcher::ready() const {
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _scans > 0;
+}
+
+bool MidiWatcher::wait_ready(std::chrono::milliseconds timeout) const {
+    std::unique_lock<std::mutex> lock(_mtx);
+    return _cv.wait_for(lock, timeout, [this] { return _scans > 0; });
+}
+
+std::vector<MidiWatcher::Event> MidiWatcher::poll() {
+    std::lock_guard<std::mutex> lock(_mtx);
+    std::vector<Event> events;
+    events.swap(_events);
+    return events;
+}
+
+void MidiWatcher::rescan() {
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _wake = true;
+    }
+    _cv.notify_all();
+}
+
+size_t MidiWatcher::scans() const {
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _scans;
+}
+
+void MidiWatcher::run() {
+    std::unique_lock<std::mutex> lock(_mtx);
+    while ( !_stop ) {
+        lock.unlock();
+        scan();
+        lock.lock();
+        _cv.wait_for(lock, _interval, [this] { return _stop || _wake; });
+        _wake = false;
+    }
+}
+
+/// @brief Enumerate without holding the lock, then publish the differences
+void MidiWatcher::scan() {
+    std::vector<MidiOut::Info> found;
+    try {
+        found = MidiOut::discover(_backend);
+    } catch ( const MidiError& ) {
+        // A port vanished while enumerating, try again next time
+        return;
+    }
+
+    std::vector<Event> events;
+    std::vector<bool> kept(found.size(), false);
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        for ( auto& old: _devices ) {
+            bool matched = false;
+            for ( size_t i = 0; i < found.size() && !matched; i++ )
+                if ( !kept[i] && same_port(old.caps(), found[i].caps()) )
+                    matched = kept[i] = true;
+            if ( !matched )
+                events.push_back({Removed, old});
+        }
+    }
+    for ( size_t i = 0; i < found.size(); i++ )
+        if ( !kept[i] )
+            events.push_back({Added, found[i]});
+
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _devices = std::move(found);
+        _scans++;
+        if ( !_callback )
+            for ( auto& e: events )
+                _events.push_back(std::move(e));
+    }
+    _cv.notify_all();
+    if ( _callback ) {
+        // Outside of _mtx, so the callback can call back into the watcher.
+        // Callbacks only run on the watcher's thread, so events arrive in
+        // order, and the destructor joining it means none after it returns
+        for ( auto& e: events )
+            _callback(e);
+    }
+}
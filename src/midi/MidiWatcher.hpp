@@ -0,0 +1,119 @@
+/**
+ * @file MidiWatcher.hpp
+ * @brief Provides `MidiWatcher`, which follows MIDI outs being plugged in and out
+ */
+#ifndef MIDI_WATCHER_HPP_
+#define MIDI_WATCHER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MidiBackend.hpp"
+#include "MidiOut.hpp"
+
+/**
+ * @class MidiWatcher
+ * @brief Discovers MIDI outs on a background thread, and reports ports
+ * being added and removed
+ *
+ * The watcher enumerates the backend's ports every @p interval, or
+ * straight away after @b rescan, and compares them with the last
+ * snapshot. Ports are matched by their capabilities, so a port whose
+ * index shifts because an earlier one was unplugged is not reported.
+ * The first scan reports every port as added.
+ *
+ * Events go to the callback, on the watcher's thread, or when there is
+ * none are queued for @b poll. The callback runs after the scan is
+ * published, so it may call any method of the watcher, eg. @b devices,
+ * but not destroy it. @b devices returns the latest snapshot
+ * without ever enumerating, so the application never waits on drivers.
+ *
+ * @code
+ * MidiWatcher watcher([](const MidiWatcher::Event& e) {
+ *     std::cout << (e.type == MidiWatcher::Added ? "+ " : "- ") << e.info.name() << std::endl;
+ * });
+ * // ...
+ * for ( auto& info: watcher.devices() )
+ *     if ( info.name() == "My Synth" )
+ *         out = info;
+ * @endcode
+ */
+class MidiWatcher {
+    public:
+        enum Type : uint8_t {
+            Added,
+            Removed,
+        };
+
+        /**
+         * @struct MidiWatcher::Event
+         * @brief A port appeared or disappeared
+         * For removed ports, @b info describes the port as it was
+         */
+        struct Event {
+            Type type;
+            MidiOut::Info info;
+        };
+
+        using Callback = std::function<void(const Event&)>;
+
+        /// @brief Watch the default backend, queueing events for @b poll
+        explicit MidiWatcher(std::chrono::milliseconds interval = std::chrono::milliseconds(500));
+
+        /// @brief Watch the default backend, calling @p callback on the watcher's thread
+        explicit MidiWatcher(Callback callback, std::chrono::milliseconds interval = std::chrono::milliseconds(500));
+
+        /// @brief Watch a specific backend
+        MidiWatcher(std::shared_ptr<MidiBackend> backend, Callback callback,
+                    std::chrono::milliseconds interval = std::chrono::milliseconds(500));
+
+        /// @brief Stops the thread, waiting for a scan in progress
+        ~MidiWatcher();
+
+        MidiWatcher(const MidiWatcher&) = delete;
+        MidiWatcher& operator=(const MidiWatcher&) = delete;
+
+        /// @brief Ports found by the latest scan, empty before the first
+        std::vector<MidiOut::Info> devices() const;
+
+        /// @brief Whether the first scan has finished
+        bool ready() const;
+
+        /// @brief Wait up to @p timeout for the first scan
+        /// @returns @b ready
+        bool wait_ready(std::chrono::milliseconds timeout) const;
+
+        /// @brief Take the queued events, oldest first
+        /// Only used when there is no callback
+        std::vector<Event> poll();
+
+        /// @brief Scan now rather than at the next interval
+        void rescan();
+
+        /// @brief Number of scans done, eg. to wait for one after @b rescan
+        size_t scans() const;
+
+    private:
+        std::shared_ptr<MidiBackend> _backend;
+        Callback _callback;
+        std::chrono::milliseconds _interval;
+
+        mutable std::mutex _mtx;
+        mutable std::condition_variable _cv;
+        std::vector<MidiOut::Info> _devices;
+        std::vector<Event> _events;
+        size_t _scans = 0;
+        bool _wake = false;
+        bool _stop = false;
+        std::thread _thread;
+
+        void run();
+        void scan();
+};
+
+#endif // MIDI_WATCHER_HPP_
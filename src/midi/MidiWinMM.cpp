@@ -0,0 +1,218 @@
+/**
+ * @file MidiWinMM.cpp
+ * @brief @b MidiBackend for the Windows MultiMedia API
+ * @note Only built on @b Windows
+ */
+extern "C" {
+    #include <Windows.h>
+    #include <mmeapi.h>
+}
+
+#include <algorithm>
+#include <cstdio>
+
+#include "MidiBackend.hpp"
+#include "MidiError.hpp"
+
+/** === Error Handling === */
+/// @brief How a WinMM error code is reported
+struct WinMMError {
+    MidiErrorKind kind;
+    const char* text;
+};
+
+static WinMMError winmm_error(MMRESULT err) noexcept {
+    switch (err) {
+        // Device/Driver errors
+        case MMSYSERR_BADDEVICEID:
+            return {MidiErrorKind::NotFound, "Device ID out of range"};
+        
+        case MMSYSERR_NODRIVER:
+            return {MidiErrorKind::SysError, "No device driver present"};
+        
+        case MMSYSERR_ALLOCATED:
+            return {MidiErrorKind::Allocated, "Device already in use"};
+        
+        case MMSYSERR_INVALHANDLE:
+            return {MidiErrorKind::RuntimeError, "Invalid device handle"};
+        
+        // Parameter/Input errors
+        case MMSYSERR_INVALPARAM:
+            return {MidiErrorKind::RuntimeError, "Invalid parameter"};
+        
+        case MMSYSERR_INVALFLAG:
+            return {MidiErrorKind::RuntimeError, "Invalid flag"};
+        
+        // System resource errors
+        case MMSYSERR_NOMEM:
+            return {MidiErrorKind::SysError, "Unable to allocate memory"};
+        
+        case MMSYSERR_HANDLEBUSY:
+            return {MidiErrorKind::Allocated, "Handle in use on another thread"};
+        
+        // MIDI-specific errors
+        case MIDIERR_STILLPLAYING:
+            return {MidiErrorKind::RuntimeError, "Cannot close - still playing"};
+        
+        case MIDIERR_NOTREADY:
+            return {MidiErrorKind::RuntimeError, "Hardware busy with previous message"};
+        
+        case MIDIERR_NODEVICE:
+            return {MidiErrorKind::Disconnected, "Device disconnected"};
+        
+        case MIDIERR_NOMAP:
+            return {MidiErrorKind::SysError, "No MIDI port mapper available"};
+        
+        case MIDIERR_INVALIDSETUP:
+            return {MidiErrorKind::SysError, "Invalid MIDI setup"};
+        
+        // Generic/Unknown
+        case MMSYSERR_ERROR:
+            return {MidiErrorKind::SysError, "Unspecified MIDI error (try CoInitializeEx on Win10+)"};
+        
+        default:
+            return {MidiErrorKind::SysError, nullptr};
+    }
+}
+
+static MidiStatus midi_out_status(MMRESULT err) noexcept {
+    if ( err == MMSYSERR_NOERROR )
+        return MidiStatus();
+    return winmm_error(err).kind;
+}
+
+static void midi_out_error(MMRESULT err, const std::string& method = "") {
+    if ( err == MMSYSERR_NOERROR )
+        return;
+
+    std::string msg = method.empty() ? "" : method + ": ";
+    WinMMError e = winmm_error(err);
+    if ( e.text )
+        throw_midi_error(e.kind, msg + e.text);
+    throw_midi_error(e.kind, msg + "Unknown MIDI error code: " + std::to_string(err));
+}
+
+/** === Connection === */
+/**
+ * @class WinMMConnection
+ * @brief Wraps a @b HMIDIOUT handle
+ */
+class WinMMConnection : public MidiBackend::Connection {
+    HMIDIOUT _out = NULL;
+
+    public:
+        WinMMConnection(UINT port) {
+            midi_out_error(midiOutOpen(&_out, port, 0, 0, CALLBACK_NULL), "midiOutOpen");
+        }
+
+        ~WinMMConnection() override {
+            // Errors can not be reported from a destructor
+            midiOutReset(_out);
+            midiOutClose(_out);
+        }
+
+        /// @note Each message goes out with its own @b midiOutShortMsg, batches
+        ///       included: @b midiOutLongMsg is meant for SysEx, and returns
+        ///       only once the driver has sent the whole buffer
+        void send(const uint8_t* bytes, size_t size) override {
+            const char* method = nullptr;
+            MMRESULT err = transmit(bytes, size, method);
+            if ( err != MMSYSERR_NOERROR )
+                midi_out_error(err, method);
+        }
+
+        MidiStatus try_send(const uint8_t* bytes, size_t size) noexcept override {
+            const char* method = nullptr;
+            return midi_out_status(transmit(bytes, size, method));
+        }
+
+    private:
+        /// @returns the WinMM error, with @p method the call that failed
+        MMRESULT transmit(const uint8_t* bytes, size_t size, const char*& method) noexcept {
+            method = "midiOutShortMsg";
+            // Never running status, so every message starts with its status byte
+            for ( size_t i = 0; i < size; ) {
+                size_t n = std::min(message_length(bytes[i]), size - i);
+                MMRESULT err = send_short(bytes + i, n);
+                if ( err != MMSYSERR_NOERROR )
+                    return err;
+                i += n;
+            }
+            return MMSYSERR_NOERROR;
+        }
+
+        MMRESULT send_short(const uint8_t* bytes, size_t size) noexcept {
+            union {
+                DWORD w;
+                BYTE  b[4];
+            } msg;
+            msg.w = 0;
+            for ( size_t i = 0; i < size && i < 3; i++ )
+                msg.b[i] = bytes[i];
+            return midiOutShortMsg(_out, msg.w);
+        }
+
+        /// @brief Length of a channel-voice message, including status
+        static size_t message_length(uint8_t status) {
+            switch ( status & 0xF0 ) {
+                case 0xC0:
+                case 0xD0:
+                    return 2;
+                default:
+                    return 3;
+            }
+        }
+};
+
+/** === Backend === */
+class WinMMBackend : public MidiBackend {
+    public:
+        std::string backend_name() const override {
+            return "winmm";
+        }
+
+        size_t count() override {
+            return midiOutGetNumDevs();
+        }
+
+        std::string name(size_t port) override {
+            char buffer[4096];
+            MIDIOUTCAPS moc = dev_caps(port, "midi_out_name");
+            if ( snprintf(buffer, sizeof(buffer), "%s", moc.szPname) >= sizeof(buffer) )
+                throw MidiRuntimeError("midi_out_name: buffer overflow");
+            return std::string(buffer);
+        }
+
+        bool external(size_t port) override {
+            return dev_caps(port, "midi_out_external").wTechnology == MOD_MIDIPORT;
+        }
+
+        size_t notes(size_t port) override {
+            return dev_caps(port, "midi_out_notes").wNotes;
+        }
+
+        uint16_t channel_mask(size_t port) override {
+            return dev_caps(port, "midi_out_channel_mask").wChannelMask;
+        }
+
+        /// @note One `midiOutGetDevCaps` for all 4 fields
+        Caps caps(size_t port) override {
+            MIDIOUTCAPS moc = dev_caps(port, "midi_out_caps");
+            return {moc.szPname, moc.wTechnology == MOD_MIDIPORT, moc.wNotes, moc.wChannelMask};
+        }
+
+        std::unique_ptr<Connection> open(size_t port) override {
+            return std::make_unique<WinMMConnection>(UINT(port));
+        }
+
+    private:
+        static MIDIOUTCAPS dev_caps(size_t port, const std::string& method) {
+            MIDIOUTCAPS moc;
+            midi_out_error(midiOutGetDevCaps(UINT(port), &moc, sizeof(moc)), method);
+            return moc;
+        }
+};
+
+std::shared_ptr<MidiBackend> midi_winmm_backend() {
+    return std::make_shared<WinMMBackend>();
+}
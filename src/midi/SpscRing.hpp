@@ -0,0 +1,101 @@
+/**
+ * @file SpscRing.hpp
+ * @brief Provides `SpscRing`, a bounded lock-free queue from one thread to another
+ */
+#ifndef SPSC_RING_HPP_
+#define SPSC_RING_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+/**
+ * @class SpscRing
+ * @brief Fixed capacity queue for exactly one producer and one consumer
+ * thread, such as a driver callback and the application
+ *
+ * All storage is allocated up front, and neither side ever locks,
+ * allocates or waits for the other. Each side keeps a cached copy of
+ * the other's position, so in steady state it only reads the other's
+ * cache line when the ring looks full or empty.
+ *
+ * @code
+ * SpscRing<MidiIn::Event> ring(1024);
+ * // Producer
+ * if ( !ring.push(event) )
+ *     dropped++;
+ * // Consumer
+ * MidiIn::Event batch[64];
+ * size_t n = ring.pop(batch, 64);
+ * @endcode
+ */
+template <class T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRing is for trivially copyable items");
+
+    public:
+        /// @param capacity rounded up to a power of two
+        explicit SpscRing(size_t capacity) {
+            size_t n = 1;
+            while ( n < capacity )
+                n <<= 1;
+            _slots = std::make_unique<T[]>(n);
+            _mask = n - 1;
+        }
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        /// @brief Add @p item, only from the producer thread
+        /// @return `false` if full, leaving the ring untouched
+        bool push(const T& item) noexcept {
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            if ( tail - _head_cache > _mask ) {
+                _head_cache = _head.load(std::memory_order_acquire);
+                if ( tail - _head_cache > _mask )
+                    return false;
+            }
+            _slots[tail & _mask] = item;
+            _tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// @brief Take up to @p max of the oldest items, only from the consumer thread
+        /// @return number of items written to @p out
+        size_t pop(T* out, size_t max) noexcept {
+            size_t head = _head.load(std::memory_order_relaxed);
+            if ( _tail_cache - head < max )
+                _tail_cache = _tail.load(std::memory_order_acquire);
+            size_t n = _tail_cache - head;
+            if ( n > max )
+                n = max;
+            for ( size_t i = 0; i < n; i++ )
+                out[i] = _slots[(head + i) & _mask];
+            _head.store(head + n, std::memory_order_release);
+            return n;
+        }
+
+        /// @brief Number of items waiting, from either thread
+        /// Only a snapshot, as the other side keeps going
+        size_t size() const noexcept {
+            size_t head = _head.load(std::memory_order_acquire);
+            return _tail.load(std::memory_order_acquire) - head;
+        }
+
+        size_t capacity() const noexcept {
+            return _mask + 1;
+        }
+
+    private:
+        std::unique_ptr<T[]> _slots;
+        size_t _mask;
+        // Written by the consumer
+        alignas(64) std::atomic<size_t> _head{0};
+        size_t _tail_cache = 0;
+        // Written by the producer
+        alignas(64) std::atomic<size_t> _tail{0};
+        size_t _head_cache = 0;
+};
+
+#endif // SPSC_RING_HPP_
@@ -5,5 +5,14 @@
 
 #include "MidiError.hpp"
 #include "MidiOut.hpp"
+#include "MidiIn.hpp"
+#include "MidiStats.hpp"
+#include "MidiBackend.hpp"
+#include "MidiMemorySink.hpp"
+#include "MidiWatcher.hpp"
+#include "MidiMsg.hpp"
+#include "MidiPipeline.hpp"
+#include "MidiScheduler.hpp"
+#include "MidiFile.hpp"
 
 #endif // MIDI_H_
\ No newline at end of file
@@ -0,0 +1,273 @@
+#ifndef BULK_NOTES_HPP_
+#define BULK_NOTES_HPP_
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#include "Note.hpp"
+#include "PcSet.hpp"
+#include "Span.hpp"
+#include "Simd.hpp"
+
+/**
+ * Operations over whole buffers of notes, eg. every note of a MIDI file
+ * or of a transcription, working on 16 notes at a time with SSE2, or 32
+ * with AVX2 when built with it (the `SUPERFRET_AVX2` CMake option).
+ *
+ * MIDI note numbers are read the same as `Note` reads them, modulo 128,
+ * so every function gives the same result for a `uint8_t` buffer as for
+ * the `Note`s made from it, and transposing wraps the same as `Note + n`.
+ *
+ * Each function takes the instruction set as a template argument, which
+ * defaults to the best one built for. `BulkNotes::Scalar` does one note
+ * at a time, as the reference to compare against.
+ *
+ * eg.
+ * std::vector<Note> notes = ...;
+ * BulkNotes::transpose(notes, -12);
+ * BulkNotes::clamp(notes, "E2"_note, "E6"_note);
+ * BulkNotes::histogram(notes) := {120, 0, 64, 0, 98, ...}
+ * BulkNotes::pcset(notes).interval_vector() := {2, 5, 4, 3, 6, 1}
+ */
+class BulkNotes {
+    public:
+        struct Scalar {
+            static constexpr size_t width = 1;
+            static constexpr const char* name = "scalar";
+        };
+
+#ifdef SUPERFRET_SSE2
+        struct Sse2 {
+            using V = __m128i;
+            static constexpr size_t width = 16;
+            static constexpr const char* name = "sse2";
+
+            static V load(const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+            static void store(uint8_t* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+            static V set1(uint8_t x) { return _mm_set1_epi8(char(x)); }
+            static V add(V a, V b) { return _mm_add_epi8(a, b); }
+            static V sub(V a, V b) { return _mm_sub_epi8(a, b); }
+            static V mask(V a, V b) { return _mm_and_si128(a, b); }
+            static V min(V a, V b) { return _mm_min_epu8(a, b); }
+            static V max(V a, V b) { return _mm_max_epu8(a, b); }
+            static V eq(V a, V b) { return _mm_cmpeq_epi8(a, b); }
+
+            static uint32_t sum(V a) {
+                // Two sums of 8 bytes, in the low bits of each half
+                V s = _mm_sad_epu8(a, _mm_setzero_si128());
+                return uint32_t(_mm_cvtsi128_si32(s)) + uint32_t(_mm_cvtsi128_si32(_mm_srli_si128(s, 8)));
+            }
+        };
+#endif
+
+#ifdef SUPERFRET_AVX2
+        struct Avx2 {
+            using V = __m256i;
+            static constexpr size_t width = 32;
+            static constexpr const char* name = "avx2";
+
+            static V load(const uint8_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+            static void store(uint8_t* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+            static V set1(uint8_t x) { return _mm256_set1_epi8(char(x)); }
+            static V add(V a, V b) { return _mm256_add_epi8(a, b); }
+            static V sub(V a, V b) { return _mm256_sub_epi8(a, b); }
+            static V mask(V a, V b) { return _mm256_and_si256(a, b); }
+            static V min(V a, V b) { return _mm256_min_epu8(a, b); }
+            static V max(V a, V b) { return _mm256_max_epu8(a, b); }
+            static V eq(V a, V b) { return _mm256_cmpeq_epi8(a, b); }
+
+            static uint32_t sum(V a) {
+                V s4 = _mm256_sad_epu8(a, _mm256_setzero_si256());
+                __m128i s = _mm_add_epi64(_mm256_castsi256_si128(s4), _mm256_extracti128_si256(s4, 1));
+                return uint32_t(_mm_cvtsi128_si32(s)) + uint32_t(_mm_cvtsi128_si32(_mm_srli_si128(s, 8)));
+            }
+        };
+#endif
+
+        // The widest instruction set built for
+#if defined(SUPERFRET_AVX2)
+        using Native = Avx2;
+#elif defined(SUPERFRET_SSE2)
+        using Native = Sse2;
+#else
+        using Native = Scalar;
+#endif
+
+        /**
+         * Transpose every note in place, wrapping around the 128 MIDI notes
+         * eg. {60, 125} transposed by 5 := {65, 2}
+         */
+        template <class L = Native>
+        static void transpose(Span<uint8_t> notes, int interval) {
+            // Modulo 128 for negative intervals too
+            uint8_t k = uint8_t(interval) & 0x7F;
+            uint8_t* p = notes.data();
+            size_t i = 0;
+            if constexpr ( L::width > 1 ) {
+                auto vk = L::set1(k);
+                auto m = L::set1(0x7F);
+                for ( ; i + L::width <= notes.size(); i += L::width )
+                    L::store(p + i, L::mask(L::add(L::load(p + i), vk), m));
+            }
+            for ( ; i < notes.size(); i++ )
+                p[i] = uint8_t(p[i] + k) & 0x7F;
+        }
+
+        template <class L = Native>
+        static void transpose(Span<Note> notes, int interval) {
+            transpose<L>(bytes(notes), interval);
+        }
+
+        /**
+         * Move every note into [low, high] in place, eg. to fit the range
+         * of an instrument. Expects low <= high
+         */
+        template <class L = Native>
+        static void clamp(Span<uint8_t> notes, uint8_t low, uint8_t high) {
+            uint8_t* p = notes.data();
+            size_t i = 0;
+            if constexpr ( L::width > 1 ) {
+                auto lo = L::set1(low);
+                auto hi = L::set1(high);
+                auto m = L::set1(0x7F);
+                for ( ; i + L::width <= notes.size(); i += L::width )
+                    L::store(p + i, L::min(L::max(L::mask(L::load(p + i), m), lo), hi));
+            }
+            for ( ; i < notes.size(); i++ ) {
+                uint8_t n = p[i] & 0x7F;
+                p[i] = n < low ? low : n > high ? high : n;
+            }
+        }
+
+        template <class L = Native>
+        static void clamp(Span<Note> notes, Note low, Note high) {
+            clamp<L>(bytes(notes), low.note(), high.note());
+        }
+
+        /**
+         * Write the pitch class, 0 for "C" through 11 for "B", of each note
+         * to out, which has room for as many. out may be the notes
+         */
+        template <class L = Native>
+        static void pitch_classes(Span<const uint8_t> notes, uint8_t* out) {
+            const uint8_t* p = notes.data();
+            size_t i = 0;
+            if constexpr ( L::width > 1 ) {
+                auto m = L::set1(0x7F);
+                for ( ; i + L::width <= notes.size(); i += L::width )
+                    L::store(out + i, pitch_class<L>(L::mask(L::load(p + i), m)));
+            }
+            for ( ; i < notes.size(); i++ )
+                out[i] = (p[i] & 0x7F) % 12;
+        }
+
+        template <class L = Native>
+        static void pitch_classes(Span<const Note> notes, uint8_t* out) {
+            pitch_classes<L>(bytes(notes), out);
+        }
+
+        /**
+         * Count the notes of each pitch class, eg. to guess the key
+         */
+        template <class L = Native>
+        static std::array<uint32_t, 12> histogram(Span<const uint8_t> notes) {
+            std::array<uint32_t, 12> counts{};
+            const uint8_t* p = notes.data();
+            size_t i = 0;
+            if constexpr ( L::width > 1 ) {
+                auto m = L::set1(0x7F);
+                while ( i + L::width <= notes.size() ) {
+                    // Byte counters, emptied before any can pass 255
+                    typename L::V acc[12];
+                    for ( auto& a: acc )
+                        a = L::set1(0);
+                    for ( size_t run = 0; run < 255 && i + L::width <= notes.size(); run++, i += L::width ) {
+                        auto pc = pitch_class<L>(L::mask(L::load(p + i), m));
+                        // A match is 0xFF, so subtracting it counts one
+                        for ( uint8_t c = 0; c < 12; c++ )
+                            acc[c] = L::sub(acc[c], L::eq(pc, L::set1(c)));
+                    }
+                    for ( uint8_t c = 0; c < 12; c++ )
+                        counts[c] += L::sum(acc[c]);
+                }
+            }
+            for ( ; i < notes.size(); i++ )
+                counts[(p[i] & 0x7F) % 12]++;
+            return counts;
+        }
+
+        template <class L = Native>
+        static std::array<uint32_t, 12> histogram(Span<const Note> notes) {
+            return histogram<L>(bytes(notes));
+        }
+
+        /**
+         * Pitch classes present in the notes
+         */
+        template <class L = Native>
+        static PcSet pcset(Span<const uint8_t> notes) {
+            std::array<uint32_t, 12> counts = histogram<L>(notes);
+            PcSet set;
+            for ( uint8_t c = 0; c < 12; c++ )
+                if ( counts[c] )
+                    set = set.with(c);
+            return set;
+        }
+
+        template <class L = Native>
+        static PcSet pcset(Span<const Note> notes) {
+            return pcset<L>(bytes(notes));
+        }
+
+        /**
+         * Write the interval from each note to the next, in semitones, to
+         * out, which has room for one less than the notes
+         * eg. {60, 64, 62, 67} := {4, -2, 5}
+         */
+        template <class L = Native>
+        static void intervals(Span<const uint8_t> notes, int8_t* out) {
+            const uint8_t* p = notes.data();
+            uint8_t* o = reinterpret_cast<uint8_t*>(out);
+            size_t i = 0;
+            if constexpr ( L::width > 1 ) {
+                auto m = L::set1(0x7F);
+                // Differences of notes below 128 fit the int8_t wrapped into
+                for ( ; i + 1 + L::width <= notes.size(); i += L::width )
+                    L::store(o + i, L::sub(L::mask(L::load(p + i + 1), m), L::mask(L::load(p + i), m)));
+            }
+            for ( ; i + 1 < notes.size(); i++ )
+                out[i] = int8_t((p[i + 1] & 0x7F) - (p[i] & 0x7F));
+        }
+
+        template <class L = Native>
+        static void intervals(Span<const Note> notes, int8_t* out) {
+            intervals<L>(bytes(notes), out);
+        }
+
+    private:
+        static_assert(sizeof(Note) == 1 && std::is_trivially_copyable<Note>::value,
+                      "BulkNotes reads Notes as their MIDI note numbers");
+
+        static Span<uint8_t> bytes(Span<Note> notes) {
+            return Span<uint8_t>(reinterpret_cast<uint8_t*>(notes.data()), notes.size());
+        }
+
+        static Span<const uint8_t> bytes(Span<const Note> notes) {
+            return Span<const uint8_t>(reinterpret_cast<const uint8_t*>(notes.data()), notes.size());
+        }
+
+        /**
+         * n % 12 for n < 128, without division: subtracting 96, 48, 24
+         * and 12 wraps below zero to above n, so the unsigned minimum
+         * only keeps the subtractions that fit
+         */
+        template <class L>
+        static typename L::V pitch_class(typename L::V n) {
+            for ( uint8_t d: {96, 48, 24, 12} )
+                n = L::min(n, L::sub(n, L::set1(d)));
+            return n;
+        }
+};
+
+#endif // BULK_NOTES_HPP_
@@ -1,81 +1,297 @@
 #ifndef CHORD_HPP_
 #define CHORD_HPP_
 
+#include <array>
 #include <vector>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+#include <cstddef>
 #include <cstdint>
 
 #include "Tone.hpp"
 #include "Note.hpp"
+#include "PcSet.hpp"
+#include "PcCatalog.hpp"
+#include "Span.hpp"
 
 class Chord {
     public:
         class Iterator;
 
+        /// Most notes a chord can hold, one for every string of a large guitar
+        static constexpr size_t capacity = 15;
+
     protected:
         friend Iterator;
-        std::vector<Note> _notes;
+        std::array<Note, capacity> _notes;
+        uint8_t _size = 0;
+
+        constexpr void push_back(Note note) {
+            if ( _size == capacity )
+                throw std::length_error("Chord: Too many notes");
+            _notes[_size++] = note;
+        }
 
     public:
-        Chord() { }
-        Chord(std::vector<Note> notes): _notes(std::move(notes)) { }
-        Chord(Note root, const std::vector<uint8_t>& degrees) { 
-            _notes.push_back(root);
+        constexpr Chord(): _notes{} { }
+        Chord(const std::vector<Note>& notes): Chord(Span<const Note>(notes)) { }
+
+        /**
+         * Throws std::length_error for more than `capacity` notes
+         */
+        constexpr explicit Chord(Span<const Note> notes): _notes{} {
+            for ( auto n: notes )
+                push_back(n);
+        }
+
+        constexpr Chord(Note root, std::initializer_list<uint8_t> degrees): _notes{} {
+            push_back(root);
             for ( auto d: degrees )
-                _notes.push_back(root + d);
+                push_back(root + d);
+        }
+
+        Chord(Note root, const std::vector<uint8_t>& degrees): _notes{} {
+            push_back(root);
+            for ( auto d: degrees )
+                push_back(root + d);
+        }
+
+        /**
+         * Close voicing of the set above the root, within one octave
+         * The root is always included
+         */
+        constexpr Chord(Note root, PcSet set): _notes{} {
+            set = set.transpose(12 - root.tone().tone()).without(0);
+            push_back(root);
+            for ( auto t: set )
+                push_back(root + t.tone());
+        }
+
+        std::vector<Note> notes() const {
+            return std::vector<Note>(_notes.begin(), _notes.begin() + _size);
         }
 
-        const std::vector<Note>& notes() const {
-            return _notes;
+        constexpr size_t size() const {
+            return _size;
         }
 
-        static Chord major_triad(Note root) {
+        constexpr const Note* data() const {
+            return _notes.data();
+        }
+
+        constexpr Note operator[](size_t i) const {
+            return _notes[i];
+        }
+
+        /**
+         * Tones of the chord, independent of octave and voicing
+         */
+        constexpr PcSet pcset() const {
+            PcSet set;
+            for ( size_t i = 0; i < _size; i++ )
+                set = set.with(_notes[i].note());
+            return set;
+        }
+
+        constexpr bool contains(const Tone& tone) const {
+            return pcset().contains(tone.tone());
+        }
+
+        static constexpr Chord major_triad(Note root) {
             return Chord(root, {4, 7});
         }
 
-        static Chord minor_triad(Note root) {
+        static constexpr Chord minor_triad(Note root) {
             return Chord(root, {3, 7});
         }
 
-        static Chord diminished_triad(Note root) {
+        static constexpr Chord diminished_triad(Note root) {
             return Chord(root, {3, 6});
         }
 
-        static Chord augmented_triad(Note root) {
+        static constexpr Chord augmented_triad(Note root) {
             return Chord(root, {4, 8});
         }
 
+        /**
+         * One way of hearing a collection of notes as a chord
+         * eg. {B2, F3, G3, D4} := G7/B, in first inversion
+         */
+        struct Match {
+            Tone root;
+            /// Lowest note's tone, a slash bass if it is not the root
+            Tone bass;
+            /// Index into `PcCatalog::qualities`
+            uint8_t quality;
+            /// Tones above the root that are not part of the quality
+            PcSet extensions;
+            /// 0 for root position, 1 with the 3rd in the bass, and so on,
+            /// or `PcCatalog::none` if the bass is an extension
+            uint8_t inversion;
+            /// Higher is a more likely reading
+            int16_t score;
+
+            constexpr const PcCatalog::Quality& info() const {
+                return PcCatalog::qualities[quality];
+            }
+
+            constexpr bool slash() const {
+                return bass != root;
+            }
+
+            /**
+             * eg. "Cmaj7(9,#11)" or "G7/B"
+             */
+            std::string name() const {
+                static constexpr std::array<const char*, 12> degrees = {"", "b9", "9", "#9", "3", "11",
+                                                                        "#11", "5", "b13", "13", "7", "maj7"};
+                std::string n = root.name() + info().symbol;
+                const char* sep = "(";
+                for ( auto t: extensions ) {
+                    n += sep;
+                    n += degrees[t.tone()];
+                    sep = ",";
+                }
+                if ( !extensions.empty() )
+                    n += ")";
+                if ( slash() )
+                    n += "/" + bass.name();
+                return n;
+            }
+        };
+
+        /**
+         * Interpretations found by `identify`, best first
+         */
+        class Matches {
+            private:
+                std::array<Match, 12> _matches;
+                uint8_t _size = 0;
+
+            public:
+                constexpr Matches(): _matches{} { }
+
+                /// Insert, keeping matches sorted by descending score
+                constexpr void add(const Match& m) {
+                    size_t i = _size++;
+                    for ( ; i > 0 && _matches[i - 1].score < m.score; i-- )
+                        _matches[i] = _matches[i - 1];
+                    _matches[i] = m;
+                }
+
+                constexpr size_t size() const {
+                    return _size;
+                }
+
+                constexpr bool empty() const {
+                    return _size == 0;
+                }
+
+                constexpr const Match& operator[](size_t i) const {
+                    return _matches[i];
+                }
+
+                constexpr const Match* begin() const {
+                    return _matches.data();
+                }
+
+                constexpr const Match* end() const {
+                    return _matches.data() + _size;
+                }
+        };
+
+        /**
+         * Ranked readings of the notes as a chord, in any voicing or
+         * inversion. Each tone is tried as the root, taking the largest
+         * chord quality above it from `PcCatalog`, so this is at most
+         * 12 table lookups and does not allocate.
+         *
+         * Readings covering more tones with the quality, with fewer
+         * extensions, and with the root in the bass rank first.
+         */
+        static constexpr Matches identify(Span<const Note> notes) {
+            Matches found;
+            if ( notes.empty() )
+                return found;
+            PcSet set;
+            Note lowest = notes[0];
+            for ( auto n: notes ) {
+                set = set.with(n.note());
+                lowest = n < lowest ? n : lowest;
+            }
+            Tone bass = lowest.tone();
+            for ( auto root: set ) {
+                PcSet above = set.transpose(12 - root.tone());
+                uint8_t q = PcCatalog::lookup(above).quality;
+                if ( q == PcCatalog::none )
+                    continue;
+                PcSet quality(PcCatalog::qualities[q].intervals);
+                Match m{root, bass, q, above - quality, PcCatalog::none, 0};
+                uint8_t b = bass - root;
+                if ( quality.contains(b) )
+                    m.inversion = (quality & PcSet(uint16_t((1u << b) - 1))).size();
+                m.score = int16_t(8 * quality.size() - 6 * m.extensions.size() + (m.slash() ? 0 : 4)
+                                  + (m.inversion == PcCatalog::none ? -2 : 0) - q / 8);
+                found.add(m);
+            }
+            return found;
+        }
+
+        /**
+         * Walks the notes of a const or temporary chord, by value
+         */
         class Iterator {
-            Chord* _chord;
+            const Chord* _chord;
             size_t _pos;
 
             public:
-                Iterator(Chord* chord, size_t pos): _chord(chord), _pos(pos) { }
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = Note;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                using reference = Note;
 
-                Iterator& operator++() {
+                constexpr Iterator(): _chord(nullptr), _pos(0) { }
+                constexpr Iterator(const Chord* chord, size_t pos): _chord(chord), _pos(pos) { }
+
+                constexpr Iterator& operator++() {
                     _pos ++;
                     return *this;
                 }
-                
-                bool operator==(const Iterator& other) const {
+
+                constexpr Iterator operator++(int) {
+                    Iterator was = *this;
+                    _pos ++;
+                    return was;
+                }
+
+                constexpr bool operator==(const Iterator& other) const {
                     return _pos == other._pos;
                 }
 
-                bool operator!=(const Iterator& other) const {
+                constexpr bool operator!=(const Iterator& other) const {
                     return _pos != other._pos;
                 }
 
-                Note operator*() const {
+                constexpr Note operator*() const {
                     return _chord->_notes[_pos];
                 }
         };
 
-        Iterator begin() {
+        constexpr Iterator begin() const {
             return Iterator(this, 0);
         }
 
-        Iterator end() {
-            return Iterator(this, _notes.size());
+        constexpr Iterator end() const {
+            return Iterator(this, _size);
         }
 };
 
+// Chords are copied by value in their millions when searching voicings
+// and progressions, so they stay small and free of the heap
+static_assert(std::is_trivially_copyable<Chord>::value, "Chord must be trivially copyable");
+static_assert(sizeof(Chord) <= 16, "Chord must fit in 16 bytes");
+
 #endif // CHORD_HPP_
\ No newline at end of file
@@ -0,0 +1,226 @@
+#ifndef FINGERING_HPP_
+#define FINGERING_HPP_
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+
+#include "Note.hpp"
+#include "Fretboard.hpp"
+#include "Span.hpp"
+#include "Simd.hpp"
+
+/**
+ * Chooses where to play each note of a run on a fretboard, eg. a scale
+ * exercise or a melody, for the least movement of the fretting hand.
+ *
+ * The hand sits at a position, the fret under the index finger, and
+ * plays a fret per finger from there, or one more with a stretch of the
+ * little finger. Each note can then be played from a few positions on
+ * each of several strings, and open strings from any low position.
+ *
+ * The cheapest path through those choices is found exactly by a Viterbi
+ * pass: for each note, the cheapest way to reach each of its choices is
+ * the minimum over the previous note's choices of the cost so far plus
+ * the cost of the move (a min-plus product). Costs are kept in rows of
+ * 16 bit lanes, so each step works on 8 choices at a time.
+ *
+ * eg.
+ * auto run = Scale::major("G").range("G2"_note, "G4"_note);
+ * Fingering::Path p = Fingering::find(Fretboard::guitar(), run);
+ * p.positions := {0, 3}, {1, 0}, {1, 2}, {1, 3}, {2, 0}, ...
+ */
+class Fingering {
+    public:
+        /// Frets the hand covers at a position, one per finger
+        static constexpr uint8_t reach = 4;
+
+        /// Weights of each part of the cost of moving between notes
+        struct Costs {
+            /// Per fret the hand's position moves
+            uint16_t shift = 3;
+            /// Per note played by stretching past the hand's reach
+            uint16_t stretch = 2;
+            /// Per string skipped between notes
+            uint16_t skip = 2;
+            /// Per fret above the `high` fret, to prefer lower positions
+            uint16_t height = 1;
+            uint8_t high = 12;
+        };
+
+        /// Where a note is played and from which hand position
+        struct Choice {
+            Fretboard::Position position;
+            /// Fret under the index finger, from 1
+            uint8_t hand;
+        };
+
+        struct Path {
+            std::vector<Fretboard::Position> positions;
+            /// Hand position of each note
+            std::vector<uint8_t> hands;
+            uint32_t cost = 0;
+
+            /// Finger playing the note, from 1 for the index, 0 for open strings
+            uint8_t finger(size_t i) const {
+                uint8_t fret = positions[i].fret;
+                return fret == 0 ? 0 : uint8_t(std::min(fret - hands[i] + 1, int(reach)));
+            }
+        };
+
+        /// Cost of playing b right after a
+        static uint16_t cost(const Choice& a, const Choice& b, const Costs& c) {
+            uint32_t total = c.shift * uint32_t(std::abs(a.hand - b.hand));
+            int skipped = std::abs(a.position.string - b.position.string) - 1;
+            if ( skipped > 0 )
+                total += c.skip * uint32_t(skipped);
+            if ( b.position.fret >= b.hand + reach )
+                total += c.stretch;
+            if ( b.position.fret > c.high )
+                total += c.height * uint32_t(b.position.fret - c.high);
+            return uint16_t(std::min<uint32_t>(total, limit));
+        }
+
+        /**
+         * Cheapest positions for the notes, in order
+         * Throws std::invalid_argument if a note is not on the fretboard
+         */
+        static Path find(const Fretboard& board, Span<const Note> notes, const Costs& costs) {
+            Path path;
+            if ( notes.empty() )
+                return path;
+
+            // Choices and back-pointers, a row per note
+            std::vector<Choices> at(notes.size());
+            std::vector<Row> back(notes.size());
+            for ( size_t k = 0; k < notes.size(); k++ )
+                at[k] = choices(board, notes[k]);
+            Row total;
+            total.fill(inf);
+            for ( size_t j = 0; j < at[0].count; j++ )
+                total[j] = int16_t(cost(at[0].at[j], at[0].at[j], costs));
+            uint32_t base = 0;
+
+            Moves moves;
+            for ( size_t k = 1; k < notes.size(); k++ ) {
+                const Choices& prev = at[k - 1];
+                const Choices& cur = at[k];
+                size_t width = (cur.count + 7) & ~size_t(7);
+                for ( size_t i = 0; i < prev.count; i++ ) {
+                    for ( size_t j = 0; j < cur.count; j++ )
+                        moves[i][j] = int16_t(cost(prev.at[i], cur.at[j], costs));
+                    for ( size_t j = cur.count; j < width; j++ )
+                        moves[i][j] = inf;
+                }
+                Row best;
+                best.fill(inf);
+                min_plus(total, moves, prev.count, width, best, back[k]);
+                // Keep costs small by taking out the cheapest so far
+                int16_t low = inf;
+                for ( size_t j = 0; j < cur.count; j++ )
+                    low = std::min(low, best[j]);
+                for ( size_t j = 0; j < lanes; j++ )
+                    total[j] = j < cur.count ? int16_t(best[j] - low) : inf;
+                base += uint32_t(low);
+            }
+
+            // Walk back from the cheapest last choice
+            size_t j = 0;
+            for ( size_t i = 1; i < at.back().count; i++ )
+                if ( total[i] < total[j] )
+                    j = i;
+            path.cost = base + uint32_t(total[j]);
+            path.positions.resize(notes.size());
+            path.hands.resize(notes.size());
+            for ( size_t k = notes.size(); k-- > 0; ) {
+                path.positions[k] = at[k].at[j].position;
+                path.hands[k] = at[k].at[j].hand;
+                j = size_t(back[k][j]);
+            }
+            return path;
+        }
+
+        static Path find(const Fretboard& board, Span<const Note> notes) {
+            return find(board, notes, Costs());
+        }
+
+    private:
+        /// Hand positions per string a note can be played from
+        static constexpr size_t per_string = reach + 1;
+        /// Choices per note, rounded up to whole vectors of 8
+        static constexpr size_t lanes = (Fretboard::max_strings * per_string + 7) & ~size_t(7);
+        /// Cost of impossible choices, low enough that adding two can't overflow
+        static constexpr int16_t inf = 0x3FFF;
+        /// Highest cost of a single move
+        static constexpr uint16_t limit = 0x1FFF;
+
+        struct alignas(16) Row : std::array<int16_t, lanes> { };
+        using Moves = std::array<Row, lanes>;
+
+        struct Choices {
+            std::array<Choice, lanes> at;
+            size_t count;
+        };
+
+        /**
+         * Every position and hand position playing the note
+         */
+        static Choices choices(const Fretboard& board, Note note) {
+            Choices c{};
+            for ( uint8_t string = 0; string < board.strings(); string++ ) {
+                uint32_t frets = board.frets(string, note);
+                if ( !frets )
+                    continue;
+                uint8_t f = 0;
+                while ( !(frets >> f & 1) )
+                    f++;
+                // Open strings ring from any of the lowest positions
+                int first = f == 0 ? 1 : std::max(1, f - int(reach));
+                int last = f == 0 ? int(per_string) : f;
+                for ( int hand = first; hand <= last; hand++ )
+                    c.at[c.count++] = {{string, f}, uint8_t(hand)};
+            }
+            if ( c.count == 0 )
+                throw std::invalid_argument("Fingering::find: Note " + note.name() + " is not on the fretboard");
+            return c;
+        }
+
+        /**
+         * best[j] = min over i < count of total[i] + moves[i][j], and arg[j]
+         * the first i reaching it, for j < width
+         */
+        static void min_plus(const Row& total, const Moves& moves, size_t count, size_t width, Row& best, Row& arg) {
+#ifdef SUPERFRET_SSE2
+            for ( size_t j = 0; j < width; j += 8 ) {
+                __m128i b = _mm_set1_epi16(inf);
+                __m128i a = _mm_setzero_si128();
+                for ( size_t i = 0; i < count; i++ ) {
+                    __m128i m = _mm_load_si128(reinterpret_cast<const __m128i*>(moves[i].data() + j));
+                    __m128i c = _mm_add_epi16(_mm_set1_epi16(total[i]), m);
+                    __m128i better = _mm_cmplt_epi16(c, b);
+                    b = _mm_min_epi16(c, b);
+                    a = _mm_or_si128(_mm_and_si128(better, _mm_set1_epi16(int16_t(i))), _mm_andnot_si128(better, a));
+                }
+                _mm_store_si128(reinterpret_cast<__m128i*>(best.data() + j), b);
+                _mm_store_si128(reinterpret_cast<__m128i*>(arg.data() + j), a);
+            }
+#else
+            for ( size_t j = 0; j < width; j++ ) {
+                best[j] = inf;
+                arg[j] = 0;
+            }
+            for ( size_t i = 0; i < count; i++ )
+                for ( size_t j = 0; j < width; j++ ) {
+                    int16_t c = int16_t(total[i] + moves[i][j]);
+                    bool better = c < best[j];
+                    best[j] = better ? c : best[j];
+                    arg[j] = better ? int16_t(i) : arg[j];
+                }
+#endif
+        }
+};
+
+#endif // FINGERING_HPP_
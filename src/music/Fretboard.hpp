@@ -0,0 +1,236 @@
+#ifndef FRETBOARD_HPP_
+#define FRETBOARD_HPP_
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <initializer_list>
+
+#include "Tone.hpp"
+#include "Note.hpp"
+#include "PcSet.hpp"
+#include "Scale.hpp"
+#include "Chord.hpp"
+#include "Span.hpp"
+
+/**
+ * The strings and frets of a fretted instrument, with any number of
+ * strings, any tuning and a capo.
+ *
+ * Strings are numbered from the lowest in the tuning, eg. string 0 is
+ * the low "E" of a guitar. Frets are counted from the capo, as in
+ * tablature for a capoed instrument, so fret 0 is the open string (or
+ * the capo) and there are `frets() - capo()` frets above it.
+ *
+ * The note and pitch-class bit of every position are kept in one row
+ * per string, so finding where a scale or chord lies is a masked scan
+ * along each row, and retuning a string only rewrites its own row.
+ *
+ * eg.
+ * Fretboard guitar = Fretboard::guitar();
+ * guitar.note(1, 3) := C3
+ * guitar.frets(0, Scale::major("C").pcset()) := bits of frets 0, 1, 3, 5, 7, 8, 10, 12, ...
+ */
+class Fretboard {
+    public:
+        static constexpr size_t max_strings = 12;
+        /// Positions per string, the open string and up to 31 frets
+        static constexpr size_t max_positions = 32;
+
+        struct Position {
+            uint8_t string;
+            uint8_t fret;
+
+            constexpr bool operator==(const Position& other) const {
+                return string == other.string && fret == other.fret;
+            }
+
+            constexpr bool operator!=(const Position& other) const {
+                return !(*this == other);
+            }
+        };
+
+        /**
+         * Throws std::invalid_argument if there are no strings, more than
+         * `max_strings`, or more frets than fit in a row
+         */
+        Fretboard(Span<const Note> tuning, uint8_t frets = 24, uint8_t capo = 0) {
+            if ( tuning.empty() || tuning.size() > max_strings )
+                throw std::invalid_argument("Fretboard: Unsupported number of strings");
+            if ( frets >= max_positions || capo > frets )
+                throw std::invalid_argument("Fretboard: Unsupported number of frets");
+            _strings = uint8_t(tuning.size());
+            _frets = frets;
+            _capo = capo;
+            for ( size_t s = 0; s < _strings; s++ ) {
+                _tuning[s] = tuning[s];
+                fill(s);
+            }
+        }
+
+        Fretboard(std::initializer_list<Note> tuning, uint8_t frets = 24, uint8_t capo = 0)
+            : Fretboard(Span<const Note>(tuning.begin(), tuning.size()), frets, capo) { }
+
+        /// E2 A2 D3 G3 B3 E4
+        static Fretboard guitar(uint8_t frets = 24, uint8_t capo = 0) {
+            return Fretboard({40, 45, 50, 55, 59, 64}, frets, capo);
+        }
+
+        /// E1 A1 D2 G2
+        static Fretboard bass(uint8_t frets = 20, uint8_t capo = 0) {
+            return Fretboard({28, 33, 38, 43}, frets, capo);
+        }
+
+        /// G4 C4 E4 A4, re-entrant
+        static Fretboard ukulele(uint8_t frets = 12, uint8_t capo = 0) {
+            return Fretboard({67, 60, 64, 69}, frets, capo);
+        }
+
+        size_t strings() const {
+            return _strings;
+        }
+
+        /// Frets of the instrument, from the nut
+        uint8_t frets() const {
+            return _frets;
+        }
+
+        /// Highest fret above the capo
+        uint8_t playable() const {
+            return _frets - _capo;
+        }
+
+        uint8_t capo() const {
+            return _capo;
+        }
+
+        /// Open note of the string, without the capo
+        Note tuning(size_t string) const {
+            return _tuning[string];
+        }
+
+        /**
+         * Sounding note at the fret above the capo
+         * Positions above MIDI's highest note give 0, see `valid`
+         */
+        Note note(size_t string, uint8_t fret) const {
+            return Note(_notes[string][fret]);
+        }
+
+        Note note(const Position& p) const {
+            return note(p.string, p.fret);
+        }
+
+        /// Whether the position is on the board and has a MIDI note
+        bool valid(const Position& p) const {
+            return p.string < _strings && p.fret <= playable() && _bits[p.string][p.fret] != 0;
+        }
+
+        /**
+         * Set the open note of one string, leaving the other strings' rows
+         */
+        void retune(size_t string, Note open) {
+            if ( string >= _strings )
+                throw std::out_of_range("Fretboard::retune: No such string");
+            _tuning[string] = open;
+            fill(string);
+        }
+
+        /**
+         * Move the capo, which changes the note at every position
+         */
+        void set_capo(uint8_t capo) {
+            if ( capo > _frets )
+                throw std::invalid_argument("Fretboard::set_capo: Capo past the last fret");
+            _capo = capo;
+            for ( size_t s = 0; s < _strings; s++ )
+                fill(s);
+        }
+
+        /**
+         * Frets of the string whose tone is in the set, as bit `f` for
+         * fret `f`
+         */
+        uint32_t frets(size_t string, PcSet set) const {
+            const std::array<uint16_t, max_positions>& row = _bits[string];
+            uint32_t found = 0;
+            for ( size_t f = 0; f < max_positions; f++ )
+                found |= uint32_t((row[f] & set.bits()) != 0) << f;
+            return found;
+        }
+
+        /**
+         * Frets of the string playing exactly the note
+         */
+        uint32_t frets(size_t string, Note note) const {
+            const std::array<uint8_t, max_positions>& row = _notes[string];
+            uint32_t found = 0;
+            for ( size_t f = 0; f < max_positions; f++ )
+                found |= uint32_t(row[f] == note.note() && _bits[string][f] != 0) << f;
+            return found;
+        }
+
+        /**
+         * Call `visit(Position)` for every position whose tone is in the
+         * set, string by string from the lowest, then fret by fret
+         */
+        template <class Visitor>
+        void each(PcSet set, Visitor&& visit) const {
+            for ( uint8_t s = 0; s < _strings; s++ )
+                for ( uint32_t found = frets(s, set); found; found &= found - 1 )
+                    visit(Position{s, lowest(found)});
+        }
+
+        template <class Visitor>
+        void each(const Scale& scale, Visitor&& visit) const {
+            each(scale.pcset(), std::forward<Visitor>(visit));
+        }
+
+        template <class Visitor>
+        void each(const Chord& chord, Visitor&& visit) const {
+            each(chord.pcset(), std::forward<Visitor>(visit));
+        }
+
+        /**
+         * Write the positions of the set's tones into `out`, as in `each`
+         * Returns how many positions there are, which may be more than fit
+         */
+        size_t find(PcSet set, Span<Position> out) const {
+            size_t n = 0;
+            each(set, [&](Position p) {
+                if ( n < out.size() )
+                    out[n] = p;
+                n++;
+            });
+            return n;
+        }
+
+    private:
+        uint8_t _strings;
+        uint8_t _frets;
+        uint8_t _capo;
+        std::array<Note, max_strings> _tuning;
+        /// MIDI note of each position above the capo, one row per string
+        std::array<std::array<uint8_t, max_positions>, max_strings> _notes{};
+        /// Pitch-class bit of each position, 0 if it is not playable
+        std::array<std::array<uint16_t, max_positions>, max_strings> _bits{};
+
+        void fill(size_t string) {
+            for ( size_t f = 0; f < max_positions; f++ ) {
+                int note = _tuning[string].note() + _capo + int(f);
+                bool ok = f <= playable() && note <= 0x7F;
+                _notes[string][f] = ok ? uint8_t(note) : 0;
+                _bits[string][f] = ok ? uint16_t(1u << (note % 12)) : 0;
+            }
+        }
+
+        static uint8_t lowest(uint32_t bits) {
+            uint8_t n = 0;
+            for ( ; !(bits & 1); bits >>= 1 )
+                n++;
+            return n;
+        }
+};
+
+#endif // FRETBOARD_HPP_
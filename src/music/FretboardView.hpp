@@ -0,0 +1,255 @@
+#ifndef FRETBOARDVIEW_HPP_
+#define FRETBOARDVIEW_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Tone.hpp"
+#include "Note.hpp"
+#include "PcSet.hpp"
+#include "Scale.hpp"
+#include "Fretboard.hpp"
+
+/**
+ * Draws a Fretboard as coloured ASCII on an ANSI terminal, eg.
+ *
+ *   E4  |----|-F--|----|-G--|----|-A--|...
+ *   B3  |-C--|----|-D--|----|-E--|-F--|...
+ *   ...
+ *
+ * with the highest string on top. Frames are drawn into an off-screen
+ * buffer of cells and compared with the previous frame, so `present`
+ * only sends the cells that changed, as a single escape sequence string
+ * in one `write`. Once the buffers are sized for a board, drawing and
+ * presenting frames does not allocate.
+ *
+ * eg.
+ * FretboardView view;
+ * view.draw(guitar, Scale::major("C"));
+ * view.present();
+ * view.draw(guitar, Scale::major("C"), Chord::major_triad(60).pcset());
+ * view.present(); // Only recolours the C, E and G positions
+ */
+class FretboardView {
+    public:
+        enum Style : uint8_t {
+            Plain,
+            ScaleTone,
+            Accent,
+            Root,
+        };
+
+        /// Characters per fret, the note name padded with "-" and a "|"
+        static constexpr size_t fret_width = 5;
+        /// Characters before the first fret, the open note and a "|"
+        static constexpr size_t label_width = Note::max_name + 1;
+
+        /**
+         * @param row, col terminal position of the top left corner, from 1
+         */
+        explicit FretboardView(uint16_t row = 1, uint16_t col = 1): _row(row), _col(col) { }
+
+        size_t rows() const {
+            return _rows;
+        }
+
+        size_t cols() const {
+            return _cols;
+        }
+
+        /**
+         * Draw the next frame: tones of the scale are named, its root
+         * and any accented tones (eg. the chord being played) stand out
+         */
+        void draw(const Fretboard& board, const Scale& scale, PcSet accent = PcSet()) {
+            resize(board.strings(), label_width + board.playable() * fret_width);
+            PcSet tones = scale.pcset() | accent;
+            for ( size_t s = 0; s < board.strings(); s++ ) {
+                Cell* row = &_back[(board.strings() - 1 - s) * _cols];
+                uint32_t marked = board.frets(s, tones);
+                for ( uint8_t f = 0; f <= board.playable(); f++ ) {
+                    Note n = board.note(s, f);
+                    Style style = !(marked >> f & 1) ? Plain
+                                  : n.tone() == scale.root() ? Root
+                                  : accent.contains(n.tone()) ? Accent : ScaleTone;
+                    char name[Note::max_name];
+                    size_t len;
+                    if ( f == 0 ) {
+                        // Open string, always labelled with its note
+                        len = n.format(name);
+                        put(row, 0, name, len, ' ', label_width - 1, style);
+                        row[label_width - 1] = {'|', Plain};
+                        continue;
+                    }
+                    len = style == Plain ? 0 : n.tone().format(name);
+                    Cell* cell = row + label_width + (f - 1) * fret_width;
+                    cell[0] = {'-', Plain};
+                    put(cell, 1, name, len, '-', fret_width - 2, style);
+                    cell[fret_width - 1] = {'|', Plain};
+                }
+            }
+        }
+
+        /**
+         * The escape sequences turning the previous frame into the one
+         * drawn since, which then becomes the previous frame
+         * Only the view's own cells are written, so it can share the
+         * terminal with other output. The string is reused by the next call
+         */
+        const std::string& diff() {
+            _out.clear();
+            Style current = Style(0xFF);
+            size_t next = size_t(-1);
+            if ( _clear && erase() ) {
+                current = Plain;
+                next = 0;
+            }
+            for ( size_t i = 0; i < _back.size(); i++ ) {
+                if ( !_clear && _back[i] == _front[i] )
+                    continue;
+                // Move the cursor only when not already after the last cell
+                if ( i != next || i % _cols == 0 )
+                    move(i / _cols, i % _cols);
+                if ( _back[i].style != current ) {
+                    current = Style(_back[i].style);
+                    _out += sgr[current];
+                }
+                _out += _back[i].ch;
+                _front[i] = _back[i];
+                next = i + 1;
+            }
+            if ( current != Style(0xFF) && current != Plain )
+                _out += sgr[Plain];
+            // Leave the cursor under the board, for any other output
+            if ( next != size_t(-1) )
+                move(_rows, 0);
+            _clear = false;
+            _shown_rows = _rows;
+            _shown_cols = _cols;
+            return _out;
+        }
+
+        /**
+         * Send the changes since the last frame to the terminal, in a
+         * single write, and return the number of bytes written
+         */
+        size_t present(int fd = 1) {
+            const std::string& out = diff();
+            if ( out.empty() )
+                return 0;
+#ifdef _WIN32
+            int n = _write(fd, out.data(), unsigned(out.size()));
+#else
+            ssize_t n = ::write(fd, out.data(), out.size());
+#endif
+            return n < 0 ? 0 : size_t(n);
+        }
+
+        /**
+         * Redraw everything on the next frame, eg. after the terminal
+         * was cleared
+         */
+        void invalidate() {
+            _clear = true;
+        }
+
+    private:
+        struct Cell {
+            char ch;
+            uint8_t style;
+
+            bool operator==(const Cell& other) const {
+                return ch == other.ch && style == other.style;
+            }
+        };
+
+        static constexpr const char* sgr[4] = {
+            "\x1b[0m",      // Plain
+            "\x1b[0;36m",   // ScaleTone, cyan
+            "\x1b[0;1;33m", // Accent, bold yellow
+            "\x1b[0;1;31m", // Root, bold red
+        };
+
+        uint16_t _row;
+        uint16_t _col;
+        size_t _rows = 0;
+        size_t _cols = 0;
+        // Size of the frame on the terminal, to erase what a smaller one leaves
+        size_t _shown_rows = 0;
+        size_t _shown_cols = 0;
+        bool _clear = true;
+        std::vector<Cell> _front;
+        std::vector<Cell> _back;
+        std::string _out;
+
+        /**
+         * Size the buffers for a board, which redraws everything if it
+         * changed
+         */
+        void resize(size_t rows, size_t cols) {
+            if ( rows == _rows && cols == _cols )
+                return;
+            _rows = rows;
+            _cols = cols;
+            _front.assign(rows * cols, {' ', Plain});
+            _back.assign(rows * cols, {' ', Plain});
+            // Worst case, every cell moves the cursor and changes colour,
+            // after erasing the previous frame
+            _out.reserve(16 + rows * cols * 24 + _shown_rows * (_shown_cols + 16));
+            _clear = true;
+        }
+
+        /**
+         * Blank the cells of the frame on the terminal that the current
+         * one does not cover, and return if there were any
+         */
+        bool erase() {
+            bool erased = false;
+            for ( size_t r = 0; r < _shown_rows; r++ ) {
+                size_t from = r < _rows ? _cols : 0;
+                if ( from >= _shown_cols )
+                    continue;
+                if ( !erased )
+                    _out += sgr[Plain];
+                erased = true;
+                move(r, from);
+                _out.append(_shown_cols - from, ' ');
+            }
+            return erased;
+        }
+
+        /// Write text then pad it to width
+        static void put(Cell* cells, size_t at, const char* text, size_t len, char pad, size_t width, Style style) {
+            for ( size_t i = 0; i < width; i++ )
+                cells[at + i] = {i < len ? text[i] : pad, uint8_t(i < len ? style : Plain)};
+        }
+
+        /// Append the cursor position of a cell, as `ESC [ row ; col H`
+        void move(size_t row, size_t col) {
+            _out += "\x1b[";
+            number(_row + row);
+            _out += ';';
+            number(_col + col);
+            _out += 'H';
+        }
+
+        void number(size_t n) {
+            char digits[20];
+            size_t len = 0;
+            do {
+                digits[len++] = char('0' + n % 10);
+                n /= 10;
+            } while ( n );
+            while ( len )
+                _out += digits[--len];
+        }
+};
+
+#endif // FRETBOARDVIEW_HPP_
@@ -3,6 +3,8 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
+#include <stdexcept>
 #include <iostream>
 
 #include "Tone.hpp"
@@ -12,23 +14,70 @@ class Note {
         uint8_t _note;
 
     public:
-        Note(uint8_t note=60): _note(note & 0x7F) {}
-        Note(Tone tone, uint8_t octave): _note(tone.midi(octave)) {}
+        constexpr Note(uint8_t note=60): _note(note & 0x7F) {}
+        constexpr Note(Tone tone, uint8_t octave): _note(tone.midi(octave)) {}
         Note(const std::string& tone, uint8_t octave): _note(Tone(tone).midi(octave)) {}
 
-        uint8_t note() const {
+        /**
+         * Parses scientific pitch notation, as printed by `name()`
+         * eg. "A4" := 69, "C-1" := 0, "Bb3" := 58
+         * Throws std::invalid_argument if the name is not a MIDI note
+         */
+        static constexpr Note parse(std::string_view name) {
+            size_t split = name.find_first_of("-0123456789");
+            if ( split == std::string_view::npos )
+                throw std::invalid_argument("Note::parse: Missing octave");
+            if ( Tone::toneof(name.substr(0, split)) >= 12 )
+                throw std::invalid_argument("Note::parse: Unknown tone");
+            // The octave is that of the letter, so "Cb4" is just below "C4"
+            int tone = Tone::toneof(name.substr(0, 1));
+            if ( split == 2 )
+                tone += name[1] == '#' ? 1 : -1;
+            bool negative = name[split] == '-';
+            if ( split + negative == name.size() )
+                throw std::invalid_argument("Note::parse: Missing octave");
+            int octave = 0;
+            for ( size_t i = split + negative; i < name.size(); i++ ) {
+                if ( name[i] < '0' || name[i] > '9' || octave > 9 )
+                    throw std::invalid_argument("Note::parse: Bad octave");
+                octave = octave * 10 + (name[i] - '0');
+            }
+            int note = tone + ((negative ? -octave : octave) + 1) * 12;
+            if ( note < 0 || note > 0x7F )
+                throw std::invalid_argument("Note::parse: Out of MIDI range");
+            return Note(uint8_t(note));
+        }
+
+        constexpr uint8_t note() const {
             return _note;
         }
 
         std::string name() const {
-            return Tone::nameof(_note) + std::to_string(int(_note / 12) - 1);
+            char buf[max_name];
+            return std::string(buf, format(buf));
+        }
+
+        /// Longest name, eg. "C#-1"
+        static constexpr size_t max_name = Tone::max_name + 2;
+
+        /**
+         * Write the name into out, without allocating or a terminating
+         * null, and return its length (at most `max_name`)
+         */
+        constexpr size_t format(char* out) const {
+            size_t n = tone().format(out);
+            int octave = int(_note / 12) - 1;
+            if ( octave < 0 )
+                out[n++] = '-';
+            out[n++] = char('0' + (octave < 0 ? -octave : octave));
+            return n;
         }
 
-        Tone tone() const {
+        constexpr Tone tone() const {
             return Tone(_note);
         }
 
-        uint8_t octave() const {
+        constexpr uint8_t octave() const {
             return _note / 12;
         }
 
@@ -40,75 +89,81 @@ class Note {
         /**
          * Allow implicit conversion to uint8_t
          */
-        operator uint8_t() const {
+        constexpr operator uint8_t() const {
             return _note;
         }
 
-        bool operator==(const Note& other) const {
+        constexpr bool operator==(const Note& other) const {
             return _note == other._note;
         }
 
-        bool operator!=(const Note& other) const {
+        constexpr bool operator!=(const Note& other) const {
             return _note != other._note;
         }
 
-        bool operator>(const Note& other) const {
+        constexpr bool operator>(const Note& other) const {
             return _note > other._note;
         }
 
-        bool operator<(const Note& other) const {
+        constexpr bool operator<(const Note& other) const {
             return _note < other._note;
         }
 
-        bool operator>=(const Note& other) const {
+        constexpr bool operator>=(const Note& other) const {
             return _note >= other._note;
         }
 
-        bool operator<=(const Note& other) const {
+        constexpr bool operator<=(const Note& other) const {
             return _note <= other._note;
         }
 
-        int operator-(const Note& other) const {
+        constexpr int operator-(const Note& other) const {
             return _note - other._note;
         }
 
-        uint8_t operator-(const Tone& other) const {
+        constexpr uint8_t operator-(const Tone& other) const {
             return (_note + 12 - other.tone()) % 12;
         }
 
-        Note operator+(uint8_t interval) const {
-            return Note(_note + interval);
+        /**
+         * Adding and subtracting intervals wraps around the 128 MIDI
+         * notes, the same as `BulkNotes::transpose`
+         */
+        constexpr Note operator+(uint8_t interval) const {
+            return Note(uint8_t(_note + interval));
         }
 
-        Note& operator+=(uint8_t interval) {
-            _note += interval;
-            _note %= 0x7F;
+        constexpr Note& operator+=(uint8_t interval) {
+            _note = uint8_t(_note + interval) & 0x7F;
             return *this;
         }
 
-        Note operator-(uint8_t interval) const {
-            if ( _note < interval )
-                return Note(0x7F + _note - interval);
-            return Note(_note - interval);
+        constexpr Note operator-(uint8_t interval) const {
+            return Note(uint8_t(_note - interval));
         }
 
-        Note& operator-=(uint8_t interval) {
-            if ( _note < interval )
-                _note = 0x7F - _note + interval;
-            else
-                _note -= interval;
+        constexpr Note& operator-=(uint8_t interval) {
+            _note = uint8_t(_note - interval) & 0x7F;
             return *this;
         }
 
-        friend uint8_t operator-(const Tone& first, const Note& second) {
+        friend constexpr uint8_t operator-(const Tone& first, const Note& second) {
             return ((first.tone() + 12) - (second._note % 12)) % 12;
         }
 
-        bool between(const Tone& start, const Tone& end) const {
+        constexpr bool between(const Tone& start, const Tone& end) const {
             if ( end < start )
                 return end < tone() && tone() <= start;
             return start <= tone() && tone() <= end;
         }
 };
 
+/**
+ * Note literal in scientific pitch notation, see `Note::parse`
+ * eg. `constexpr Note a = "A4"_note;`
+ */
+constexpr Note operator""_note(const char* name, size_t size) {
+    return Note::parse(std::string_view(name, size));
+}
+
 #endif // NOTE_HPP_
\ No newline at end of file
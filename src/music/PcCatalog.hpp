@@ -0,0 +1,306 @@
+#ifndef PCCATALOG_HPP_
+#define PCCATALOG_HPP_
+
+#include <array>
+#include <string>
+#include <cstdint>
+
+#include "Tone.hpp"
+#include "PcSet.hpp"
+#include "Scale.hpp"
+
+/**
+ * Names for every one of the 4096 pitch-class sets, built at compile
+ * time and indexed by the set's bitmask, so naming a set of notes is a
+ * single array access.
+ *
+ * Each entry has the set's prime form and Forte number, the chord it
+ * spells (if any), and the scale it is a mode of (if any).
+ * eg. `PcCatalog::chord_name(PcSet::of({7, 11, 2, 5})) := "G7"`
+ * eg. `PcCatalog::scale_name(Scale::major("C").pcset(), "D") := "D dorian"`
+ */
+class PcCatalog {
+    public:
+        /// Marks an entry with no chord or scale
+        static constexpr uint8_t none = 0xFF;
+
+        struct Entry {
+            /// Forte number of the set class, eg. "4-Z15"
+            const char* forte;
+            /// Prime form, the most compact transposition or inversion
+            /// packed towards "C" (Rahn's ordering)
+            uint16_t prime;
+            /// Index into `qualities` and tone of the chord's root
+            uint8_t chord;
+            uint8_t chord_root;
+            /// Index into `scales` and tone of the family's first mode
+            uint8_t scale;
+            uint8_t scale_root;
+            /// Mode of the scale starting on "C", if "C" is in the set
+            uint8_t mode;
+            /// Index into `qualities` of the largest chord on "C" within
+            /// the set, the other tones being extensions
+            uint8_t quality;
+        };
+
+        struct Quality {
+            const char* name;
+            const char* symbol;
+            uint16_t intervals;
+        };
+
+        /**
+         * In order of preference, as sets such as {C, E, G, A} spell
+         * more than one chord (Am7 and C6)
+         */
+        static constexpr std::array<Quality, 26> qualities = {{
+            {"major", "", 0x091},
+            {"minor", "m", 0x089},
+            {"diminished", "dim", 0x049},
+            {"augmented", "aug", 0x111},
+            {"suspended fourth", "sus4", 0x0A1},
+            {"suspended second", "sus2", 0x085},
+            {"power", "5", 0x081},
+            {"dominant seventh", "7", 0x491},
+            {"major seventh", "maj7", 0x891},
+            {"minor seventh", "m7", 0x489},
+            {"half-diminished seventh", "m7b5", 0x449},
+            {"diminished seventh", "dim7", 0x249},
+            {"minor major seventh", "mMaj7", 0x889},
+            {"augmented seventh", "aug7", 0x511},
+            {"dominant seventh flat five", "7b5", 0x451},
+            {"dominant seventh suspended fourth", "7sus4", 0x4A1},
+            {"major sixth", "6", 0x291},
+            {"minor sixth", "m6", 0x289},
+            {"added ninth", "add9", 0x095},
+            {"minor added ninth", "madd9", 0x08D},
+            {"dominant ninth", "9", 0x495},
+            {"major ninth", "maj9", 0x895},
+            {"minor ninth", "m9", 0x48D},
+            {"dominant seventh flat nine", "7b9", 0x493},
+            {"dominant seventh sharp nine", "7#9", 0x499},
+            {"dominant thirteenth", "13", 0x695},
+        }};
+
+        struct Family {
+            uint16_t intervals;
+            /// Name of the mode starting on each tone of the family, for
+            /// as many tones as it has distinct modes
+            std::array<const char*, 8> modes;
+        };
+
+        static constexpr std::array<Family, 9> scales = {{
+            {0xAB5, {"ionian", "dorian", "phrygian", "lydian", "mixolydian", "aeolian", "locrian"}},
+            {0xAAD, {"melodic minor", "dorian b2", "lydian augmented", "lydian dominant",
+                     "mixolydian b6", "locrian #2", "altered"}},
+            {0x9AD, {"harmonic minor", "locrian #6", "ionian #5", "dorian #4",
+                     "phrygian dominant", "lydian #2", "ultralocrian"}},
+            {0x295, {"major pentatonic", "suspended pentatonic", "blues minor pentatonic",
+                     "blues major pentatonic", "minor pentatonic"}},
+            {0x4E9, {"blues", "major blues"}},
+            {0x555, {"whole tone"}},
+            {0x6DB, {"half-whole diminished", "whole-half diminished"}},
+            {0x999, {"augmented", "inverse augmented"}},
+            {0xFFF, {"chromatic"}},
+        }};
+
+        /// The set's entry, see `Entry`
+        static constexpr const Entry& lookup(PcSet set) {
+            return catalog[set.bits()];
+        }
+
+        static constexpr const char* forte(PcSet set) {
+            return lookup(set).forte;
+        }
+
+        static constexpr PcSet prime(PcSet set) {
+            return PcSet(lookup(set).prime);
+        }
+
+        /**
+         * Root and symbol of the chord the set spells, eg. "F#m7b5",
+         * or an empty string
+         */
+        static std::string chord_name(PcSet set) {
+            const Entry& e = lookup(set);
+            if ( e.chord == none )
+                return "";
+            return Tone::nameof(e.chord_root) + qualities[e.chord].symbol;
+        }
+
+        /**
+         * Canonical name of the scale the set is a mode of, eg. "C ionian",
+         * or an empty string
+         */
+        static std::string scale_name(PcSet set) {
+            const Entry& e = lookup(set);
+            if ( e.scale == none )
+                return "";
+            return Tone::nameof(e.scale_root) + " " + scales[e.scale].modes[0];
+        }
+
+        /**
+         * Name of the mode of the set starting on the root, eg. "D dorian",
+         * or an empty string
+         */
+        static std::string scale_name(PcSet set, Tone root) {
+            const Entry& e = lookup(set.transpose(12 - root.tone()));
+            if ( e.scale == none || e.mode == none || !scales[e.scale].modes[e.mode] )
+                return "";
+            return root.name() + " " + scales[e.scale].modes[e.mode];
+        }
+
+        static std::string scale_name(const Scale& scale) {
+            return scale_name(scale.pcset(), scale.root());
+        }
+
+    private:
+        struct Forte {
+            const char* name;
+            /// Pitches of the prime form, with "T" and "E" for 10 and 11
+            const char* pitches;
+            /// Name of the complement's set class, for sets of 0 to 5 tones
+            const char* complement;
+        };
+
+        static constexpr std::array<Forte, 137> forte_names = {{
+            {"0-1", "", "12-1"}, {"1-1", "0", "11-1"},
+            {"2-1", "01", "10-1"}, {"2-2", "02", "10-2"}, {"2-3", "03", "10-3"},
+            {"2-4", "04", "10-4"}, {"2-5", "05", "10-5"}, {"2-6", "06", "10-6"},
+            {"3-1", "012", "9-1"}, {"3-2", "013", "9-2"}, {"3-3", "014", "9-3"},
+            {"3-4", "015", "9-4"}, {"3-5", "016", "9-5"}, {"3-6", "024", "9-6"},
+            {"3-7", "025", "9-7"}, {"3-8", "026", "9-8"}, {"3-9", "027", "9-9"},
+            {"3-10", "036", "9-10"}, {"3-11", "037", "9-11"}, {"3-12", "048", "9-12"},
+            {"4-1", "0123", "8-1"}, {"4-2", "0124", "8-2"}, {"4-3", "0134", "8-3"},
+            {"4-4", "0125", "8-4"}, {"4-5", "0126", "8-5"}, {"4-6", "0127", "8-6"},
+            {"4-7", "0145", "8-7"}, {"4-8", "0156", "8-8"}, {"4-9", "0167", "8-9"},
+            {"4-10", "0235", "8-10"}, {"4-11", "0135", "8-11"}, {"4-12", "0236", "8-12"},
+            {"4-13", "0136", "8-13"}, {"4-14", "0237", "8-14"}, {"4-Z15", "0146", "8-Z15"},
+            {"4-16", "0157", "8-16"}, {"4-17", "0347", "8-17"}, {"4-18", "0147", "8-18"},
+            {"4-19", "0148", "8-19"}, {"4-20", "0158", "8-20"}, {"4-21", "0246", "8-21"},
+            {"4-22", "0247", "8-22"}, {"4-23", "0257", "8-23"}, {"4-24", "0248", "8-24"},
+            {"4-25", "0268", "8-25"}, {"4-26", "0358", "8-26"}, {"4-27", "0258", "8-27"},
+            {"4-28", "0369", "8-28"}, {"4-Z29", "0137", "8-Z29"},
+            {"5-1", "01234", "7-1"}, {"5-2", "01235", "7-2"}, {"5-3", "01245", "7-3"},
+            {"5-4", "01236", "7-4"}, {"5-5", "01237", "7-5"}, {"5-6", "01256", "7-6"},
+            {"5-7", "01267", "7-7"}, {"5-8", "02346", "7-8"}, {"5-9", "01246", "7-9"},
+            {"5-10", "01346", "7-10"}, {"5-11", "02347", "7-11"}, {"5-Z12", "01356", "7-Z12"},
+            {"5-13", "01248", "7-13"}, {"5-14", "01257", "7-14"}, {"5-15", "01268", "7-15"},
+            {"5-16", "01347", "7-16"}, {"5-Z17", "01348", "7-Z17"}, {"5-Z18", "01457", "7-Z18"},
+            {"5-19", "01367", "7-19"}, {"5-20", "01378", "7-20"}, {"5-21", "01458", "7-21"},
+            {"5-22", "01478", "7-22"}, {"5-23", "02357", "7-23"}, {"5-24", "01357", "7-24"},
+            {"5-25", "02358", "7-25"}, {"5-26", "02458", "7-26"}, {"5-27", "01358", "7-27"},
+            {"5-28", "02368", "7-28"}, {"5-29", "01368", "7-29"}, {"5-30", "01468", "7-30"},
+            {"5-31", "01369", "7-31"}, {"5-32", "01469", "7-32"}, {"5-33", "02468", "7-33"},
+            {"5-34", "02469", "7-34"}, {"5-35", "02479", "7-35"}, {"5-Z36", "01247", "7-Z36"},
+            {"5-Z37", "03458", "7-Z37"}, {"5-Z38", "01258", "7-Z38"},
+            {"6-1", "012345", nullptr}, {"6-2", "012346", nullptr}, {"6-Z3", "012356", nullptr},
+            {"6-Z4", "012456", nullptr}, {"6-5", "012367", nullptr}, {"6-Z6", "012567", nullptr},
+            {"6-7", "012678", nullptr}, {"6-8", "023457", nullptr}, {"6-9", "012357", nullptr},
+            {"6-Z10", "013457", nullptr}, {"6-Z11", "012457", nullptr}, {"6-Z12", "012467", nullptr},
+            {"6-Z13", "013467", nullptr}, {"6-14", "013458", nullptr}, {"6-15", "012458", nullptr},
+            {"6-16", "014568", nullptr}, {"6-Z17", "012478", nullptr}, {"6-18", "012578", nullptr},
+            {"6-Z19", "013478", nullptr}, {"6-20", "014589", nullptr}, {"6-21", "023468", nullptr},
+            {"6-22", "012468", nullptr}, {"6-Z23", "023568", nullptr}, {"6-Z24", "013468", nullptr},
+            {"6-Z25", "013568", nullptr}, {"6-Z26", "013578", nullptr}, {"6-27", "013469", nullptr},
+            {"6-Z28", "013569", nullptr}, {"6-Z29", "013689", nullptr}, {"6-30", "013679", nullptr},
+            {"6-31", "013589", nullptr}, {"6-32", "024579", nullptr}, {"6-33", "023579", nullptr},
+            {"6-34", "013579", nullptr}, {"6-35", "02468T", nullptr}, {"6-Z36", "012347", nullptr},
+            {"6-Z37", "012348", nullptr}, {"6-Z38", "012378", nullptr}, {"6-Z39", "023458", nullptr},
+            {"6-Z40", "012358", nullptr}, {"6-Z41", "012368", nullptr}, {"6-Z42", "012369", nullptr},
+            {"6-Z43", "012568", nullptr}, {"6-Z44", "012569", nullptr}, {"6-Z45", "023469", nullptr},
+            {"6-Z46", "012469", nullptr}, {"6-Z47", "012479", nullptr}, {"6-Z48", "012579", nullptr},
+            {"6-Z49", "013479", nullptr}, {"6-Z50", "014679", nullptr},
+        }};
+
+        static constexpr PcSet parse(const char* pitches) {
+            PcSet set;
+            for ( ; *pitches; pitches++ )
+                set = set.with(*pitches == 'T' ? 10 : *pitches == 'E' ? 11 : uint8_t(*pitches - '0'));
+            return set;
+        }
+
+        static constexpr uint16_t prime_of(PcSet set) {
+            uint16_t best = set.bits();
+            PcSet inverted = set.invert();
+            for ( uint8_t t = 0; t < 12; t++ ) {
+                uint16_t up = set.transpose(t).bits(), down = inverted.transpose(t).bits();
+                best = up < best ? up : best;
+                best = down < best ? down : best;
+            }
+            return best;
+        }
+
+        static constexpr std::array<Entry, 4096> build() {
+            std::array<Entry, 4096> entries{};
+            std::array<const char*, 4096> names{};
+            for ( auto& f: forte_names ) {
+                PcSet set = parse(f.pitches);
+                names[prime_of(set)] = f.name;
+                if ( f.complement )
+                    names[prime_of(set.complement())] = f.complement;
+            }
+            for ( uint16_t bits = 0; bits < 4096; bits++ ) {
+                Entry& e = entries[bits];
+                e.chord = e.chord_root = e.scale = e.scale_root = e.mode = e.quality = none;
+                // Only non-empty sets have a non-zero prime form
+                if ( bits && e.prime )
+                    continue;
+                // Fill in the whole set class at once
+                uint16_t prime = prime_of(PcSet(bits));
+                PcSet set(bits), inverted = set.invert();
+                for ( uint8_t t = 0; t < 12; t++ ) {
+                    entries[set.transpose(t).bits()].prime = prime;
+                    entries[inverted.transpose(t).bits()].prime = prime;
+                }
+            }
+            for ( auto& e: entries )
+                e.forte = names[e.prime];
+            for ( uint8_t q = 0; q < qualities.size(); q++ )
+                for ( uint8_t root = 0; root < 12; root++ ) {
+                    Entry& e = entries[PcSet(qualities[q].intervals).transpose(root).bits()];
+                    if ( e.chord == none ) {
+                        e.chord = q;
+                        e.chord_root = root;
+                    }
+                }
+            for ( uint8_t q = 0; q < qualities.size(); q++ ) {
+                // Every superset of the chord, by walking the subsets of the rest
+                PcSet chord(qualities[q].intervals), rest = chord.complement();
+                for ( uint16_t sub = 0; ; sub = (sub - rest.bits()) & rest.bits() ) {
+                    Entry& e = entries[chord.bits() | sub];
+                    if ( e.quality == none || PcSet(qualities[e.quality].intervals).size() < chord.size() )
+                        e.quality = q;
+                    if ( sub == rest.bits() )
+                        break;
+                }
+            }
+            for ( uint8_t s = 0; s < scales.size(); s++ ) {
+                PcSet family(scales[s].intervals);
+                // Symmetric scales, like whole tone, repeat their modes
+                uint8_t period = 1;
+                while ( family.transpose(period) != family )
+                    period++;
+                uint8_t modes = (family & PcSet(uint16_t((1u << period) - 1))).size();
+                for ( uint8_t root = 0; root < 12; root++ ) {
+                    PcSet set = family.transpose(root);
+                    Entry& e = entries[set.bits()];
+                    if ( e.scale != none )
+                        continue;
+                    e.scale = s;
+                    e.scale_root = root;
+                    // "C" comes after every tone from the root up to "B"
+                    if ( set.contains(0) )
+                        e.mode = (set & PcSet(uint16_t(PcSet::all << root))).size() % modes;
+                }
+            }
+            return entries;
+        }
+
+        static const std::array<Entry, 4096> catalog;
+};
+
+// Defined out of the class, as `build()` can only run once it is complete
+inline constexpr std::array<PcCatalog::Entry, 4096> PcCatalog::catalog = PcCatalog::build();
+
+#endif // PCCATALOG_HPP_
@@ -0,0 +1,219 @@
+#ifndef PCSET_HPP_
+#define PCSET_HPP_
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+
+#include "Tone.hpp"
+
+/**
+ * A pitch-class set: which of the 12 tones are present, regardless of
+ * octave or order, stored as a 12-bit mask with bit "0" for "C" through
+ * bit "11" for "B".
+ *
+ * Membership, transposition, intersection, subset and equality are all
+ * single integer operations, eg. a C-major scale is `0xAB5`.
+ */
+class PcSet {
+    private:
+        uint16_t _bits;
+
+    public:
+        static constexpr uint16_t all = 0xFFF;
+
+        constexpr PcSet(): _bits(0) { }
+        constexpr explicit PcSet(uint16_t bits): _bits(bits & all) { }
+
+        /**
+         * Set with the given intervals above "C", eg. `PcSet::of({0, 4, 7})`
+         * is a C-major triad. Intervals are taken modulo 12.
+         */
+        template <class Container>
+        static constexpr PcSet of(const Container& degrees) {
+            PcSet set;
+            for ( auto d: degrees )
+                set._bits |= uint16_t(1u << (uint8_t(d) % 12));
+            return set;
+        }
+
+        static constexpr PcSet of(std::initializer_list<uint8_t> degrees) {
+            return of<std::initializer_list<uint8_t>>(degrees);
+        }
+
+        constexpr uint16_t bits() const {
+            return _bits;
+        }
+
+        /// Number of tones in the set
+        constexpr uint8_t size() const {
+            uint16_t b = _bits;
+            uint8_t n = 0;
+            for ( ; b; b &= b - 1 )
+                n++;
+            return n;
+        }
+
+        constexpr bool empty() const {
+            return _bits == 0;
+        }
+
+        constexpr bool contains(uint8_t tone) const {
+            return (_bits >> (tone % 12)) & 1;
+        }
+
+        constexpr bool contains(const Tone& tone) const {
+            return contains(tone.tone());
+        }
+
+        constexpr PcSet with(uint8_t tone) const {
+            return PcSet(uint16_t(_bits | (1u << (tone % 12))));
+        }
+
+        constexpr PcSet without(uint8_t tone) const {
+            return PcSet(uint16_t(_bits & ~(1u << (tone % 12))));
+        }
+
+        /**
+         * Every tone moved up by the interval, which rotates the mask
+         * eg. `{C, E, G}.transpose(2) := {D, F#, A}`
+         */
+        constexpr PcSet transpose(uint8_t interval) const {
+            uint8_t n = interval % 12;
+            return PcSet(uint16_t((_bits << n) | (_bits >> (12 - n))));
+        }
+
+        /// Tones reflected around "C", eg. `{C, E, G}.invert() := {C, G#, F}`
+        constexpr PcSet invert() const {
+            uint16_t b = _bits & 1;
+            for ( uint8_t i = 1; i < 12; i++ )
+                if ( (_bits >> i) & 1 )
+                    b |= uint16_t(1u << (12 - i));
+            return PcSet(b);
+        }
+
+        /// Tones not in the set
+        constexpr PcSet complement() const {
+            return PcSet(uint16_t(~_bits));
+        }
+
+        constexpr bool subset_of(const PcSet& other) const {
+            return (_bits & ~other._bits) == 0;
+        }
+
+        constexpr bool intersects(const PcSet& other) const {
+            return (_bits & other._bits) != 0;
+        }
+
+        /**
+         * Interval-class vector: how many pairs of tones are 1 through 6
+         * semitones apart, eg. {2, 5, 4, 3, 6, 1} for the major scale
+         */
+        constexpr std::array<uint8_t, 6> interval_vector() const {
+            std::array<uint8_t, 6> v{};
+            for ( uint8_t i = 1; i <= 6; i++ ) {
+                // Each pair once, a tritone is its own inversion
+                uint16_t pairs = _bits & transpose(i)._bits;
+                v[i - 1] = uint8_t(PcSet(pairs).size() / (i == 6 ? 2 : 1));
+            }
+            return v;
+        }
+
+        /// Lowest tone in the set, or 12 if it is empty
+        constexpr uint8_t first() const {
+            for ( uint8_t i = 0; i < 12; i++ )
+                if ( (_bits >> i) & 1 )
+                    return i;
+            return 12;
+        }
+
+        /// Next tone in the set strictly above the tone, wrapping, or 12 if empty
+        constexpr uint8_t next(uint8_t tone) const {
+            for ( uint8_t i = 1; i <= 12; i++ )
+                if ( contains(uint8_t(tone + i)) )
+                    return (tone + i) % 12;
+            return 12;
+        }
+
+        constexpr PcSet operator|(const PcSet& other) const {
+            return PcSet(uint16_t(_bits | other._bits));
+        }
+
+        constexpr PcSet operator&(const PcSet& other) const {
+            return PcSet(uint16_t(_bits & other._bits));
+        }
+
+        constexpr PcSet operator^(const PcSet& other) const {
+            return PcSet(uint16_t(_bits ^ other._bits));
+        }
+
+        constexpr PcSet operator-(const PcSet& other) const {
+            return PcSet(uint16_t(_bits & ~other._bits));
+        }
+
+        constexpr PcSet& operator|=(const PcSet& other) {
+            _bits |= other._bits;
+            return *this;
+        }
+
+        constexpr PcSet& operator&=(const PcSet& other) {
+            _bits &= other._bits;
+            return *this;
+        }
+
+        constexpr bool operator==(const PcSet& other) const {
+            return _bits == other._bits;
+        }
+
+        constexpr bool operator!=(const PcSet& other) const {
+            return _bits != other._bits;
+        }
+
+        /**
+         * Iterates the tones in the set, from "C" upward
+         */
+        class Iterator {
+            uint16_t _rest;
+
+            public:
+                constexpr Iterator(uint16_t rest): _rest(rest) { }
+
+                constexpr Iterator& operator++() {
+                    _rest &= _rest - 1;
+                    return *this;
+                }
+
+                constexpr bool operator==(const Iterator& other) const {
+                    return _rest == other._rest;
+                }
+
+                constexpr bool operator!=(const Iterator& other) const {
+                    return _rest != other._rest;
+                }
+
+                constexpr Tone operator*() const {
+                    return Tone(PcSet(_rest).first());
+                }
+        };
+
+        constexpr Iterator begin() const {
+            return Iterator(_bits);
+        }
+
+        constexpr Iterator end() const {
+            return Iterator(0);
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const PcSet& set) {
+            os << "{";
+            bool first = true;
+            for ( auto t: set ) {
+                os << (first ? "" : ", ") << t;
+                first = false;
+            }
+            os << "}";
+            return os;
+        }
+};
+
+#endif // PCSET_HPP_
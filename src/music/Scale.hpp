@@ -1,150 +1,465 @@
 #ifndef SCALE_HPP_
 #define SCALE_HPP_
 
+#include <array>
+#include <atomic>
 #include <vector>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include <initializer_list>
+#include <cstddef>
 #include <cstdint>
 
 #include "Tone.hpp"
+#include "Note.hpp"
+#include "PcSet.hpp"
+#include "Span.hpp"
 
 class Scale {
     private:
-        std::vector<Tone> _tones;
+        Tone _root;
+        // Tones are always kept in ascending order from the root, so
+        // the root and the pitch-class set are all that is needed
+        PcSet _set;
 
-        void replace(const Tone& root, const std::vector<uint8_t>& degrees) {
+        template <class Container>
+        constexpr void replace(const Tone& root, const Container& degrees) {
             uint8_t last = 0;
-            _tones = {root};
+            _root = root;
+            _set = PcSet().with(root.tone());
             for ( auto d: degrees ) {
                 if ( d > 12 )
                     break;
                 if ( d > last ) {
-                    _tones.push_back(root + d);
+                    _set = _set.with((root + d).tone());
                     last = d;
                 }
             }
         }
 
     public:
-        Scale() {
-            replace(Tone(0), {0,1,2,3,4,5,6,7,8,9,10,11});
-        }
+        constexpr Scale(): _root(0), _set(PcSet::all) { }
 
         Scale(Tone root, const std::vector<uint8_t>& degrees) {
             replace(root, degrees);
         }
 
-        Scale(const std::vector<Tone>& tones) {
-            if ( tones.size() == 0 ) {
-                *this = Scale();
+        constexpr Scale(Tone root, std::initializer_list<uint8_t> degrees) {
+            replace(root, degrees);
+        }
+
+        /**
+         * Scale of the tones in the set, starting from the root
+         * The root is added to the set if it is missing
+         */
+        constexpr Scale(Tone root, PcSet set): _root(root), _set(set.with(root.tone())) { }
+
+        Scale(const std::vector<Tone>& tones): _root(0), _set(PcSet::all) {
+            if ( tones.size() == 0 )
                 return;
-            }
-            Tone root = tones[0];
-            std::vector<uint8_t> degrees;
+            _root = tones[0];
+            _set = PcSet().with(_root.tone());
             uint8_t last = 0;
             for ( auto t: tones ) {
-                uint8_t d = t - root;
+                uint8_t d = t - tones[0];
                 if ( d > last ) {
-                    degrees.push_back(d);
+                    _set = _set.with(t.tone());
                     last = d;
                 }
             }
-            replace(root, degrees);
         }
 
-        std::vector<Tone> tones() const {
-            return _tones;
+        /**
+         * Lazy view of the scale's tones, ascending from the root
+         * Converts to a `std::vector<Tone>` when a copy is needed
+         */
+        class Tones {
+            Tone _root;
+            PcSet _set;
+
+            public:
+                class Iterator {
+                    PcSet _set;
+                    uint8_t _tone;
+                    uint8_t _left;
+
+                    public:
+                        using iterator_category = std::forward_iterator_tag;
+                        using value_type = Tone;
+                        using difference_type = std::ptrdiff_t;
+                        using pointer = void;
+                        using reference = Tone;
+
+                        constexpr Iterator(): _set(), _tone(0), _left(0) { }
+                        constexpr Iterator(PcSet set, uint8_t tone, uint8_t left): _set(set), _tone(tone), _left(left) { }
+
+                        constexpr Tone operator*() const {
+                            return Tone(_tone);
+                        }
+
+                        constexpr Iterator& operator++() {
+                            _tone = _set.next(_tone);
+                            _left--;
+                            return *this;
+                        }
+
+                        constexpr Iterator operator++(int) {
+                            Iterator was = *this;
+                            ++*this;
+                            return was;
+                        }
+
+                        constexpr bool operator==(const Iterator& other) const {
+                            return _left == other._left;
+                        }
+
+                        constexpr bool operator!=(const Iterator& other) const {
+                            return _left != other._left;
+                        }
+                };
+
+                using iterator = Iterator;
+                using const_iterator = Iterator;
+                using value_type = Tone;
+
+                constexpr Tones(Tone root, PcSet set): _root(root), _set(set) { }
+
+                constexpr Iterator begin() const {
+                    return Iterator(_set, _root.tone(), uint8_t(_set.size()));
+                }
+
+                constexpr Iterator end() const {
+                    return Iterator(_set, _root.tone(), 0);
+                }
+
+                constexpr size_t size() const {
+                    return _set.size();
+                }
+
+                constexpr bool empty() const {
+                    return _set.size() == 0;
+                }
+
+                operator std::vector<Tone>() const {
+                    return std::vector<Tone>(begin(), end());
+                }
+
+                bool operator==(const std::vector<Tone>& other) const {
+                    return size() == other.size() && std::equal(begin(), end(), other.begin());
+                }
+
+                bool operator!=(const std::vector<Tone>& other) const {
+                    return !(*this == other);
+                }
+        };
+
+        /**
+         * Lazy view of the notes of the scale between two notes, inclusive,
+         * ascending, each found from the last when iterating
+         */
+        class Notes {
+            PcSet _set;
+            Note _first;
+            Note _last;
+
+            public:
+                class Iterator {
+                    PcSet _set;
+                    int16_t _note;
+                    int16_t _last;
+
+                    constexpr bool done() const {
+                        return _note > _last;
+                    }
+
+                    public:
+                        using iterator_category = std::forward_iterator_tag;
+                        using value_type = Note;
+                        using difference_type = std::ptrdiff_t;
+                        using pointer = void;
+                        using reference = Note;
+
+                        constexpr Iterator(): _set(), _note(1), _last(0) { }
+
+                        /// First note of the set from `note`
+                        constexpr Iterator(PcSet set, int16_t note, int16_t last): _set(set), _note(note), _last(last) {
+                            if ( _set.size() == 0 )
+                                _note = int16_t(_last + 1);
+                            while ( !done() && !_set.contains(uint8_t(_note)) )
+                                _note++;
+                        }
+
+                        constexpr Note operator*() const {
+                            return Note(uint8_t(_note));
+                        }
+
+                        constexpr Iterator& operator++() {
+                            uint8_t tone = uint8_t(_note % 12);
+                            _note = int16_t(_note + (_set.next(tone) - tone + 11) % 12 + 1);
+                            return *this;
+                        }
+
+                        constexpr Iterator operator++(int) {
+                            Iterator was = *this;
+                            ++*this;
+                            return was;
+                        }
+
+                        constexpr bool operator==(const Iterator& other) const {
+                            return done() ? other.done() : !other.done() && _note == other._note;
+                        }
+
+                        constexpr bool operator!=(const Iterator& other) const {
+                            return !(*this == other);
+                        }
+                };
+
+                using iterator = Iterator;
+                using const_iterator = Iterator;
+                using value_type = Note;
+
+                constexpr Notes(PcSet set, Note first, Note last): _set(set), _first(first), _last(last) { }
+
+                constexpr Iterator begin() const {
+                    return Iterator(_set, _first.note(), _last.note());
+                }
+
+                constexpr Iterator end() const {
+                    return Iterator();
+                }
+
+                constexpr bool empty() const {
+                    return begin() == end();
+                }
+
+                /// Number of notes, counted without iterating
+                constexpr size_t size() const {
+                    if ( _last < _first )
+                        return 0;
+                    return below(_last.note() + 1) - below(_first.note());
+                }
+
+            private:
+                /// Notes of the set below n
+                constexpr size_t below(int n) const {
+                    return size_t(n / 12) * _set.size()
+                         + (_set & PcSet(uint16_t((1u << (n % 12)) - 1))).size();
+                }
+        };
+
+        constexpr Tones tones() const {
+            return Tones(_root, _set);
+        }
+
+        constexpr Tone root() const {
+            return _root;
         }
 
-        Tone root() const {
-            return _tones[0];
+        /**
+         * The tones of the scale as a pitch-class set, independent of root
+         */
+        constexpr PcSet pcset() const {
+            return _set;
         }
 
-        size_t length() const {
-            return _tones.size();
+        constexpr bool contains(const Tone& tone) const {
+            return _set.contains(tone.tone());
         }
 
-        const Tone& operator[](size_t i) const {
-            return _tones[i % _tones.size()];
+        constexpr bool contains(const Note& note) const {
+            return _set.contains(note.note());
+        }
+
+        /**
+         * Whether every tone of the other scale is in this one
+         */
+        constexpr bool contains(const Scale& other) const {
+            return other._set.subset_of(_set);
+        }
+
+        /**
+         * Same scale, with every tone moved up by the interval
+         */
+        constexpr Scale transpose(uint8_t interval) const {
+            return Scale(root() + interval, _set.transpose(interval));
+        }
+
+        constexpr size_t length() const {
+            return _set.size();
+        }
+
+        /**
+         * The i-th tone ascending from the root, wrapping every octave
+         */
+        constexpr Tone operator[](size_t i) const {
+            uint8_t t = _root.tone();
+            for ( i %= length(); i > 0; i-- )
+                t = _set.next(t);
+            return Tone(t);
+        }
+
+        /**
+         * Notes of the scale between 2 notes, inclusive, without allocating
+         *
+         * eg.
+         * for ( Note n: Scale::major("C").notes_between(60, 72) )
+         *     ...
+         */
+        constexpr Notes notes_between(Note first, Note last) const {
+            return Notes(_set, first, last);
+        }
+
+        /**
+         * Every note of the scale from a note upwards, as far as MIDI
+         * goes, without allocating
+         */
+        constexpr Notes notes(Note from = Note(0)) const {
+            return Notes(_set, from, Note(0x7F));
         }
 
         /**
          * Get all notes belonging to a scale, between 2 notes
          * (inclusive of first and end last)
          */
-        std::vector<Note> range(Note first, Note last) {
-            uint8_t pos_first, pos_last;
-            if ( last < first )
-                return {};
+        std::vector<Note> range(Note first, Note last) const {
+            Notes view = notes_between(first, last);
+            return std::vector<Note>(view.begin(), view.end());
+        }
+
+        /**
+         * Where @b quantize moves a note that is not in the scale
+         */
+        enum class Round : uint8_t {
+            // The scale note below
+            Down,
+            // The scale note above
+            Up,
+            // Whichever is closer, the one below on a tie
+            Nearest,
+        };
 
-            for ( size_t i = 0; i < length(); i++ )
-                if ( first.between(_tones[i % length()], _tones[i % length()]) )
-                    pos_first = i;
+        /**
+         * Note to note table, snapping each of the 128 MIDI notes to a
+         * pitch-class set, so quantizing is a single indexed load.
+         * Notes past the lowest or highest note of the set go to it.
+         */
+        class Quantizer {
+            private:
+                std::array<uint8_t, 128> _table;
 
-            for ( size_t i = 0; i < length(); i++ )
-                if ( last.between(_tones[i % length()], _tones[i % length()]) )
-                    pos_last = i;
+            public:
+                constexpr Quantizer(PcSet set, Round round): _table{} {
+                    for ( int n = 0; n < 128; n++ ) {
+                        int below = n;
+                        int above = n;
+                        while ( below >= 0 && !set.contains(uint8_t(below)) )
+                            below--;
+                        while ( above < 128 && !set.contains(uint8_t(above)) )
+                            above++;
+                        int to = n;
+                        if ( below < 0 && above > 127 )
+                            to = n; // Empty set, nothing to snap to
+                        else if ( below < 0 )
+                            to = above;
+                        else if ( above > 127 )
+                            to = below;
+                        else if ( round == Round::Down )
+                            to = below;
+                        else if ( round == Round::Up )
+                            to = above;
+                        else
+                            to = n - below <= above - n ? below : above;
+                        _table[n] = uint8_t(to);
+                    }
+                }
 
-            size_t octaves = last.octave() - first.octave();
-            uint8_t base_octave = first.octave();
+                constexpr Note operator()(Note note) const {
+                    return Note(_table[note.note()]);
+                }
 
-            if ( pos_last < pos_first )
-                octaves -= 1;
+                constexpr uint8_t operator[](uint8_t note) const {
+                    return _table[note & 0x7F];
+                }
 
-            size_t steps = octaves * length() + pos_last + 1 - pos_first;
-            std::vector<Note> notes;
-            for ( size_t i = 0; i < steps; i++ ) {
-                notes.push_back(Note(_tones[i % length()], base_octave + (i / length())));
+                /**
+                 * Quantize every note in place
+                 */
+                void operator()(Span<Note> notes) const {
+                    for ( Note& n: notes )
+                        n = Note(_table[n.note()]);
+                }
+
+                /**
+                 * Quantize every MIDI note number in place
+                 */
+                void operator()(Span<uint8_t> notes) const {
+                    for ( uint8_t& n: notes )
+                        n = _table[n & 0x7F];
+                }
+        };
+
+        /**
+         * Quantizer for the tones of this scale, shared by every scale
+         * with the same tones. The first call for a set of tones builds
+         * it, and later calls only load a pointer, without locking.
+         */
+        const Quantizer& quantizer(Round round = Round::Nearest) const {
+            // Never freed, at most one per set and rounding
+            static std::atomic<const Quantizer*> cache[3 * (PcSet::all + 1)];
+            std::atomic<const Quantizer*>& slot = cache[size_t(round) * (PcSet::all + 1) + _set.bits()];
+            const Quantizer* q = slot.load(std::memory_order_acquire);
+            if ( !q ) {
+                const Quantizer* made = new Quantizer(_set, round);
+                if ( slot.compare_exchange_strong(q, made, std::memory_order_acq_rel) )
+                    q = made;
+                else
+                    delete made; // Another thread got there first
             }
-            return notes;
-        }
-        // std::vector<Note> between(Note first, Note last) {
-        //     if ( start <= end )
-        //         return {};
-        //     size_t start_pos, end_pos;
-        //     uint8_t min_int = 12, max_int = 12;
-        //     for ( size_t i = 0; i < length(); i++ ) {
-        //         if ( (_notes[i] - first) < min_int ) {
-        //             start_pos = i;
-        //             min_int = (_notes[i] - first);
-        //         }
-        //     }
-        //     for ( size_t i = 0; i < length(); i++ ) {
-        //         if ( (last - _notes[i]) < max_int ) {
-        //             end_pos = i;
-        //             max_int = (last - _notes[i]);
-        //         }
-        //     }
-        //     std::vector<Note> notes;
-        //     size_t octaves = last.octave() - first.octave();
-        //     size_t steps;
-
-        //     if ( octaves > 0 && end_pos > start_pos )
-        //         steps = octaves * length() + end_pos - start_pos;
-        //     else if ( octaves > 0 )
-        //         steps = octaves * length() + start_pos - end_pos;
-        //     else
-        //         steps = 
-        //     while ( 
-        // }
-
-        static Scale ionian(const Tone& root) { return Scale(root, {0, 2, 4, 5, 7, 9, 11}); }
-        static Scale dorian(const Tone& root) { return Scale(root, {0, 2, 3, 5, 7, 9, 10}); }
-        static Scale phrygian(const Tone& root) { return Scale(root, {0, 1, 3, 5, 7, 8, 10}); }
-        static Scale lydian(const Tone& root) { return Scale(root, {0, 2, 4, 6, 7, 9, 11}); }
-        static Scale mixolydian(const Tone& root) { return Scale(root, {0, 2, 4, 5, 7, 9, 10}); }
-        static Scale aeolian(const Tone& root) { return Scale(root, {0, 2, 3, 5, 7, 8, 10}); }
-        static Scale lorian(const Tone& root) { return Scale(root, {0, 1, 3, 5, 6, 8, 19}); }
-
-        static Scale major(Tone root) { return ionian(root); }
-        static Scale minor(Tone root) { return aeolian(root); }
-
-        bool operator==(const Scale& other) const {
-            if ( other.length() != length() )
-                return false;
-            for ( size_t i = 0; i < length(); i++ )
-                if ( other[i] != (*this)[i] )
-                    return false;
-            return true;
+            return *q;
+        }
+
+        /**
+         * The note of the scale a note snaps to, see @b Round
+         *
+         * eg.
+         * Scale::major("C").quantize(61) == 60
+         * Scale::major("C").quantize(61, Scale::Round::Up) == 62
+         */
+        Note quantize(Note note, Round round = Round::Nearest) const {
+            return quantizer(round)(note);
+        }
+
+        /**
+         * Quantize a whole buffer of notes in place
+         */
+        void quantize(Span<Note> notes, Round round = Round::Nearest) const {
+            quantizer(round)(notes);
+        }
+
+        static constexpr Scale ionian(const Tone& root) { return Scale(root, {0, 2, 4, 5, 7, 9, 11}); }
+        static constexpr Scale dorian(const Tone& root) { return Scale(root, {0, 2, 3, 5, 7, 9, 10}); }
+        static constexpr Scale phrygian(const Tone& root) { return Scale(root, {0, 1, 3, 5, 7, 8, 10}); }
+        static constexpr Scale lydian(const Tone& root) { return Scale(root, {0, 2, 4, 6, 7, 9, 11}); }
+        static constexpr Scale mixolydian(const Tone& root) { return Scale(root, {0, 2, 4, 5, 7, 9, 10}); }
+        static constexpr Scale aeolian(const Tone& root) { return Scale(root, {0, 2, 3, 5, 7, 8, 10}); }
+        static constexpr Scale locrian(const Tone& root) { return Scale(root, {0, 1, 3, 5, 6, 8, 10}); }
+        // Misspelled original name of `locrian`
+        static constexpr Scale lorian(const Tone& root) { return locrian(root); }
+
+        static constexpr Scale major(Tone root) { return ionian(root); }
+        static constexpr Scale minor(Tone root) { return aeolian(root); }
+
+        constexpr bool operator==(const Scale& other) const {
+            return root() == other.root() && _set == other._set;
+        }
+
+        constexpr bool operator!=(const Scale& other) const {
+            return !(*this == other);
         }
 };
 
+static_assert(std::is_trivially_copyable<Scale>::value, "Scale must be trivially copyable");
+static_assert(sizeof(Scale) <= 4, "Scale must stay a root and a pitch-class set");
+
 #endif // SCALE_HPP_
\ No newline at end of file
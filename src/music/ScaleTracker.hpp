@@ -0,0 +1,229 @@
+#ifndef SCALETRACKER_HPP_
+#define SCALETRACKER_HPP_
+
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+
+#include "Tone.hpp"
+#include "Note.hpp"
+#include "PcSet.hpp"
+#include "Scale.hpp"
+#include "Span.hpp"
+
+/**
+ * Follows the key or mode of a live stream of notes, eg. while a player
+ * improvises.
+ *
+ * Keeps a pitch-class histogram in which older notes fade away, and
+ * scores it against every mode of the major scale on every root: the
+ * correlation with a Krumhansl-style tonal profile of the mode, plus a
+ * bonus if every recently heard tone fits in the mode.
+ *
+ * Each note is a constant amount of work, whatever the length of the
+ * history: the correlations are kept as running dot products against
+ * precomputed, normalised profiles, and the decay is applied by growing
+ * the weight of new notes instead of shrinking the old ones.
+ *
+ * eg.
+ * ScaleTracker tracker;
+ * for ( auto n: Scale::dorian("D").notes_between(62, 74) )
+ *     tracker.note(n);
+ * tracker.best().scale := Scale::dorian("D")
+ */
+class ScaleTracker {
+    public:
+        /// Modes of the major scale, from ionian to locrian
+        static constexpr size_t modes = 7;
+        static constexpr size_t candidates = modes * 12;
+        /// Number of best candidates kept by `top`
+        static constexpr size_t top_size = 5;
+        /// Added to the score of a mode containing every recent tone
+        static constexpr float fit_bonus = 0.25f;
+
+        struct Candidate {
+            Scale scale;
+            float score = 0;
+            /// Pearson correlation of the histogram with the mode's profile
+            float correlation = 0;
+            /// Whether every recent tone is in the scale
+            bool fits = false;
+        };
+
+        /**
+         * @param decay how much of its weight a note keeps for each note
+         *        played after it, eg. 0.95 halves it every ~14 notes
+         * @param presence fraction of a new note's weight above which a
+         *        tone still counts as heard, for the exact fit
+         */
+        explicit ScaleTracker(float decay = 0.95f, float presence = 0.5f): _decay(decay), _presence(presence) {
+            reset();
+        }
+
+        /**
+         * Forget every note heard
+         */
+        void reset() {
+            _hist = {};
+            _dots = {};
+            _sum = _sum2 = 0;
+            _inc = 1;
+            _top = {};
+            _top_count = 0;
+        }
+
+        void note(const Tone& tone, float weight = 1) {
+            const Tables& t = tables();
+            uint8_t pc = tone.tone();
+            float add = _inc * weight;
+            _sum2 += add * (2 * _hist[pc] + add);
+            _hist[pc] += add;
+            _sum += add;
+            for ( size_t c = 0; c < candidates; c++ )
+                _dots[c] += add * t.profiles[pc][c];
+            _inc /= _decay;
+            // Rescale before the weights of new notes overflow
+            if ( _inc > 1e6f )
+                rescale(1 / _inc);
+            publish();
+        }
+
+        void note(const Note& note, float weight = 1) {
+            this->note(note.tone(), weight);
+        }
+
+        /**
+         * The best candidates, best first, empty before the first note
+         */
+        Span<const Candidate> top() const {
+            return Span<const Candidate>(_top.data(), _top_count);
+        }
+
+        /**
+         * The best candidate. Before the first note, or after `reset`,
+         * an empty `Candidate`: the chromatic scale on C, scoring 0
+         */
+        const Candidate& best() const {
+            return _top[0];
+        }
+
+        /**
+         * Tones heard recently enough to count for the exact fit
+         */
+        PcSet present() const {
+            PcSet set;
+            // A note played now would add `_inc`
+            for ( uint8_t pc = 0; pc < 12; pc++ )
+                if ( _hist[pc] >= _presence * _inc * _decay )
+                    set = set.with(pc);
+            return set;
+        }
+
+        /**
+         * Share of the histogram held by the tone, between 0 and 1
+         */
+        float weight(const Tone& tone) const {
+            return _sum > 0 ? _hist[tone.tone()] / _sum : 0;
+        }
+
+    private:
+        float _decay;
+        float _presence;
+        float _inc;
+        std::array<float, 12> _hist;
+        float _sum;
+        float _sum2;
+        std::array<float, candidates> _dots;
+        std::array<Candidate, top_size> _top;
+        size_t _top_count;
+
+        /**
+         * Profile of each candidate, centred and of unit length, so the
+         * dot product with any histogram is its correlation times the
+         * histogram's own spread
+         */
+        struct Tables {
+            std::array<std::array<float, candidates>, 12> profiles;
+            std::array<Scale, candidates> scales;
+        };
+
+        static const Tables& tables() {
+            static const Tables t = build();
+            return t;
+        }
+
+        static Tables build() {
+            // Krumhansl & Kessler's probe tone ratings, for major and minor keys
+            static constexpr float major[12] = {6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f,
+                                                2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f};
+            static constexpr float minor[12] = {6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f,
+                                                2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f};
+            static constexpr Scale (*factories[modes])(const Tone&) = {
+                Scale::ionian, Scale::dorian, Scale::phrygian, Scale::lydian,
+                Scale::mixolydian, Scale::aeolian, Scale::locrian};
+
+            Tables t{};
+            for ( size_t m = 0; m < modes; m++ ) {
+                // Other modes have no published ratings, so weigh their tonic,
+                // 5th and 3rd degrees like the major and minor profiles do
+                Scale mode = factories[m](Tone(0));
+                std::array<float, 12> p;
+                for ( uint8_t i = 0; i < 12; i++ )
+                    p[i] = mode.contains(Tone(i)) ? 3.5f : 2.4f;
+                p[0] = 6.3f;
+                p[mode[4].tone()] = 4.8f;
+                p[mode[2].tone()] = 4.3f;
+                if ( m == 0 )
+                    std::copy(major, major + 12, p.begin());
+                if ( m == 5 )
+                    std::copy(minor, minor + 12, p.begin());
+
+                float mean = 0, norm = 0;
+                for ( auto v: p )
+                    mean += v / 12;
+                for ( auto v: p )
+                    norm += (v - mean) * (v - mean);
+                norm = std::sqrt(norm);
+                for ( uint8_t root = 0; root < 12; root++ ) {
+                    size_t c = m * 12 + root;
+                    t.scales[c] = factories[m](Tone(root));
+                    for ( uint8_t i = 0; i < 12; i++ )
+                        t.profiles[(root + i) % 12][c] = (p[i] - mean) / norm;
+                }
+            }
+            return t;
+        }
+
+        void rescale(float factor) {
+            for ( auto& h: _hist )
+                h *= factor;
+            for ( auto& d: _dots )
+                d *= factor;
+            _sum *= factor;
+            _sum2 *= factor * factor;
+            _inc *= factor;
+        }
+
+        /**
+         * Score every candidate and keep the best few
+         */
+        void publish() {
+            const Tables& t = tables();
+            float spread = std::sqrt(std::max(_sum2 - _sum * _sum / 12, 0.0f));
+            PcSet heard = present();
+            _top_count = 0;
+            for ( size_t c = 0; c < candidates; c++ ) {
+                Candidate cand{t.scales[c], 0, spread > 0 ? _dots[c] / spread : 0, heard.subset_of(t.scales[c].pcset())};
+                cand.score = cand.correlation + (cand.fits ? fit_bonus : 0);
+                if ( _top_count == top_size && cand.score <= _top[top_size - 1].score )
+                    continue;
+                size_t i = _top_count < top_size ? _top_count++ : top_size - 1;
+                for ( ; i > 0 && _top[i - 1].score < cand.score; i-- )
+                    _top[i] = _top[i - 1];
+                _top[i] = cand;
+            }
+        }
+};
+
+#endif // SCALETRACKER_HPP_
@@ -0,0 +1,23 @@
+#ifndef SIMD_HPP_
+#define SIMD_HPP_
+
+/**
+ * Which vector instructions the build targets, for the headers with
+ * vectorized paths, eg. `BulkNotes` and `Fingering`.
+ *
+ * Defines `SUPERFRET_SSE2` on x86-64, where SSE2 is always there, and
+ * `SUPERFRET_AVX2` when the compiler targets AVX2 (the `SUPERFRET_AVX2`
+ * CMake option), each with its intrinsics header.
+ */
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SUPERFRET_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SUPERFRET_SSE2
+#endif
+
+#endif // SIMD_HPP_
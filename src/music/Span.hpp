@@ -0,0 +1,61 @@
+#ifndef SPAN_HPP_
+#define SPAN_HPP_
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Non-owning view over contiguous elements, standing in for C++20's
+ * `std::span` while the project targets C++17.
+ *
+ * Can be made from any container with `data()` and `size()`, such as
+ * `std::vector` and `std::array`, or from a C array.
+ */
+template <class T>
+class Span {
+    private:
+        T* _data;
+        size_t _size;
+
+    public:
+        constexpr Span(): _data(nullptr), _size(0) { }
+        constexpr Span(T* data, size_t size): _data(data), _size(size) { }
+
+        template <size_t N>
+        constexpr Span(T (&array)[N]): _data(array), _size(N) { }
+
+        template <class C, class = std::enable_if_t<
+            std::is_convertible<decltype(std::declval<C&>().data()), T*>::value>>
+        constexpr Span(C&& container): _data(container.data()), _size(container.size()) { }
+
+        constexpr T* data() const {
+            return _data;
+        }
+
+        constexpr size_t size() const {
+            return _size;
+        }
+
+        constexpr bool empty() const {
+            return _size == 0;
+        }
+
+        constexpr T* begin() const {
+            return _data;
+        }
+
+        constexpr T* end() const {
+            return _data + _size;
+        }
+
+        constexpr T& operator[](size_t i) const {
+            return _data[i];
+        }
+
+        constexpr Span subspan(size_t offset, size_t count) const {
+            return Span(_data + offset, count);
+        }
+};
+
+#endif // SPAN_HPP_
@@ -3,8 +3,9 @@
 
 #include <array>
 #include <string>
+#include <string_view>
 #include <cstdint>
-#include <algorithm>
+#include <stdexcept>
 #include <iostream>
 /**
  * In music, a "Tone" can refer to a note such as "C" independent of
@@ -23,23 +24,34 @@ class Tone {
 
         /**
          * Returns 12 if not found
+         * Accepts the names in `tones`, as well as flats such as "Bb"
          */
-        static uint8_t toneof(const std::string& tone) {
-            auto it = std::find(Tone::tones.begin(), Tone::tones.end(), tone);
-            return std::distance(Tone::tones.begin(), it);
+        static constexpr uint8_t toneof(std::string_view tone) {
+            for ( uint8_t i = 0; i < tones.size(); i++ )
+                if ( tone == tones[i] )
+                    return i;
+            if ( tone.size() == 2 && tone[1] == 'b' ) {
+                uint8_t natural = toneof(tone.substr(0, 1));
+                if ( natural < 12 )
+                    return (natural + 11) % 12;
+            }
+            return 12;
         }
 
         static std::string nameof(uint8_t tone) {
             return tones[tone % 12];
         }
 
-        Tone(): _tone(0) { }
-        Tone(int tone): _tone(uint8_t(tone % 12)) { }
-        Tone(uint8_t tone): _tone(tone % 12) { }
-        Tone(const char* tone): _tone(toneof(tone)) { }
+        /// Longest name in `tones`
+        static constexpr size_t max_name = 2;
+
+        constexpr Tone(): _tone(0) { }
+        constexpr Tone(int tone): _tone(uint8_t(tone % 12)) { }
+        constexpr Tone(uint8_t tone): _tone(tone % 12) { }
+        constexpr Tone(const char* tone): _tone(toneof(tone)) { }
         Tone(const std::string& tone): _tone(toneof(tone)) { } 
 
-        Tone& operator=(uint8_t tone) {
+        constexpr Tone& operator=(uint8_t tone) {
             _tone = tone % 12;
             return *this;
         }
@@ -49,12 +61,12 @@ class Tone {
             return *this;
         }
 
-        Tone& operator=(const char* tone) {
+        constexpr Tone& operator=(const char* tone) {
             _tone = toneof(tone);
             return *this;
         }
 
-        uint8_t tone() const {
+        constexpr uint8_t tone() const {
             return _tone;
         }
 
@@ -62,31 +74,43 @@ class Tone {
             return nameof(_tone);
         }
 
+        /**
+         * Write the name into out, without allocating or a terminating
+         * null, and return its length (at most `max_name`)
+         */
+        constexpr size_t format(char* out) const {
+            size_t n = 0;
+            // Unknown names keep 12, read as "C" the same as `nameof`
+            for ( const char* c = tones[_tone % 12]; *c; c++ )
+                out[n++] = *c;
+            return n;
+        }
+
         /**
          * MIDI supports octaves "-1" through "9", however implementing
          * starting at 0 is easier. If octave is too high (eg. 11),
          * will cycle values.
          */
-        uint8_t midi(uint8_t octave) const {
+        constexpr uint8_t midi(uint8_t octave) const {
             return (_tone + octave * 12) % 0x80;
         }
 
-        Tone& operator+=(uint8_t interval) { 
+        constexpr Tone& operator+=(uint8_t interval) { 
             _tone += interval; _tone %= 12;
             return *this;
         }
         
-        Tone operator+(uint8_t interval) const {
+        constexpr Tone operator+(uint8_t interval) const {
             return Tone(_tone + interval);
         }
 
-        Tone& operator-=(uint8_t interval) { 
+        constexpr Tone& operator-=(uint8_t interval) { 
             if (interval > _tone) _tone += 12;
             _tone -= interval;
             return *this;
         }
         
-        Tone operator-(uint8_t interval) const {
+        constexpr Tone operator-(uint8_t interval) const {
             Tone tone(_tone);
             tone -= interval;
             return tone;
@@ -97,35 +121,35 @@ class Tone {
          * eg. Tone("C") - Tone("B") := 1 (1 step from "B" to "C")
          * eg. Tone("B") - Tone("C") := 11 (11 steps from "C" up to "B")
          */
-        uint8_t operator-(const Tone& other) const {
+        constexpr uint8_t operator-(const Tone& other) const {
             return ((12 + _tone ) - other._tone) % 12;
         }
 
-        bool operator==(const Tone& other) const {
+        constexpr bool operator==(const Tone& other) const {
             return _tone == other._tone;
         }
 
-        bool operator!=(const Tone& other) const {
+        constexpr bool operator!=(const Tone& other) const {
             return _tone != other._tone;
         }
 
         // For internal use
-        bool operator<(const Tone& other) const {
+        constexpr bool operator<(const Tone& other) const {
             return _tone < other._tone;
         }
 
         // For internal use
-        bool operator>(const Tone& other) const {
+        constexpr bool operator>(const Tone& other) const {
             return _tone > other._tone;
         }
 
         // For internal use
-        bool operator<=(const Tone& other) const {
+        constexpr bool operator<=(const Tone& other) const {
             return _tone <= other._tone;
         }
 
         // For internal use
-        bool operator>=(const Tone& other) const {
+        constexpr bool operator>=(const Tone& other) const {
             return _tone >= other._tone;
         }
 
@@ -135,4 +159,15 @@ class Tone {
         }
 };
 
+/**
+ * Tone literal, checked at compile time when used as a constant
+ * eg. `constexpr Tone t = "C#"_tone;`
+ */
+constexpr Tone operator""_tone(const char* name, size_t size) {
+    uint8_t tone = Tone::toneof(std::string_view(name, size));
+    if ( tone >= 12 )
+        throw std::invalid_argument("Unknown tone");
+    return Tone(tone);
+}
+
 #endif // TONE_HPP_
\ No newline at end of file
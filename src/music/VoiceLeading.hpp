@@ -0,0 +1,223 @@
+#ifndef VOICELEADING_HPP_
+#define VOICELEADING_HPP_
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include "Note.hpp"
+#include "Chord.hpp"
+#include "Fretboard.hpp"
+#include "Voicing.hpp"
+#include "Span.hpp"
+
+/**
+ * Picks one voicing for each chord of a progression so the hand (or
+ * the voices) move as little as possible overall.
+ *
+ * Each step of the progression is a list of candidate voicings. The
+ * choice is exact, by dynamic programming: the cheapest way to reach
+ * every candidate of a chord is worked out from the cheapest ways to
+ * reach the previous chord's candidates. Candidates are first packed
+ * into flat arrays of fixed-size rows, and only two rows of costs plus
+ * one back-pointer per candidate are kept, so a 100 chord progression
+ * with dozens of candidates each takes a few hundred microseconds.
+ *
+ * eg.
+ * VoicingGenerator gen;
+ * auto shapes = VoiceLeading::voice(gen, guitar, progression);
+ */
+class VoiceLeading {
+    public:
+        struct Result {
+            /// Index of the chosen candidate at each step
+            std::vector<uint16_t> choice;
+            /// Sum of the distances between consecutive choices
+            uint32_t cost = 0;
+        };
+
+        /**
+         * Hand movement between two shapes: 2 per fret the hand's
+         * position (lowest held fret) shifts, plus 1 per string whose
+         * fret changes or which starts or stops sounding
+         */
+        static uint32_t distance(const Voicing& a, const Voicing& b) {
+            return distance(Shape(a), Shape(b));
+        }
+
+        /**
+         * Voice movement between two chords, in semitones: the notes are
+         * paired lowest to highest if both have as many notes, otherwise
+         * each note moves to the nearest note of the other chord
+         */
+        static uint32_t distance(const Chord& a, const Chord& b) {
+            return distance(Voices(a), Voices(b));
+        }
+
+        /**
+         * Throws std::invalid_argument if a step has no candidates
+         */
+        static Result optimize(const std::vector<std::vector<Voicing>>& candidates) {
+            return solve<Shape>(candidates);
+        }
+
+        static Result optimize(const std::vector<std::vector<Chord>>& candidates) {
+            return solve<Voices>(candidates);
+        }
+
+        /**
+         * Shapes for a progression on a fretboard, one per chord, from
+         * the generator's voicings of each chord
+         * Throws std::invalid_argument if a chord has no voicing
+         */
+        static std::vector<Voicing> voice(VoicingGenerator& gen, const Fretboard& board, Span<const Chord> progression,
+                                          Result* result = nullptr) {
+            // The generator's own lists, held while solving over views of them
+            std::vector<VoicingGenerator::Voicings> lists;
+            std::vector<Span<const Voicing>> candidates;
+            lists.reserve(progression.size());
+            candidates.reserve(progression.size());
+            for ( size_t i = 0; i < progression.size(); i++ ) {
+                lists.push_back(gen.voicings(board, progression[i]));
+                if ( lists.back()->empty() )
+                    throw std::invalid_argument("VoiceLeading::voice: No voicing for chord " + std::to_string(i));
+                candidates.emplace_back(*lists.back());
+            }
+            Result r = solve<Shape>(candidates);
+            std::vector<Voicing> shapes;
+            for ( size_t i = 0; i < candidates.size(); i++ )
+                shapes.push_back(candidates[i][r.choice[i]]);
+            if ( result )
+                *result = std::move(r);
+            return shapes;
+        }
+
+    private:
+        /**
+         * A voicing packed for fast comparison, with a byte per string in
+         * two words so frets are compared 8 strings at a time
+         */
+        struct Shape {
+            std::array<uint64_t, 2> frets;
+            int32_t lowest;
+
+            Shape() = default;
+            explicit Shape(const Voicing& v): frets{}, lowest(v.lowest()) {
+                static_assert(Fretboard::max_strings <= sizeof(frets), "a byte per string");
+                std::array<int8_t, sizeof(frets)> bytes;
+                bytes.fill(Voicing::muted);
+                std::copy(v.frets.begin(), v.frets.begin() + v.strings, bytes.begin());
+                std::memcpy(frets.data(), bytes.data(), sizeof(frets));
+            }
+        };
+
+        /// Number of bytes that differ between two words
+        static uint32_t changed(uint64_t a, uint64_t b) {
+            constexpr uint64_t low7 = 0x7F7F7F7F7F7F7F7Full;
+            uint64_t x = a ^ b;
+            // The high bit of each byte is set if any of its bits is
+            uint64_t any = (((x & low7) + low7) | x) & ~low7;
+            // Add up the flags into the top byte
+            return uint32_t(((any >> 7) * 0x0101010101010101ull) >> 56);
+        }
+
+        static uint32_t distance(const Shape& a, const Shape& b) {
+            uint32_t changes = changed(a.frets[0], b.frets[0]) + changed(a.frets[1], b.frets[1]);
+            uint32_t shift = a.lowest && b.lowest ? uint32_t(std::abs(a.lowest - b.lowest)) : 0;
+            return 2 * shift + changes;
+        }
+
+        /// A chord's notes, sorted
+        struct Voices {
+            std::array<uint8_t, Chord::capacity> notes;
+            uint8_t size;
+
+            Voices() = default;
+            explicit Voices(const Chord& c): notes{}, size(uint8_t(c.size())) {
+                for ( size_t i = 0; i < size; i++ )
+                    notes[i] = c[i].note();
+                std::sort(notes.begin(), notes.begin() + size);
+            }
+
+            uint32_t nearest(uint8_t note) const {
+                uint32_t best = 0x7F;
+                for ( size_t i = 0; i < size; i++ )
+                    best = std::min<uint32_t>(best, uint32_t(std::abs(notes[i] - note)));
+                return best;
+            }
+        };
+
+        static uint32_t distance(const Voices& a, const Voices& b) {
+            uint32_t d = 0;
+            if ( a.size == b.size ) {
+                for ( size_t i = 0; i < a.size; i++ )
+                    d += uint32_t(std::abs(a.notes[i] - b.notes[i]));
+                return d;
+            }
+            for ( size_t i = 0; i < a.size; i++ )
+                d += b.nearest(a.notes[i]);
+            for ( size_t i = 0; i < b.size; i++ )
+                d += a.nearest(b.notes[i]);
+            return d;
+        }
+
+        /// candidates is a list of steps, each a list of candidates
+        template <class Packed, class Steps>
+        static Result solve(const Steps& candidates) {
+            Result r;
+            if ( candidates.empty() )
+                return r;
+            for ( auto& step: candidates )
+                if ( step.empty() || step.size() > UINT16_MAX )
+                    throw std::invalid_argument("VoiceLeading::optimize: Each chord needs 1 to 65535 candidates");
+
+            // Every candidate packed into one array, step after step
+            std::vector<size_t> start(candidates.size() + 1, 0);
+            for ( size_t k = 0; k < candidates.size(); k++ )
+                start[k + 1] = start[k] + candidates[k].size();
+            std::vector<Packed> packed;
+            packed.reserve(start.back());
+            for ( auto& step: candidates )
+                for ( auto& c: step )
+                    packed.emplace_back(c);
+
+            std::vector<uint16_t> back(start.back(), 0);
+            std::vector<uint32_t> prev(candidates[0].size(), 0), cost;
+            for ( size_t k = 1; k < candidates.size(); k++ ) {
+                const Packed* from = &packed[start[k - 1]];
+                const Packed* to = &packed[start[k]];
+                size_t n = candidates[k].size(), m = candidates[k - 1].size();
+                cost.assign(n, UINT32_MAX);
+                for ( size_t j = 0; j < n; j++ ) {
+                    uint32_t best = UINT32_MAX;
+                    uint16_t arg = 0;
+                    for ( size_t i = 0; i < m; i++ ) {
+                        uint32_t c = prev[i] + distance(from[i], to[j]);
+                        bool better = c < best;
+                        best = better ? c : best;
+                        arg = better ? uint16_t(i) : arg;
+                    }
+                    cost[j] = best;
+                    back[start[k] + j] = arg;
+                }
+                std::swap(prev, cost);
+            }
+
+            // Walk back from the cheapest last candidate
+            r.choice.resize(candidates.size());
+            auto last = std::min_element(prev.begin(), prev.end());
+            r.cost = *last;
+            uint16_t j = uint16_t(last - prev.begin());
+            for ( size_t k = candidates.size(); k-- > 0; ) {
+                r.choice[k] = j;
+                j = back[start[k] + j];
+            }
+            return r;
+        }
+};
+
+#endif // VOICELEADING_HPP_
@@ -0,0 +1,370 @@
+#ifndef VOICING_HPP_
+#define VOICING_HPP_
+
+#include <array>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "Tone.hpp"
+#include "Note.hpp"
+#include "PcSet.hpp"
+#include "Chord.hpp"
+#include "Fretboard.hpp"
+
+/**
+ * One way of fingering a chord on a fretboard: a fret, or muted, for
+ * each string
+ */
+struct Voicing {
+    static constexpr int8_t muted = -1;
+
+    /// Fret of each string from the lowest, or `muted`
+    std::array<int8_t, Fretboard::max_strings> frets;
+    uint8_t strings;
+    /// Lower is easier, see `VoicingGenerator`
+    uint16_t difficulty;
+
+    /// Lowest fret held down, or 0 if every string is open or muted
+    uint8_t lowest() const {
+        uint8_t low = 0;
+        for ( size_t s = 0; s < strings; s++ )
+            if ( frets[s] > 0 && (low == 0 || frets[s] < low) )
+                low = uint8_t(frets[s]);
+        return low;
+    }
+
+    /// Highest fret held down
+    uint8_t highest() const {
+        int8_t high = 0;
+        for ( size_t s = 0; s < strings; s++ )
+            high = std::max(high, frets[s]);
+        return uint8_t(high);
+    }
+
+    /**
+     * The notes sounded, from the lowest string
+     */
+    Chord chord(const Fretboard& board) const {
+        std::array<Note, Fretboard::max_strings> notes;
+        size_t n = 0;
+        for ( uint8_t s = 0; s < strings; s++ )
+            if ( frets[s] != muted )
+                notes[n++] = board.note(s, uint8_t(frets[s]));
+        return Chord(Span<const Note>(notes.data(), n));
+    }
+
+    /**
+     * In tablature order from the lowest string, eg. "x32010", with
+     * frets above 9 in brackets, eg. "(10)"
+     */
+    std::string tab() const {
+        std::string t;
+        for ( size_t s = 0; s < strings; s++ ) {
+            if ( frets[s] == muted )
+                t += 'x';
+            else if ( frets[s] > 9 )
+                t += "(" + std::to_string(frets[s]) + ")";
+            else
+                t += char('0' + frets[s]);
+        }
+        return t;
+    }
+
+    bool operator==(const Voicing& other) const {
+        return strings == other.strings && std::equal(frets.begin(), frets.begin() + strings, other.frets.begin());
+    }
+
+    bool operator!=(const Voicing& other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * Lists the playable voicings of chords on a fretboard, easiest first.
+ *
+ * Voicings play at most one note per string, only tones of the chord,
+ * and every tone of the chord (the perfect 5th may be left out). Held
+ * frets must fit within a hand span and the number of fingers, counting
+ * notes on the lowest fret as one barre.
+ *
+ * The search walks the strings from the lowest for each hand position
+ * up the neck, in parallel, and cuts a branch as soon as it can no
+ * longer cover the chord, breaks a rule, or is already harder than the
+ * easiest voicings found. Results are cached by chord and tuning, so
+ * asking again is a map lookup.
+ *
+ * Difficulty is 2 per finger, 3 per fret of stretch, 1 per 2 frets up
+ * the neck (twice that when open strings ring with held frets), 3 per
+ * muted string, 2 for an omitted 5th and 3 for a bass note other than
+ * the root.
+ *
+ * eg.
+ * VoicingGenerator gen;
+ * auto c = gen.voicings(Fretboard::guitar(), Chord::major_triad(48));
+ * (*c)[0].tab() := "x32010"
+ */
+class VoicingGenerator {
+    public:
+        struct Options {
+            /// Most frets between the lowest and highest held fret, plus one
+            uint8_t max_span = 4;
+            /// Highest fret used
+            uint8_t max_fret = 15;
+            uint8_t min_notes = 3;
+            uint8_t fingers = 4;
+            /// Allow leaving out the perfect 5th of chords of 4 tones or more
+            bool omit_fifth = true;
+            /// Require the root as the lowest note
+            bool root_in_bass = true;
+            /// Allow muted strings between sounding strings
+            bool inner_mutes = false;
+            /// Most voicings kept per chord
+            size_t limit = 64;
+            /// Threads to search with, 0 for one per core
+            unsigned threads = 0;
+        };
+
+        using Voicings = std::shared_ptr<const std::vector<Voicing>>;
+
+        VoicingGenerator() { }
+        explicit VoicingGenerator(Options options): _options(options) { }
+
+        /**
+         * Voicings of the chord, rooted on its first note, easiest first
+         */
+        Voicings voicings(const Fretboard& board, const Chord& chord) {
+            if ( chord.size() == 0 )
+                return std::make_shared<const std::vector<Voicing>>();
+            return voicings(board, chord.pcset(), chord[0].tone());
+        }
+
+        Voicings voicings(const Fretboard& board, PcSet set, Tone root) {
+            Key key{set.bits(), root.tone(), uint8_t(board.strings()), board.frets(), board.capo(), {}};
+            for ( size_t s = 0; s < board.strings(); s++ )
+                key.tuning[s] = board.tuning(s).note();
+            {
+                std::lock_guard<std::mutex> lock(_mtx);
+                auto it = _cache.find(key);
+                if ( it != _cache.end() )
+                    return it->second;
+            }
+            Voicings found = std::make_shared<const std::vector<Voicing>>(search(board, set, root, _options));
+            std::lock_guard<std::mutex> lock(_mtx);
+            return _cache.emplace(key, std::move(found)).first->second;
+        }
+
+        /// Number of chords cached
+        size_t cached() const {
+            std::lock_guard<std::mutex> lock(_mtx);
+            return _cache.size();
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _cache.clear();
+        }
+
+        /**
+         * Search without the cache
+         */
+        static std::vector<Voicing> search(const Fretboard& board, PcSet set, Tone root, const Options& options) {
+            set = set.with(root.tone());
+            uint8_t top = std::min(options.max_fret, board.playable());
+            unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+            threads = std::min<unsigned>(threads, top);
+
+            // Each thread takes every n-th hand position, which spreads the
+            // cheap positions up the neck between them
+            std::vector<std::vector<Voicing>> found(std::max(threads, 1u));
+            auto work = [&](unsigned t) {
+                Search s(board, set, root, options);
+                for ( uint8_t w = uint8_t(1 + t); w <= std::max<uint8_t>(top, 1); w = uint8_t(w + threads) )
+                    s.run(w);
+                found[t] = std::move(s.best);
+            };
+            if ( threads <= 1 ) {
+                threads = 1;
+                work(0);
+            } else {
+                std::vector<std::thread> pool;
+                for ( unsigned t = 0; t < threads; t++ )
+                    pool.emplace_back(work, t);
+                for ( auto& th: pool )
+                    th.join();
+            }
+
+            std::vector<Voicing> all;
+            for ( auto& f: found )
+                all.insert(all.end(), f.begin(), f.end());
+            std::sort(all.begin(), all.end(), easier);
+            if ( all.size() > options.limit )
+                all.resize(options.limit);
+            return all;
+        }
+
+    private:
+        struct Key {
+            uint16_t set;
+            uint8_t root;
+            uint8_t strings;
+            uint8_t frets;
+            uint8_t capo;
+            std::array<uint8_t, Fretboard::max_strings> tuning;
+
+            bool operator<(const Key& o) const {
+                return std::tie(set, root, strings, frets, capo, tuning)
+                     < std::tie(o.set, o.root, o.strings, o.frets, o.capo, o.tuning);
+            }
+        };
+
+        static bool easier(const Voicing& a, const Voicing& b) {
+            if ( a.difficulty != b.difficulty )
+                return a.difficulty < b.difficulty;
+            return std::lexicographical_compare(a.frets.begin(), a.frets.begin() + a.strings,
+                                                b.frets.begin(), b.frets.begin() + b.strings);
+        }
+
+        /**
+         * Depth-first search over the strings for one hand position at a
+         * time, keeping the `limit` easiest voicings
+         */
+        struct Search {
+            const Fretboard& board;
+            const Options& options;
+            PcSet chord;
+            /// Tones every voicing must have
+            PcSet required;
+            uint8_t root;
+            uint8_t fifth;
+            std::vector<Voicing> best;
+
+            // State of the current branch
+            uint8_t w = 0;
+            uint32_t window = 0;
+            Voicing v{};
+            PcSet covered;
+            uint8_t played = 0;
+            uint8_t at_window = 0;
+            uint8_t above_window = 0;
+            uint8_t high = 0;
+            uint8_t mutes = 0;
+            uint8_t open = 0;
+            bool closed = false;
+            int8_t bass = -1;
+
+            Search(const Fretboard& b, PcSet set, Tone r, const Options& o)
+                : board(b), options(o), chord(set), required(set), root(r.tone()), fifth((r + 7).tone()) {
+                if ( options.omit_fifth && set.size() >= 4 )
+                    required = required.without(fifth);
+                v.strings = uint8_t(board.strings());
+                best.reserve(options.limit + 1);
+            }
+
+            void run(uint8_t start) {
+                w = start;
+                uint8_t last = std::min<int>(w + options.max_span - 1, std::min(options.max_fret, board.playable()));
+                window = last >= w ? uint32_t((2u << last) - (1u << w)) : 0;
+                window |= 1;
+                step(0);
+            }
+
+            int cost() const {
+                uint8_t fingers = above_window + (at_window ? 1 : 0);
+                int position = at_window ? (open ? 2 : 1) * (w / 2) : 0;
+                return 2 * fingers + 3 * (high > w ? high - w : 0) + position + 3 * mutes;
+            }
+
+            bool full() const {
+                return best.size() >= options.limit;
+            }
+
+            void step(uint8_t s) {
+                if ( full() && cost() > best.back().difficulty )
+                    return;
+                if ( (required - covered).size() > v.strings - s )
+                    return;
+                if ( s == v.strings ) {
+                    finish();
+                    return;
+                }
+
+                // Muted
+                v.frets[s] = Voicing::muted;
+                bool was_closed = closed;
+                closed = closed || (played && !options.inner_mutes);
+                mutes++;
+                step(uint8_t(s + 1));
+                mutes--;
+                closed = was_closed;
+                if ( closed )
+                    return;
+
+                PcSet allowed = chord;
+                if ( !played && options.root_in_bass )
+                    allowed = PcSet().with(root);
+                for ( uint32_t frets = board.frets(s, allowed) & window; frets; frets &= frets - 1 ) {
+                    uint8_t f = 0;
+                    while ( !(frets >> f & 1) )
+                        f++;
+                    play(s, f);
+                }
+            }
+
+            void play(uint8_t s, uint8_t f) {
+                uint8_t tone = board.note(s, f).tone().tone();
+                uint8_t fingers = above_window + (f > w) + (at_window || f == w ? 1 : 0);
+                if ( fingers > options.fingers )
+                    return;
+                PcSet was = covered;
+                uint8_t was_high = high;
+                int8_t was_bass = bass;
+                v.frets[s] = int8_t(f);
+                covered = covered.with(tone);
+                played++;
+                open += f == 0;
+                at_window += f == w;
+                above_window += f > w;
+                high = std::max(high, f);
+                if ( bass < 0 )
+                    bass = int8_t(tone);
+                step(uint8_t(s + 1));
+                bass = was_bass;
+                high = was_high;
+                above_window -= f > w;
+                at_window -= f == w;
+                open -= f == 0;
+                played--;
+                covered = was;
+            }
+
+            void finish() {
+                if ( played < options.min_notes || !required.subset_of(covered) )
+                    return;
+                // Found from the position of its lowest held fret only, or
+                // from the first position if it is all open strings
+                if ( at_window == 0 && (above_window > 0 || w != 1) )
+                    return;
+                Voicing found = v;
+                found.difficulty = uint16_t(cost() + (covered.contains(fifth) || !chord.contains(fifth) ? 0 : 2)
+                                            + (bass == root ? 0 : 3));
+                if ( full() && !easier(found, best.back()) )
+                    return;
+                best.insert(std::upper_bound(best.begin(), best.end(), found, easier), found);
+                if ( best.size() > options.limit )
+                    best.pop_back();
+            }
+        };
+
+        Options _options;
+        mutable std::mutex _mtx;
+        std::map<Key, Voicings> _cache;
+};
+
+#endif // VOICING_HPP_
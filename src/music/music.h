@@ -2,8 +2,17 @@
 #define MUSIC_H_
 
 #include "Tone.hpp"
+#include "PcSet.hpp"
 #include "Note.hpp"
 #include "Chord.hpp"
 #include "Scale.hpp"
+#include "PcCatalog.hpp"
+#include "ScaleTracker.hpp"
+#include "Fretboard.hpp"
+#include "FretboardView.hpp"
+#include "Voicing.hpp"
+#include "VoiceLeading.hpp"
+#include "Fingering.hpp"
+#include "BulkNotes.hpp"
 
 #endif // MUSIC_H_
\ No newline at end of file
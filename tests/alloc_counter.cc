@@ -0,0 +1,93 @@
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include "alloc_counter.hpp"
+
+std::atomic<size_t> allocations{0};
+
+// Kept in their own translation unit, so the compiler cannot see a
+// new paired with a free and warn about the mismatch
+
+/** === Allocation === */
+static void* counted(size_t size) noexcept {
+    allocations++;
+    return std::malloc(size ? size : 1);
+}
+
+static void* counted(size_t size, std::align_val_t align) noexcept {
+    allocations++;
+    size_t a = size_t(align);
+    // aligned_alloc wants a multiple of the alignment
+    size = (size + a - 1) / a * a;
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : a, a);
+#else
+    return std::aligned_alloc(a, size ? size : a);
+#endif
+}
+
+static void release(void* p, std::align_val_t) noexcept {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(size_t size) {
+    if ( void* p = counted(size) )
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    if ( void* p = counted(size) )
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    if ( void* p = counted(size, align) )
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+    if ( void* p = counted(size, align) )
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return counted(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return counted(size);
+}
+
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted(size, align);
+}
+
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted(size, align);
+}
+
+/** === Deallocation === */
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void operator delete(void* p, std::align_val_t align) noexcept { release(p, align); }
+void operator delete[](void* p, std::align_val_t align) noexcept { release(p, align); }
+void operator delete(void* p, size_t, std::align_val_t align) noexcept { release(p, align); }
+void operator delete[](void* p, size_t, std::align_val_t align) noexcept { release(p, align); }
+void operator delete(void* p, std::align_val_t align, const std::nothrow_t&) noexcept { release(p, align); }
+void operator delete[](void* p, std::align_val_t align, const std::nothrow_t&) noexcept { release(p, align); }
@@ -0,0 +1,12 @@
+#ifndef ALLOC_COUNTER_HPP_
+#define ALLOC_COUNTER_HPP_
+
+#include <atomic>
+#include <cstddef>
+
+// Every allocation in the test program is counted, by the replacements
+// of operator new in alloc_counter.cc, for the tests of code that must
+// not allocate
+extern std::atomic<size_t> allocations;
+
+#endif // ALLOC_COUNTER_HPP_
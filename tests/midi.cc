@@ -1,16 +1,20 @@
 #include <gtest/gtest.h>
 #include "midi.h"
+#include "SpscRing.hpp"
+#include "MidiPipeline.hpp"
 
-#ifndef _WIN32
-    #error "Built for Windows"
-#endif 
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
+#ifdef _WIN32
 TEST(MidiOutTest, windows_std_out) {
     MidiOut out(0);
     EXPECT_TRUE(out.connected());
     EXPECT_THROW(MidiOut(0), MidiAllocated);
     EXPECT_THROW(MidiOut(MidiOut::count()), MidiNotFound);
 }
+#endif
 
 TEST(MidiOutTest, unallocated) {
     MidiOut out;
@@ -20,4 +24,701 @@ TEST(MidiOutTest, unallocated) {
     EXPECT_THROW(out.channel_mask(), MidiUnconnected);
     EXPECT_THROW(out << 0, MidiUnconnected);
     EXPECT_THROW(out >> 0, MidiUnconnected);
-}
\ No newline at end of file
+}
+
+TEST(MidiOutTest, memory_sink_out) {
+    auto sink = std::make_shared<MidiMemorySink>(2);
+    MidiOut out(1, sink);
+    EXPECT_TRUE(out.connected());
+    EXPECT_FALSE(out.external());
+    EXPECT_EQ(out.name(), "Superfret Memory Sink 1");
+    EXPECT_THROW(MidiOut(1, sink), MidiAllocated);
+    EXPECT_THROW(MidiOut(2, sink), MidiNotFound);
+
+    out << 60;
+    out >> std::make_pair(uint8_t(60), uint8_t(0));
+    EXPECT_EQ(sink->bytes(1), (std::vector<uint8_t>{0x90, 60, 120, 0x80, 60, 0}));
+    EXPECT_EQ(sink->sends(1), 2);
+    EXPECT_TRUE(sink->bytes(0).empty());
+}
+
+TEST(MidiOutTest, default_backend) {
+    auto sink = std::make_shared<MidiMemorySink>();
+    MidiOut::set_backend(sink);
+    EXPECT_EQ(MidiOut::count(), 1);
+    {
+        MidiOut out;
+        for ( auto info: MidiOut::discover() )
+            out = info;
+        EXPECT_TRUE(out.connected());
+        out << 64;
+    }
+    // Port is released once the connection is gone
+    EXPECT_NO_THROW(MidiOut(0));
+    EXPECT_EQ(sink->bytes(0), (std::vector<uint8_t>{0x90, 64, 120}));
+    MidiOut::set_backend(nullptr);
+}
+
+TEST(MidiOutTest, batched_send) {
+    auto sink = std::make_shared<MidiMemorySink>();
+    MidiOut out(0, sink);
+
+    auto batch = out.send({MidiMsg::note_on(60, 100), MidiMsg::note_on(64, 100, 1)});
+    EXPECT_EQ(batch.messages, 2);
+    EXPECT_EQ(batch.bytes, 6);
+    EXPECT_EQ(sink->sends(0), 1);
+
+    out << Chord::major_triad(60);
+    EXPECT_EQ(out.last_batch().messages, 3);
+    EXPECT_EQ(sink->sends(0), 2);
+    EXPECT_EQ(sink->records(0).back().bytes, (std::vector<uint8_t>{0x90, 60, 120, 64, 120, 67, 120}));
+
+    MidiOut unconnected;
+    EXPECT_THROW(unconnected.send({MidiMsg::note_off(60, 0)}), MidiUnconnected);
+    EXPECT_THROW(unconnected << Chord::minor_triad(60), MidiUnconnected);
+}
+
+TEST(MidiMsgTest, channel_voice) {
+    EXPECT_EQ(MidiMsg::note_on(60, 100, 9), (MidiMsg{0x99, 60, 100}));
+    EXPECT_EQ(MidiMsg::note_off(200, 200, 17).status, 0x81);
+    EXPECT_EQ(MidiMsg::note_off(200, 200).data0, 200 & 0x7F);
+    EXPECT_EQ(MidiMsg::control_change(MidiMsg::Sustain, 127, 2).type(), MidiMsg::ControlChange);
+    EXPECT_EQ(MidiMsg::program_change(24, 3).size(), 2);
+    EXPECT_EQ(MidiMsg::channel_pressure(64).size(), 2);
+    EXPECT_EQ(MidiMsg::poly_pressure(60, 64, 15).channel(), 15);
+    EXPECT_EQ(MidiMsg::pitch_bend(0), (MidiMsg{0xE0, 0x00, 0x40}));
+    EXPECT_EQ(MidiMsg::pitch_bend(-8192).bend(), -8192);
+    EXPECT_EQ(MidiMsg::pitch_bend(8191).bend(), 8191);
+}
+
+TEST(MidiMsgTest, running_status) {
+    const MidiMsg msgs[] = {
+        MidiMsg::control_change(1, 0), MidiMsg::control_change(1, 1), MidiMsg::control_change(1, 2),
+        MidiMsg{0xF8},                 // Real-time keeps running status
+        MidiMsg::control_change(1, 3),
+        MidiMsg::program_change(5),
+        MidiMsg{0xF3, 1},              // System common cancels it
+        MidiMsg::program_change(5)
+    };
+    uint8_t buffer[MidiEncoder::max_size(8)];
+    MidiEncoder enc;
+    size_t n = enc.encode(msgs, 8, buffer);
+    EXPECT_EQ(std::vector<uint8_t>(buffer, buffer + n), (std::vector<uint8_t>{
+        0xB0, 1, 0, 1, 1, 1, 2, 0xF8, 1, 3, 0xC0, 5, 0xF3, 1, 0xC0, 5
+    }));
+
+    MidiEncoder full(false);
+    EXPECT_EQ(full.encode(msgs, 3, buffer), 9);
+
+    // An empty status is not taken for the running one
+    MidiEncoder fresh;
+    EXPECT_EQ(fresh.encode(MidiMsg{}, buffer), 3);
+    EXPECT_EQ(fresh.encode(MidiMsg{}, buffer), 3);
+}
+
+TEST(MidiOutTest, channel_and_velocity) {
+    auto sink = std::make_shared<MidiMemorySink>(1, false);
+    MidiOut out(0, sink);
+    out.set_velocity(80).set_channel(3) << 60;
+    out >> 60;
+    out << MidiMsg::pitch_bend(0, 15);
+    EXPECT_EQ(sink->bytes(0), (std::vector<uint8_t>{0x93, 60, 80, 0x83, 60, 80, 0xEF, 0, 0x40}));
+}
+
+TEST(MidiSchedulerTest, sends_in_time_order) {
+    using namespace std::chrono;
+    auto sink = std::make_shared<MidiMemorySink>();
+    MidiScheduler sched(MidiOut(0, sink), 16);
+
+    auto t0 = MidiScheduler::Clock::now() + milliseconds(5);
+    // Scheduled out of order, same-time events keep their order
+    EXPECT_TRUE(sched.schedule(t0 + milliseconds(4), MidiMsg::note_off(60, 0)));
+    EXPECT_TRUE(sched.schedule(t0, MidiMsg::note_on(60, 100)));
+    EXPECT_TRUE(sched.schedule(t0, MidiMsg::note_on(64, 100)));
+    sched.wait();
+
+    auto records = sink->records(0);
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[0].bytes, (std::vector<uint8_t>{0x90, 60, 100, 64, 100}));
+    EXPECT_EQ(records[1].bytes, (std::vector<uint8_t>{0x80, 60, 0}));
+    EXPECT_GE(records[0].time, t0);
+    EXPECT_GE(records[1].time, t0 + milliseconds(4));
+
+    auto stats = sched.stats();
+    EXPECT_EQ(stats.scheduled, 3);
+    EXPECT_EQ(stats.sent, 3);
+    uint64_t total = 0;
+    for ( auto n: stats.jitter_histogram )
+        total += n;
+    EXPECT_EQ(total, 3);
+}
+
+TEST(MidiSchedulerTest, past_events_sent_now) {
+    auto sink = std::make_shared<MidiMemorySink>();
+    MidiScheduler sched(MidiOut(0, sink), 16);
+    // The epoch of the clock, ie. as soon as possible
+    EXPECT_TRUE(sched.schedule(MidiScheduler::Clock::time_point{}, MidiMsg::note_on(60, 100)));
+    MidiMsg both[] = {MidiMsg::note_on(64, 100), MidiMsg::note_on(67, 100)};
+    EXPECT_EQ(sched.schedule(MidiScheduler::Clock::now() - std::chrono::hours(24 * 365), both), 2);
+    sched.wait();
+
+    auto stats = sched.stats();
+    EXPECT_EQ(stats.sent, 3);
+    EXPECT_LT(stats.max_jitter, std::chrono::seconds(10));
+    uint64_t total = 0;
+    for ( auto n: stats.jitter_histogram )
+        total += n;
+    EXPECT_EQ(total, 3);
+
+    // Already due, but still sent together
+    for ( int i = 0; i < 20; i++ ) {
+        size_t before = sink->sends(0);
+        MidiMsg chord[] = {MidiMsg::note_off(60, 0), MidiMsg::note_off(64, 0), MidiMsg::note_off(67, 0)};
+        EXPECT_EQ(sched.schedule(MidiScheduler::Clock::now() - std::chrono::seconds(1), chord), 3);
+        sched.wait();
+        ASSERT_EQ(sink->sends(0), before + 1);
+    }
+}
+
+TEST(MidiSchedulerTest, full_queue) {
+    auto sink = std::make_shared<MidiMemorySink>();
+    MidiScheduler sched(MidiOut(0, sink), 2);
+    auto later = MidiScheduler::Clock::now() + std::chrono::hours(1);
+    std::vector<MidiMsg> msgs(8, MidiMsg::note_on(60, 100));
+    // Sender moves events out of the queue, so only part of these fit
+    size_t accepted = sched.schedule(later, msgs);
+    EXPECT_LT(accepted, msgs.size());
+    EXPECT_EQ(sched.stats().dropped, msgs.size() - accepted);
+    EXPECT_THROW(MidiScheduler{MidiOut()}, MidiUnconnected);
+}
+
+TEST(MidiFileTest, write_then_read) {
+    std::string path = testing::TempDir() + "superfret_test.mid";
+    {
+        MidiFileWriter out(path, 1, 96);
+        out.begin_track();
+        out.tempo(0, 500000);
+        out.tempo(192, 250000);
+        out.begin_track();
+        out.write(0, MidiMsg::note_on(60, 100));
+        out.write(0, MidiMsg::note_on(64, 100));
+        out.write(288, MidiMsg::note_off(60, 0));
+        out.begin_track();
+        out.write(96, MidiMsg::pitch_bend(100, 1));
+        EXPECT_THROW(out.write(0, MidiMsg::note_on(1, 1)), MidiFileError);
+        // Longer than a variable-length quantity holds
+        EXPECT_THROW(out.write(96 + 0x10000000, MidiMsg::note_on(1, 1)), MidiFileError);
+        EXPECT_THROW(out.meta(96, 0x01, nullptr, 0x10000000), MidiFileError);
+        // System messages have no place in a track, meta events go through meta()
+        EXPECT_THROW(out.write(96, MidiMsg{0xF8}), MidiFileError);
+        EXPECT_THROW(out.write(96, MidiMsg{0xFF, 0x2F, 0}), MidiFileError);
+        EXPECT_THROW(out.write(96, MidiMsg{}), MidiFileError);
+    }
+
+    MidiFile file(path);
+    EXPECT_EQ(file.format(), 1);
+    EXPECT_EQ(file.tracks(), 3);
+    EXPECT_EQ(file.division(), 96);
+    ASSERT_EQ(file.tempo_map().size(), 2);
+    EXPECT_DOUBLE_EQ(file.seconds(96), 0.5);
+    EXPECT_DOUBLE_EQ(file.seconds(288), 1.25);
+
+    std::vector<std::pair<uint32_t, MidiMsg>> notes;
+    MidiFile::Event e;
+    for ( auto r = file.reader(); r.next(e); )
+        if ( !e.meta() )
+            notes.emplace_back(e.tick, e.msg);
+    ASSERT_EQ(notes.size(), 4);
+    EXPECT_EQ(notes[0], std::make_pair(0u, MidiMsg::note_on(60, 100)));
+    EXPECT_EQ(notes[1], std::make_pair(0u, MidiMsg::note_on(64, 100)));
+    EXPECT_EQ(notes[2], std::make_pair(96u, MidiMsg::pitch_bend(100, 1)));
+    EXPECT_EQ(notes[3], std::make_pair(288u, MidiMsg::note_off(60, 0)));
+    std::remove(path.c_str());
+}
+
+TEST(MidiFileTest, rejects_bad_files) {
+    EXPECT_THROW(MidiFile("does/not/exist.mid"), MidiFileError);
+
+    std::string path = testing::TempDir() + "superfret_bad.mid";
+    FILE* f = std::fopen(path.c_str(), "wb");
+    const char junk[] = "MThd\0\0\0\6\0\1\0\2\0\x60MTrk\0\0\0\4\0\x90\x3C";
+    std::fwrite(junk, 1, sizeof(junk) - 1, f);
+    std::fclose(f);
+    EXPECT_THROW(MidiFile{path}, MidiFileError);  // Second track is missing
+
+    // Running status carries across meta events, as many exporters write it
+    const char kept[] = "MThd\0\0\0\6\0\0\0\1\0\x60MTrk\0\0\0\x0B\0\x90\x3C\x40\0\xFF\x06\0\0\x3C\0";
+    f = std::fopen(path.c_str(), "wb");
+    std::fwrite(kept, 1, sizeof(kept) - 1, f);
+    std::fclose(f);
+    {
+        MidiFile file(path);
+        std::vector<MidiMsg> msgs;
+        MidiFile::Event e;
+        for ( auto r = file.reader(); r.next(e); )
+            if ( !e.meta() )
+                msgs.push_back(e.msg);
+        EXPECT_EQ(msgs, (std::vector<MidiMsg>{MidiMsg::note_on(60, 64), MidiMsg::note_on(60, 0)}));
+    }
+
+    // System common cancels it, so the last data bytes have none
+    const char cancelled[] = "MThd\0\0\0\6\0\0\0\1\0\x60MTrk\0\0\0\x0A\0\x90\x3C\x40\0\xF3\x01\0\x3C\0";
+    f = std::fopen(path.c_str(), "wb");
+    std::fwrite(cancelled, 1, sizeof(cancelled) - 1, f);
+    std::fclose(f);
+    EXPECT_THROW({
+        MidiFile file(path);
+        MidiFile::Event e;
+        for ( auto r = file.reader(); r.next(e); ) {}
+    }, MidiFileError);
+    std::remove(path.c_str());
+}
+
+/// A single port that is lost as soon as anything is sent to it
+class LostBackend : public MidiBackend {
+    public:
+        class Lost : public Connection {
+            public:
+                void send(const uint8_t*, size_t) override {
+                    throw MidiDisconnected("LostBackend: Gone");
+                }
+        };
+
+        std::string backend_name() const override { return "lost"; }
+        size_t count() override { return 1; }
+        std::string name(size_t) override { return "Lost"; }
+        bool external(size_t) override { return true; }
+        size_t notes(size_t) override { return 0; }
+        uint16_t channel_mask(size_t) override { return 0xFFFF; }
+        std::unique_ptr<Connection> open(size_t) override { return std::make_unique<Lost>(); }
+};
+
+TEST(MidiStatsTest, histogram_buckets) {
+    for ( uint64_t ns: {0ull, 1ull, 15ull, 16ull, 17ull, 100ull, 1000ull, 123456ull, 1ull << 30} ) {
+        size_t b = MidiStats::bucket(ns);
+        EXPECT_LE(ns, MidiStats::bucket_top(b));
+        if ( b > 0 ) {
+            EXPECT_GT(ns, MidiStats::bucket_top(b - 1));
+        }
+        // Within 1/16 of the bucket's top
+        EXPECT_LE(MidiStats::bucket_top(b) - ns, ns / 16);
+    }
+    EXPECT_EQ(MidiStats::bucket(uint64_t(1) << 40), MidiStats::buckets - 1);
+}
+
+TEST(MidiStatsTest, counts_sends_and_errors) {
+    auto sink = std::make_shared<MidiMemorySink>();
+    MidiOut out(0, sink);
+    out << 60;
+    EXPECT_EQ(out.stats().sends, 0u);  // Off until enabled
+
+    out.enable_stats();
+    out << 60;
+    out >> 60;
+    out.send({MidiMsg::note_on(60, 100), MidiMsg::note_on(64, 100, 1)});
+    out << Chord::major_triad(60);
+    MidiStats::Snapshot s = out.stats();
+    EXPECT_EQ(s.sends, 4u);
+    EXPECT_EQ(s.messages, 7u);
+    EXPECT_EQ(s.bytes, 3u + 2u + 6u + 7u);
+    EXPECT_EQ(s.latency.total, 4u);
+    EXPECT_LE(s.latency.min, s.latency.percentile(0.5));
+    EXPECT_LE(s.latency.percentile(0.5), s.latency.percentile(0.99));
+    EXPECT_EQ(s.latency.percentile(1), s.latency.max);
+
+    // Errors are counted by kind, and failed sends are not timed
+    MidiOut lost(0, std::make_shared<LostBackend>());
+    lost.enable_stats();
+    EXPECT_THROW(lost << 60, MidiDisconnected);
+    EXPECT_THROW(lost.send({MidiMsg::note_on(60, 100)}), MidiDisconnected);
+    EXPECT_EQ(lost.stats().error_count(MidiErrorKind::Disconnected), 2u);
+    EXPECT_EQ(lost.stats().sends, 0u);
+    MidiOut unconnected;
+    unconnected.enable_stats();
+    EXPECT_THROW(unconnected << 60, MidiUnconnected);
+    EXPECT_EQ(unconnected.stats().error_count(MidiErrorKind::Unconnected), 1u);
+
+    // Read from another thread while sending
+    std::atomic<bool> done{false};
+    uint64_t last = 0;
+    bool ordered = true;
+    std::thread reader([&] {
+        while ( !done ) {
+            uint64_t sends = out.stats().sends;
+            ordered = ordered && sends >= last;
+            last = sends;
+        }
+    });
+    for ( int i = 0; i < 10000; i++ )
+        out << uint8_t(i % 128);
+    done = true;
+    reader.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(out.stats().sends, 10004u);
+}
+
+/// @brief Counts enumerations, to check port capabilities are read once
+class CountingSink : public MidiMemorySink {
+    public:
+        using MidiMemorySink::MidiMemorySink;
+        std::atomic<int> reads{0};
+        std::string name(size_t port) override { reads++; return MidiMemorySink::name(port); }
+};
+
+TEST(MidiOutTest, cached_caps) {
+    auto sink = std::make_shared<CountingSink>(3);
+    auto infos = MidiOut::discover(sink);
+    ASSERT_EQ(infos.size(), 3u);
+    int reads = sink->reads;
+    for ( int i = 0; i < 10; i++ )
+        for ( auto& info: infos ) {
+            EXPECT_EQ(info.name(), "Superfret Memory Sink " + std::to_string(info.port()));
+            EXPECT_FALSE(info.external());
+            EXPECT_EQ(info.caps().channel_mask, info.channel_mask());
+        }
+    EXPECT_EQ(sink->reads, reads);
+    auto copy = infos[2];
+    EXPECT_EQ(copy.port(), 2u);
+    EXPECT_EQ(copy.name(), "Superfret Memory Sink 2");
+
+    // Unplugged while connected
+    MidiOut out;
+    out = infos[2];
+    out << 60;
+    sink->set_count(2);
+    EXPECT_THROW(out << 62, MidiDisconnected);
+    EXPECT_THROW(MidiOut(2, sink), MidiNotFound);
+    sink->set_count(3);
+    EXPECT_EQ(sink->bytes(2).size(), 3u);
+}
+
+TEST(MidiWatcherTest, hot_plug) {
+    using namespace std::chrono_literals;
+    auto sink = std::make_shared<MidiMemorySink>(2);
+    MidiWatcher watcher(sink, nullptr, 10s);
+    ASSERT_TRUE(watcher.wait_ready(5s));
+    EXPECT_EQ(watcher.devices().size(), 2u);
+    auto events = watcher.poll();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].type, MidiWatcher::Added);
+    EXPECT_EQ(events[1].info.name(), "Superfret Memory Sink 1");
+
+    auto rescan = [&] {
+        size_t scans = watcher.scans();
+        watcher.rescan();
+        for ( int i = 0; i < 500 && watcher.scans() == scans; i++ )
+            std::this_thread::sleep_for(10ms);
+        return watcher.poll();
+    };
+    EXPECT_TRUE(rescan().empty());
+
+    sink->set_count(3);
+    events = rescan();
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].type, MidiWatcher::Added);
+    EXPECT_EQ(events[0].info.port(), 2u);
+    EXPECT_EQ(watcher.devices().size(), 3u);
+
+    sink->set_count(1);
+    events = rescan();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].type, MidiWatcher::Removed);
+    EXPECT_EQ(events[0].info.name(), "Superfret Memory Sink 1");
+    EXPECT_EQ(events[1].info.name(), "Superfret Memory Sink 2");
+    EXPECT_EQ(watcher.devices().size(), 1u);
+}
+
+TEST(MidiWatcherTest, callback) {
+    using namespace std::chrono_literals;
+    auto sink = std::make_shared<MidiMemorySink>(1);
+    std::atomic<int> added{0}, removed{0};
+    std::atomic<MidiWatcher*> self{nullptr};
+    std::atomic<size_t> devices_when_removed{99};
+    {
+        MidiWatcher watcher(sink, [&](const MidiWatcher::Event& e) {
+            // Calling back into the watcher, with the scan already published
+            if ( MidiWatcher* w = self.load() ) {
+                if ( e.type == MidiWatcher::Removed )
+                    devices_when_removed = w->devices().size();
+                w->rescan();
+            }
+            (e.type == MidiWatcher::Added ? added : removed)++;
+        }, 1ms);
+        self = &watcher;
+        ASSERT_TRUE(watcher.wait_ready(5s));
+        sink->set_count(0);
+        for ( int i = 0; i < 500 && removed == 0; i++ )
+            std::this_thread::sleep_for(10ms);
+        EXPECT_TRUE(watcher.poll().empty());
+    }
+    EXPECT_EQ(added, 1);
+    EXPECT_EQ(removed, 1);
+    EXPECT_EQ(devices_when_removed, 0u);
+}
+
+TEST(MidiOutTest, try_send) {
+    // Every kind throws the matching error
+    for ( size_t i = 0; i < midi_error_kinds; i++ ) {
+        MidiErrorKind kind = MidiErrorKind(i);
+        try {
+            throw_midi_error(kind, "test");
+        } catch ( const MidiError& e ) {
+            EXPECT_EQ(e.kind(), kind == MidiErrorKind::Other ? MidiErrorKind::RuntimeError : kind);
+        }
+    }
+
+    auto sink = std::make_shared<MidiMemorySink>();
+    MidiOut out(0, sink);
+    out.enable_stats();
+    EXPECT_TRUE(out.try_send(MidiMsg::note_on(60, 100)));
+    EXPECT_TRUE(out.try_note_on(Chord::major_triad(60)));
+    EXPECT_EQ(out.last_batch().messages, 3u);
+    std::vector<MidiMsg> msgs{MidiMsg::note_off(60, 0), MidiMsg::note_off(64, 0)};
+    EXPECT_TRUE(out.try_send(msgs));
+    EXPECT_EQ(out.last_batch().messages, 2u);
+    EXPECT_EQ(sink->sends(0), 3u);
+
+    // Failures come back instead of being thrown, and are counted alike
+    MidiOut unconnected;
+    MidiStatus s = unconnected.try_send(MidiMsg::note_on(60, 100));
+    EXPECT_FALSE(s);
+    EXPECT_EQ(s, MidiErrorKind::Unconnected);
+    sink->set_count(0);
+    EXPECT_EQ(out.try_send(MidiMsg::note_on(60, 100)), MidiErrorKind::Disconnected);
+    EXPECT_EQ(out.try_note_off(Chord::major_triad(60)), MidiErrorKind::Disconnected);
+    EXPECT_EQ(out.try_send(msgs), MidiErrorKind::Disconnected);
+    EXPECT_EQ(out.last_batch().messages, 2u);
+    EXPECT_THROW(out << 60, MidiDisconnected);
+    EXPECT_EQ(out.stats().error_count(MidiErrorKind::Disconnected), 4u);
+
+    // The default try_send catches what the backend throws
+    MidiOut lost(0, std::make_shared<LostBackend>());
+    EXPECT_EQ(lost.try_send(MidiMsg::note_on(60, 100)), MidiErrorKind::Disconnected);
+
+    // Throwing calls raise the backend's own error, keeping its message
+    try {
+        lost << 60;
+        FAIL();
+    } catch ( const MidiDisconnected& e ) {
+        EXPECT_STREQ(e.what(), "MidiDisconnected: LostBackend: Gone");
+    }
+    try {
+        unconnected << Chord::major_triad(60);
+        FAIL();
+    } catch ( const MidiUnconnected& e ) {
+        EXPECT_STREQ(e.what(), "MidiUnconnected: MidiOut << - Must connect first!");
+    }
+}
+
+TEST(MidiMsgTest, decoder) {
+    std::vector<MidiMsg> msgs = {
+        MidiMsg::note_on(60, 100), MidiMsg::note_on(64, 90), MidiMsg::program_change(5, 2),
+        MidiMsg::channel_pressure(30, 2), MidiMsg::pitch_bend(-100, 3), MidiMsg::note_off(60, 0)
+    };
+    uint8_t bytes[MidiEncoder::max_size(6)];
+    size_t n = MidiEncoder().encode(msgs.data(), msgs.size(), bytes);
+    MidiMsg out[sizeof(bytes)];
+    MidiDecoder dec;
+    ASSERT_EQ(dec.decode(bytes, n, out), msgs.size());
+    EXPECT_EQ(std::vector<MidiMsg>(out, out + msgs.size()), msgs);
+
+    // Real-time in the middle of a message, system exclusive and stray data skipped
+    const uint8_t stream[] = {0x42, 0x90, 60, 0xF8, 100, 0xF0, 1, 2, 3, 0xF7, 7, 0xB0, 64, 127, 0xF6, 1};
+    dec.reset();
+    n = dec.decode(stream, sizeof(stream), out);
+    ASSERT_EQ(n, 4u);
+    EXPECT_EQ(out[0].status, 0xF8);
+    EXPECT_EQ(out[1], MidiMsg::note_on(60, 100));
+    EXPECT_EQ(out[2], MidiMsg::control_change(MidiMsg::Sustain, 127));
+    EXPECT_EQ(out[3].status, 0xF6);
+}
+
+TEST(SpscRingTest, batches_across_threads) {
+    SpscRing<uint64_t> ring(100);
+    EXPECT_EQ(ring.capacity(), 128u);
+    for ( uint64_t i = 0; i < 128; i++ )
+        EXPECT_TRUE(ring.push(i));
+    EXPECT_FALSE(ring.push(128));
+    uint64_t batch[50];
+    EXPECT_EQ(ring.pop(batch, 50), 50u);
+    EXPECT_EQ(batch[49], 49u);
+    EXPECT_EQ(ring.size(), 78u);
+    EXPECT_EQ(ring.pop(batch, 50), 50u);
+    EXPECT_EQ(ring.pop(batch, 50), 28u);
+    EXPECT_EQ(ring.pop(batch, 50), 0u);
+
+    const uint64_t total = 200000;
+    std::thread producer([&] {
+        for ( uint64_t i = 0; i < total; i++ )
+            while ( !ring.push(i) )
+                std::this_thread::yield();
+    });
+    uint64_t next = 0;
+    bool ordered = true;
+    while ( next < total ) {
+        size_t n = ring.pop(batch, 50);
+        for ( size_t i = 0; i < n; i++ )
+            ordered = ordered && batch[i] == next++;
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+}
+
+TEST(MidiInTest, loopback) {
+    auto sink = std::make_shared<MidiMemorySink>(2);
+    auto infos = MidiIn::discover(sink);
+    ASSERT_EQ(infos.size(), 2u);
+    EXPECT_EQ(infos[1].name(), "Superfret Memory Sink 1");
+
+    MidiIn unconnected;
+    MidiIn::Event e;
+    EXPECT_FALSE(unconnected.receive(e));
+    EXPECT_THROW(unconnected.name(), MidiUnconnected);
+    EXPECT_THROW(MidiIn(2, sink), MidiNotFound);
+
+    MidiIn in;
+    in = infos[1];
+    EXPECT_TRUE(in.connected());
+    EXPECT_EQ(in.name(), "Superfret Memory Sink 1");
+    EXPECT_THROW(MidiIn(1, sink), MidiAllocated);
+
+    // Running status on the wire is decoded
+    MidiOut out(1, sink);
+    auto before = MidiIn::Clock::now();
+    out << Chord::major_triad(60);
+    out << MidiMsg::control_change(MidiMsg::Sustain, 127, 1);
+    EXPECT_EQ(in.pending(), 4u);
+    MidiIn::Event events[8];
+    ASSERT_EQ(in.receive(events), 4u);
+    EXPECT_EQ(events[0].msg, MidiMsg::note_on(60, 120));
+    EXPECT_EQ(events[2].msg, MidiMsg::note_on(67, 120));
+    EXPECT_EQ(events[3].msg, MidiMsg::control_change(MidiMsg::Sustain, 127, 1));
+    EXPECT_GE(events[0].time, before);
+    EXPECT_LE(events[0].time, events[3].time);
+    EXPECT_EQ(in.receive(events), 0u);
+
+    // What does not fit is counted, and the rest kept
+    MidiIn small(0, sink, 4);
+    MidiOut out0(0, sink);
+    for ( uint8_t i = 0; i < 10; i++ )
+        out0 << i;
+    EXPECT_EQ(small.dropped(), 6u);
+    ASSERT_EQ(small.receive(events), 4u);
+    EXPECT_EQ(events[3].msg.data0, 3);
+}
+
+TEST(MidiInTest, latency) {
+    using namespace std::chrono;
+    auto sink = std::make_shared<MidiMemorySink>();
+    MidiIn in(0, sink);
+    MidiOut out(0, sink);
+    const int total = 5000;
+
+    // Consumer polls the ring as an audio thread would, and the producer
+    // waits for each message to be taken, so each is measured on its own
+    std::vector<nanoseconds> latencies;
+    latencies.reserve(total);
+    std::atomic<int> received{0};
+    std::thread consumer([&] {
+        MidiIn::Event events[64];
+        while ( received < total ) {
+            size_t n = in.receive(events);
+            auto now = MidiIn::Clock::now();
+            for ( size_t i = 0; i < n; i++ )
+                latencies.push_back(now - events[i].time);
+            if ( n )
+                received += int(n);
+            else
+                std::this_thread::yield();
+        }
+    });
+    for ( int i = 0; i < total; i++ ) {
+        out << MidiMsg::note_on(uint8_t(i % 128), 100);
+        while ( received <= i )
+            std::this_thread::yield();
+    }
+    consumer.join();
+    EXPECT_EQ(in.dropped(), 0u);
+    ASSERT_EQ(latencies.size(), size_t(total));
+    std::sort(latencies.begin(), latencies.end());
+    // Generous, as CI machines are shared, but far below a millisecond
+    EXPECT_LT(latencies[latencies.size() / 2], microseconds(200));
+}
+
+TEST(MidiPipelineTest, stages) {
+    MidiMsg out[64];
+    const MidiMsg notes[] = {MidiMsg::note_on(61, 64, 2), MidiMsg::control_change(1, 5, 2), MidiMsg::note_off(126, 0, 2)};
+
+    EXPECT_EQ(Transpose{4}(notes, 3, out), 2u);
+    EXPECT_EQ(out[0], MidiMsg::note_on(65, 64, 2));
+    EXPECT_EQ(out[1], MidiMsg::control_change(1, 5, 2));
+
+    // Ties, C# between C and D and F# between F and G, go down
+    QuantizeToScale quantize(Scale::major("C"));
+    EXPECT_EQ(quantize(notes, 3, out), 3u);
+    EXPECT_EQ(out[0].data0, 60);
+    EXPECT_EQ(out[2].data0, 125);
+
+    EXPECT_EQ(VelocityCurve::fixed(100)(notes, 3, out), 3u);
+    EXPECT_EQ(out[0].data1, 100);
+    EXPECT_EQ(out[2].data1, 0);
+    VelocityCurve soft = VelocityCurve::gamma(0.5);
+    EXPECT_GT(soft[32], 32);
+    EXPECT_EQ(soft[127], 127);
+    EXPECT_EQ(VelocityCurve::range(40, 90)[1], 40);
+    EXPECT_EQ(VelocityCurve::range(40, 90)[127], 90);
+
+    EXPECT_EQ(ChannelMap().map(2, 9)(notes, 3, out), 3u);
+    EXPECT_EQ(out[1], MidiMsg::control_change(1, 5, 9));
+
+    ChordFromNote chords(Chord::minor_triad);
+    ASSERT_EQ(chords(notes, 2, out), 4u);
+    EXPECT_EQ(out[2], MidiMsg::note_on(68, 64, 2));
+    EXPECT_EQ(out[3], MidiMsg::control_change(1, 5, 2));
+}
+
+TEST(MidiPipelineTest, controller_to_synth) {
+    using namespace std::chrono;
+    // Port 0 loops back from the controller, port 1 records what the synth gets
+    auto sink = std::make_shared<MidiMemorySink>(2, false);
+    MidiOut controller(0, sink);
+    MidiIn in(0, sink);
+    MidiOut synth(1, sink);
+
+    MidiPipeline pipeline(Transpose{12}, QuantizeToScale(Scale::major("C")), VelocityCurve::fixed(100),
+                          ChannelMap(3), ChordFromNote(Chord::major_triad));
+    static_assert(decltype(pipeline)::expansion == Chord::capacity, "Only the chord stage expands");
+    pipeline.enable_timing();
+
+    controller << MidiMsg::note_on(61, 30);
+    controller << MidiMsg::note_off(61, 0);
+    EXPECT_EQ(pipeline.pump(in, synth), 2u);
+    EXPECT_EQ(pipeline.pump(in, synth), 0u);
+    EXPECT_EQ(sink->bytes(1), (std::vector<uint8_t>{
+        0x93, 72, 100, 0x93, 76, 100, 0x93, 79, 100,
+        0x83, 72, 0, 0x83, 76, 0, 0x83, 79, 0}));
+
+    // Run on its own thread under a steady stream
+    std::atomic<bool> running{true};
+    std::thread thread([&] { pipeline.run(in, synth, running); });
+    for ( int i = 0; i < 2000; i++ ) {
+        controller << MidiMsg::note_on(uint8_t(40 + i % 40), 90);
+        if ( i % 64 == 0 )
+            std::this_thread::sleep_for(microseconds(200));
+    }
+    while ( in.pending() )
+        std::this_thread::yield();
+    running = false;
+    thread.join();
+
+    auto timing = pipeline.timing();
+    EXPECT_EQ(timing.errors, 0u);
+    EXPECT_EQ(timing.latency.messages, 2002u);
+    for ( auto& stage: timing.stages ) {
+        EXPECT_EQ(stage.messages, 2002u);
+        EXPECT_GT(stage.batches, 0u);
+        EXPECT_LE(stage.max, stage.total);
+    }
+    // How fast is for benchmarks/midi_pipeline.cc, only that it was timed
+    EXPECT_GT(timing.latency.latency.percentile(0.5), nanoseconds(0));
+}
@@ -0,0 +1,625 @@
+#include <gtest/gtest.h>
+#include "music.h"
+
+#include <atomic>
+#include <cstdlib>
+
+#include "alloc_counter.hpp"
+
+TEST(PcSetTest, set_operations) {
+    PcSet c_major = PcSet::of({0, 2, 4, 5, 7, 9, 11});
+    PcSet c_triad = PcSet::of({0, 4, 7});
+    EXPECT_EQ(c_major.bits(), 0xAB5);
+    EXPECT_EQ(c_major.size(), 7);
+    EXPECT_TRUE(c_major.contains(Tone("E")));
+    EXPECT_FALSE(c_major.contains(Tone("F#")));
+    EXPECT_TRUE(c_triad.subset_of(c_major));
+    EXPECT_FALSE(c_major.subset_of(c_triad));
+    EXPECT_EQ(c_major & PcSet::of({1, 2, 3}), PcSet::of({2}));
+    EXPECT_EQ(c_triad.transpose(2), PcSet::of({2, 6, 9}));
+    EXPECT_EQ(c_triad.transpose(14), c_triad.transpose(2));
+    EXPECT_EQ(c_triad.invert(), PcSet::of({0, 8, 5}));
+    EXPECT_EQ(c_major.complement().size(), 5);
+    EXPECT_EQ(c_triad.next(7), 0);
+    EXPECT_EQ(c_major.interval_vector(), (std::array<uint8_t, 6>{2, 5, 4, 3, 6, 1}));
+    EXPECT_EQ(PcSet::of({0, 3, 6, 9}).interval_vector(), (std::array<uint8_t, 6>{0, 0, 4, 0, 0, 2}));
+}
+
+TEST(ScaleTest, pcset) {
+    Scale d_dorian = Scale::dorian("D");
+    EXPECT_EQ(d_dorian.pcset(), Scale::major("C").pcset());
+    EXPECT_NE(d_dorian, Scale::major("C"));
+    EXPECT_EQ(d_dorian, Scale(Tone("D"), Scale::major("C").pcset()));
+    EXPECT_EQ(Scale::major("C").transpose(7), Scale::major("G"));
+    EXPECT_TRUE(Scale::major("G").contains(Tone("F#")));
+    EXPECT_TRUE(Scale::major("C").contains(Scale::minor("A")));
+
+    auto notes = Scale::major("C").range(60, 72);
+    std::vector<Note> expected = {60, 62, 64, 65, 67, 69, 71, 72};
+    EXPECT_EQ(notes, expected);
+}
+
+TEST(ChordTest, pcset) {
+    Chord g7(Note(55), PcSet::of({7, 11, 2, 5}));
+    std::vector<Note> expected = {55, 59, 62, 65};
+    EXPECT_EQ(g7.notes(), expected);
+    EXPECT_EQ(Chord::major_triad(60).pcset(), PcSet::of({0, 4, 7}));
+    EXPECT_TRUE(Chord::minor_triad(69).pcset().subset_of(Scale::major("C").pcset()));
+}
+
+TEST(ToneTest, parse) {
+    static_assert("C#"_tone == Tone(1), "tone literal is constexpr");
+    static_assert(Tone::toneof("Bb") == 10, "flats are accepted");
+    EXPECT_EQ(Tone("Cb"), Tone("B"));
+    EXPECT_EQ(Tone::toneof("H"), 12);
+    EXPECT_THROW(Tone(operator""_tone("H", 1)), std::invalid_argument);
+    // Unknown names at run time read as "C", formatted or not
+    char buf[Tone::max_name];
+    EXPECT_EQ(std::string(buf, Tone("H").format(buf)), Tone("H").name());
+}
+
+TEST(NoteTest, parse) {
+    static_assert("A4"_note == Note(69), "note literal is constexpr");
+    static_assert("C-1"_note == Note(0), "lowest MIDI note");
+    static_assert("G9"_note == Note(127), "highest MIDI note");
+    EXPECT_EQ(Note::parse("Bb3"), Note(58));
+    for ( uint8_t n = 0; n < 128; n++ )
+        EXPECT_EQ(Note::parse(Note(n).name()), Note(n));
+    EXPECT_THROW(Note::parse("A"), std::invalid_argument);
+    EXPECT_THROW(Note::parse("A-"), std::invalid_argument);
+    EXPECT_THROW(Note::parse("H4"), std::invalid_argument);
+    EXPECT_THROW(Note::parse("G#9"), std::invalid_argument);
+    // The flat of C is in the octave below
+    EXPECT_EQ(Note::parse("Cb4"), Note(59));
+    EXPECT_THROW(Note::parse("Cb-1"), std::invalid_argument);
+}
+
+TEST(ScaleTest, constexpr_factories) {
+    constexpr Scale g_major = Scale::major("G");
+    static_assert(g_major.length() == 7, "scales are built at compile time");
+    static_assert(g_major[6] == "F#"_tone, "tones ascend from the root");
+    static_assert(g_major.contains("F#"_tone), "membership at compile time");
+
+    constexpr Chord c7 = Chord("C4"_note, {4, 7, 10});
+    static_assert(c7.size() == 4 && c7[3] == "A#4"_note, "chords are built at compile time");
+    static_assert(c7.pcset() == PcSet::of({0, 4, 7, 10}), "chord set at compile time");
+
+    std::vector<Tone> expected = {"G", "A", "B", "C", "D", "E", "F#"};
+    EXPECT_EQ(g_major.tones(), expected);
+    EXPECT_EQ(Scale(Tone("G"), std::vector<uint8_t>{0, 2, 4, 5, 7, 9, 11}), g_major);
+    EXPECT_EQ(Scale(expected), g_major);
+}
+
+TEST(PcCatalogTest, forte_numbers) {
+    static_assert(PcCatalog::lookup(PcSet::of({0, 4, 7})).prime == PcSet::of({0, 3, 7}).bits(), "major triad is 037");
+    EXPECT_STREQ(PcCatalog::forte(PcSet::of({0, 4, 7})), "3-11");
+    EXPECT_STREQ(PcCatalog::forte(Scale::major("D").pcset()), "7-35");
+    EXPECT_STREQ(PcCatalog::forte(PcSet::of({1, 2, 4, 8})), "4-Z29");
+    EXPECT_STREQ(PcCatalog::forte(PcSet::of({0, 2, 4, 6, 8, 10})), "6-35");
+    EXPECT_STREQ(PcCatalog::forte(PcSet()), "0-1");
+    EXPECT_STREQ(PcCatalog::forte(PcSet(PcSet::all)), "12-1");
+
+    // Every set class has exactly one name, and complements match up
+    size_t classes[13] = {};
+    for ( uint16_t bits = 0; bits < 4096; bits++ ) {
+        const PcCatalog::Entry& e = PcCatalog::lookup(PcSet(bits));
+        ASSERT_NE(e.forte, nullptr) << PcSet(bits);
+        EXPECT_EQ(PcCatalog::lookup(PcSet(e.prime)).forte, e.forte);
+        classes[PcSet(bits).size()] += e.prime == bits;
+        std::string name = e.forte, complement = PcCatalog::forte(PcSet(bits).complement());
+        size_t size = PcSet(bits).size();
+        EXPECT_EQ(std::stoul(name), size);
+        if ( size != 6 ) {
+            EXPECT_EQ(name.substr(name.find('-')), complement.substr(complement.find('-')));
+        }
+    }
+    size_t expected[13] = {1, 1, 6, 12, 29, 38, 50, 38, 29, 12, 6, 1, 1};
+    for ( size_t n = 0; n <= 12; n++ )
+        EXPECT_EQ(classes[n], expected[n]) << n << " tones";
+}
+
+TEST(PcCatalogTest, names) {
+    EXPECT_EQ(PcCatalog::chord_name(PcSet::of({7, 11, 2, 5})), "G7");
+    EXPECT_EQ(PcCatalog::chord_name(Chord::minor_triad(61).pcset()), "C#m");
+    EXPECT_EQ(PcCatalog::chord_name(PcSet::of({6, 9, 0, 4})), "F#m7b5");
+    EXPECT_EQ(PcCatalog::chord_name(PcSet::of({0, 1, 2})), "");
+
+    EXPECT_EQ(PcCatalog::scale_name(Scale::dorian("D").pcset()), "C ionian");
+    EXPECT_EQ(PcCatalog::scale_name(Scale::major("C").pcset(), "D"), "D dorian");
+    EXPECT_EQ(PcCatalog::scale_name(Scale::locrian("B")), "B locrian");
+    EXPECT_EQ(PcCatalog::scale_name(Scale::lorian("E")), "E locrian");
+    EXPECT_EQ(PcCatalog::scale_name(Scale::minor("A")), "A aeolian");
+    EXPECT_EQ(PcCatalog::scale_name(Scale(Tone("A"), PcSet::of({0, 2, 4, 7, 9}))), "A minor pentatonic");
+    EXPECT_EQ(PcCatalog::scale_name(PcSet::of({1, 2, 4, 5, 7, 8, 10, 11}), "D"), "D whole-half diminished");
+    EXPECT_EQ(PcCatalog::scale_name(PcSet::of({1, 2, 4, 5, 7, 8, 10, 11}), "C#"), "C# half-whole diminished");
+    EXPECT_EQ(PcCatalog::scale_name(Scale::major("C").pcset(), "C#"), "");
+}
+
+TEST(ChordTest, identify) {
+    std::vector<Note> g7_b = {"B2"_note, "F3"_note, "G3"_note, "D4"_note};
+    auto found = Chord::identify(g7_b);
+    ASSERT_FALSE(found.empty());
+    EXPECT_EQ(found[0].root, Tone("G"));
+    EXPECT_STREQ(found[0].info().symbol, "7");
+    EXPECT_EQ(found[0].inversion, 1);
+    EXPECT_EQ(found[0].name(), "G7/B");
+
+    // The bass decides between readings of the same tones
+    EXPECT_EQ(Chord::identify(Chord("C4"_note, {4, 7, 9}))[0].name(), "C6");
+    EXPECT_EQ(Chord::identify(Chord("A3"_note, {3, 7, 10}))[0].name(), "Am7");
+    EXPECT_EQ(Chord::identify(Chord("C4"_note, {4, 7, 11, 14, 18}))[0].name(), "Cmaj9(#11)");
+    EXPECT_EQ(Chord::identify(Chord::minor_triad("E4"_note))[0].name(), "Em");
+
+    auto slash = Chord::identify(std::vector<Note>{"F#3"_note, "C4"_note, "E4"_note, "G4"_note});
+    EXPECT_EQ(slash[0].name(), "C(#11)/F#");
+    EXPECT_EQ(slash[0].inversion, PcCatalog::none);
+    EXPECT_EQ(Chord::identify(std::vector<Note>{"D3"_note, "C4"_note, "E4"_note, "G4"_note})[0].name(), "Cadd9/D");
+
+    EXPECT_TRUE(Chord::identify(Span<const Note>()).empty());
+    EXPECT_TRUE(Chord::identify(std::vector<Note>{60}).empty());
+    for ( size_t i = 1; i < found.size(); i++ )
+        EXPECT_GE(found[i - 1].score, found[i].score);
+}
+
+TEST(ScaleTrackerTest, follows_key) {
+    ScaleTracker tracker;
+    EXPECT_TRUE(tracker.top().empty());
+    EXPECT_EQ(tracker.best().scale, Scale());
+    EXPECT_EQ(tracker.best().score, 0);
+    EXPECT_FALSE(tracker.best().fits);
+
+    // A C major phrase, leaning on the tonic triad
+    for ( auto n: {"C4", "E4", "G4", "F4", "D4", "B3", "C4", "A4", "G4", "E4", "C4"} )
+        tracker.note(Note::parse(n));
+    EXPECT_EQ(tracker.best().scale, Scale::major("C"));
+    EXPECT_TRUE(tracker.best().fits);
+    EXPECT_EQ(tracker.top().size(), ScaleTracker::top_size);
+    EXPECT_EQ(tracker.present(), Scale::major("C").pcset());
+
+    // Moving to A minor, with its raised 7th, takes over as C major fades
+    for ( int i = 0; i < 4; i++ )
+        for ( auto n: {"A3", "C4", "E4", "A4", "G#4", "A4", "E4", "B3"} )
+            tracker.note(Note::parse(n));
+    EXPECT_EQ(tracker.best().scale.root(), Tone("A"));
+    EXPECT_FALSE(tracker.present().contains(Tone("F")));
+    for ( size_t i = 1; i < tracker.top().size(); i++ )
+        EXPECT_GE(tracker.top()[i - 1].score, tracker.top()[i].score);
+
+    tracker.reset();
+    EXPECT_EQ(tracker.best().scale, Scale());
+    for ( auto n: Scale::dorian("D").range(62, 74) )
+        tracker.note(n);
+    for ( auto n: {"D4", "A4", "F4", "D4", "B4", "A4", "D4"} )
+        tracker.note(Note::parse(n));
+    EXPECT_EQ(tracker.best().scale, Scale::dorian("D"));
+
+    // Long streams stay finite
+    for ( int i = 0; i < 100000; i++ )
+        tracker.note(Note(uint8_t(60 + (i * 7) % 12)));
+    EXPECT_TRUE(std::isfinite(tracker.best().score));
+}
+
+TEST(FretboardTest, notes_and_queries) {
+    Fretboard guitar = Fretboard::guitar();
+    EXPECT_EQ(guitar.strings(), 6);
+    EXPECT_EQ(guitar.note(0, 0), "E2"_note);
+    EXPECT_EQ(guitar.note(1, 3), "C3"_note);
+    EXPECT_EQ(guitar.note(5, 24), "E6"_note);
+    EXPECT_FALSE(guitar.valid({5, 25}));
+    EXPECT_FALSE(guitar.valid({6, 0}));
+
+    uint32_t c_major_low_e = (1 << 0) | (1 << 1) | (1 << 3) | (1 << 5) | (1 << 7) | (1 << 8) | (1 << 10);
+    c_major_low_e |= c_major_low_e << 12;
+    c_major_low_e |= 1u << 24;
+    EXPECT_EQ(guitar.frets(0, Scale::major("C").pcset()), c_major_low_e);
+    EXPECT_EQ(guitar.frets(2, "A3"_note), 1u << 7);
+
+    size_t count = 0;
+    guitar.each(Chord::major_triad(60), [&](Fretboard::Position p) {
+        EXPECT_TRUE(Chord::major_triad(60).contains(guitar.note(p).tone()));
+        count++;
+    });
+    std::array<Fretboard::Position, 4> few;
+    EXPECT_EQ(guitar.find(PcSet::of({0, 4, 7}), few), count);
+    EXPECT_EQ(few[0], (Fretboard::Position{0, 0}));
+    EXPECT_EQ(few[1], (Fretboard::Position{0, 3}));
+}
+
+TEST(FretboardTest, tuning_and_capo) {
+    Fretboard guitar = Fretboard::guitar(22, 2);
+    EXPECT_EQ(guitar.playable(), 20);
+    EXPECT_EQ(guitar.note(0, 0), "F#2"_note);
+    EXPECT_FALSE(guitar.valid({0, 21}));
+
+    // Drop D only changes the lowest string
+    guitar.retune(0, "D2"_note);
+    EXPECT_EQ(guitar.tuning(0), "D2"_note);
+    EXPECT_EQ(guitar.note(0, 0), "E2"_note);
+    EXPECT_EQ(guitar.note(1, 0), "B2"_note);
+
+    guitar.set_capo(0);
+    EXPECT_EQ(guitar.note(0, 0), "D2"_note);
+    EXPECT_TRUE(guitar.valid({0, 22}));
+    EXPECT_THROW(guitar.set_capo(23), std::invalid_argument);
+    EXPECT_THROW(guitar.retune(6, 60), std::out_of_range);
+    EXPECT_THROW(Fretboard({}), std::invalid_argument);
+
+    // Positions past the top of the MIDI range are not playable
+    Fretboard high({120}, 12);
+    EXPECT_TRUE(high.valid({0, 7}));
+    EXPECT_FALSE(high.valid({0, 8}));
+    EXPECT_EQ(high.frets(0, PcSet(PcSet::all)), 0xFFu);
+}
+
+TEST(NoteTest, format) {
+    char buf[Note::max_name];
+    EXPECT_EQ(std::string(buf, Note("C#-1"_note).format(buf)), "C#-1");
+    EXPECT_EQ(std::string(buf, Note(127).format(buf)), "G9");
+    EXPECT_EQ(std::string(buf, Tone("A#").format(buf)), "A#");
+    for ( uint8_t n = 0; n < 128; n++ )
+        EXPECT_EQ(Note(n).name(), Tone::nameof(n) + std::to_string(n / 12 - 1));
+}
+
+TEST(FretboardViewTest, only_changes_are_sent) {
+    Fretboard guitar = Fretboard::guitar(12);
+    FretboardView view(2, 3);
+    view.draw(guitar, Scale::major("C"));
+    std::string first = view.diff();
+    // Starts at the view's own corner, without clearing the terminal
+    EXPECT_EQ(first.rfind("\x1b[2;3H", 0), 0u);
+    EXPECT_EQ(first.find("\x1b[2J"), std::string::npos);
+    EXPECT_NE(first.find("\x1b[2;3H\x1b[0;36mE4\x1b[0m  |"), std::string::npos);
+    EXPECT_EQ(view.rows(), 6u);
+    EXPECT_EQ(view.cols(), FretboardView::label_width + 12 * FretboardView::fret_width);
+
+    // Nothing changed, nothing to send
+    size_t capacity = view.diff().capacity();
+    view.draw(guitar, Scale::major("C"));
+    EXPECT_TRUE(view.diff().empty());
+
+    // Accenting G only recolours the 7 G positions in 12 frets, then
+    // moves the cursor back under the board
+    view.draw(guitar, Scale::major("C"), PcSet::of({7}));
+    const std::string& accent = view.diff();
+    EXPECT_EQ(accent.find("\x1b[2J"), std::string::npos);
+    size_t moves = 0;
+    for ( size_t at = accent.find("H"); at != std::string::npos; at = accent.find("H", at + 1) )
+        moves++;
+    EXPECT_EQ(moves, 8u);
+    EXPECT_NE(accent.find("\x1b[0;1;33mG"), std::string::npos);
+    EXPECT_EQ(view.diff().capacity(), capacity);
+
+    view.invalidate();
+    view.draw(guitar, Scale::major("C"), PcSet::of({7}));
+    EXPECT_GT(view.diff().size(), accent.size());
+
+    // A smaller board blanks only what is left of the larger one
+    view.draw(Fretboard::guitar(5), Scale::major("C"));
+    const std::string& smaller = view.diff();
+    size_t cols = FretboardView::label_width + 5 * FretboardView::fret_width;
+    std::string blank = "\x1b[2;" + std::to_string(3 + cols) + "H" + std::string(7 * FretboardView::fret_width, ' ');
+    EXPECT_EQ(smaller.rfind("\x1b[0m" + blank, 0), 0u);
+    EXPECT_EQ(smaller.find("\x1b[2J"), std::string::npos);
+}
+
+TEST(VoicingTest, open_chords) {
+    Fretboard guitar = Fretboard::guitar();
+    VoicingGenerator gen;
+    auto c = gen.voicings(guitar, Chord::major_triad("C3"_note));
+    ASSERT_FALSE(c->empty());
+    EXPECT_EQ((*c)[0].tab(), "x32010");
+    EXPECT_EQ(gen.voicings(guitar, Chord::major_triad("G2"_note))->front().tab(), "320003");
+    EXPECT_EQ(gen.voicings(guitar, Chord::minor_triad("E2"_note))->front().tab(), "022000");
+
+    for ( auto& v: *c ) {
+        Chord played = v.chord(guitar);
+        EXPECT_EQ(played.pcset(), PcSet::of({0, 4, 7})) << v.tab();
+        EXPECT_EQ(played[0].tone(), Tone("C")) << v.tab();
+        EXPECT_LE(v.highest() - (v.lowest() ? v.lowest() : v.highest()), 3) << v.tab();
+    }
+    for ( size_t i = 1; i < c->size(); i++ )
+        EXPECT_LE((*c)[i - 1].difficulty, (*c)[i].difficulty);
+
+    // Asked again, the same list comes from the cache
+    EXPECT_EQ(gen.cached(), 3u);
+    EXPECT_EQ(gen.voicings(guitar, Chord::major_triad("C4"_note)), c);
+    EXPECT_EQ(gen.cached(), 3u);
+    guitar.retune(0, "D2"_note);
+    EXPECT_NE(gen.voicings(guitar, Chord::major_triad("C4"_note)), c);
+    EXPECT_EQ(gen.cached(), 4u);
+}
+
+TEST(VoicingTest, options_and_threads) {
+    Fretboard guitar = Fretboard::guitar();
+    VoicingGenerator::Options one;
+    one.threads = 1;
+    one.limit = 200;
+    VoicingGenerator::Options many = one;
+    many.threads = 4;
+    PcSet g7 = PcSet::of({7, 11, 2, 5});
+    auto serial = VoicingGenerator::search(guitar, g7, "G", one);
+    EXPECT_EQ(VoicingGenerator::search(guitar, g7, "G", many), serial);
+
+    bool omitted = false;
+    for ( auto& v: serial ) {
+        PcSet played = v.chord(guitar).pcset();
+        EXPECT_TRUE(PcSet::of({7, 11, 5}).subset_of(played)) << v.tab();
+        omitted = omitted || !played.contains(2);
+    }
+    EXPECT_TRUE(omitted);
+
+    one.omit_fifth = false;
+    for ( auto& v: VoicingGenerator::search(guitar, g7, "G", one) )
+        EXPECT_EQ(v.chord(guitar).pcset(), g7) << v.tab();
+}
+
+TEST(VoiceLeadingTest, smooth_progression) {
+    // Root position and both inversions of each chord, around middle C
+    auto inversions = [](Note root, std::initializer_list<uint8_t> degrees) {
+        std::vector<Chord> found;
+        for ( int i = 0; i < 3; i++ ) {
+            std::vector<Note> notes;
+            Chord c(root, degrees);
+            for ( size_t n = 0; n < c.size(); n++ )
+                notes.push_back(n < size_t(i) ? c[n] + uint8_t(12) : c[n]);
+            found.push_back(Chord(notes));
+        }
+        return found;
+    };
+    std::vector<std::vector<Chord>> steps = {
+        {Chord("C4"_note, {4, 7})},
+        inversions("F3"_note, {4, 7}),
+        inversions("G3"_note, {4, 7}),
+        inversions("C4"_note, {4, 7}),
+    };
+    auto r = VoiceLeading::optimize(steps);
+    ASSERT_EQ(r.choice.size(), 4u);
+    // C E G -> C F A -> B D G (or D G B) -> C E G
+    auto sorted = [](const Chord& c) {
+        auto notes = c.notes();
+        std::sort(notes.begin(), notes.end());
+        return notes;
+    };
+    EXPECT_EQ(sorted(steps[1][r.choice[1]]), (std::vector<Note>{"C4"_note, "F4"_note, "A4"_note}));
+    EXPECT_EQ(sorted(steps[3][r.choice[3]]), (std::vector<Note>{"C4"_note, "E4"_note, "G4"_note}));
+    EXPECT_EQ(r.cost, 3u + 6u + 3u);
+    EXPECT_EQ(VoiceLeading::distance(Chord("C4"_note, {4, 7}), Chord("C4"_note, {4})), 3u);
+    EXPECT_THROW(VoiceLeading::optimize(std::vector<std::vector<Chord>>{{}}), std::invalid_argument);
+}
+
+TEST(VoiceLeadingTest, matches_brute_force) {
+    Fretboard guitar = Fretboard::guitar();
+    VoicingGenerator::Options options;
+    options.limit = 8;
+    VoicingGenerator gen(options);
+    std::vector<Chord> progression = {Chord::major_triad("C3"_note), Chord::minor_triad("A2"_note),
+                                      Chord::major_triad("F2"_note), Chord("G2"_note, {4, 7, 10})};
+    VoiceLeading::Result r;
+    auto shapes = VoiceLeading::voice(gen, guitar, progression, &r);
+    ASSERT_EQ(shapes.size(), 4u);
+
+    std::vector<std::vector<Voicing>> steps;
+    for ( auto& c: progression )
+        steps.push_back(*gen.voicings(guitar, c));
+    uint32_t best = UINT32_MAX;
+    for ( auto& a: steps[0] )
+        for ( auto& b: steps[1] )
+            for ( auto& c: steps[2] )
+                for ( auto& d: steps[3] )
+                    best = std::min(best, VoiceLeading::distance(a, b) + VoiceLeading::distance(b, c)
+                                          + VoiceLeading::distance(c, d));
+    EXPECT_EQ(r.cost, best);
+    uint32_t total = 0;
+    for ( size_t i = 1; i < shapes.size(); i++ )
+        total += VoiceLeading::distance(shapes[i - 1], shapes[i]);
+    EXPECT_EQ(total, r.cost);
+
+    // More tones than strings, rather than a shorter result
+    progression.push_back(Chord("C3"_note, {1, 2, 3, 4, 5, 6}));
+    EXPECT_THROW(VoiceLeading::voice(gen, guitar, progression), std::invalid_argument);
+}
+
+TEST(FingeringTest, scale_runs) {
+    Fretboard guitar = Fretboard::guitar();
+    // A two octave run from G2 is played in first position
+    auto run = Scale::major("G").range("G2"_note, "G4"_note);
+    auto path = Fingering::find(guitar, run);
+    ASSERT_EQ(path.positions.size(), run.size());
+    for ( size_t i = 0; i < run.size(); i++ ) {
+        EXPECT_EQ(guitar.note(path.positions[i]), run[i]);
+        EXPECT_LE(path.positions[i].fret, 4);
+    }
+    EXPECT_EQ(path.positions[0], (Fretboard::Position{0, 3}));
+    EXPECT_EQ(path.finger(0), 3);
+    EXPECT_EQ(path.cost, 0u);
+
+    // Same cost as trying every path
+    std::vector<Note> notes = {"E3"_note, "B3"_note, "D4"_note, "C5"_note};
+    path = Fingering::find(guitar, notes);
+    std::vector<std::vector<Fingering::Choice>> options(notes.size());
+    for ( size_t k = 0; k < notes.size(); k++ )
+        for ( uint8_t s = 0; s < guitar.strings(); s++ )
+            for ( uint8_t f = 0; f <= guitar.playable(); f++ )
+                if ( guitar.note(s, f) == notes[k] )
+                    for ( uint8_t hand = 1; hand <= 31; hand++ )
+                        if ( f == 0 ? hand <= Fingering::reach + 1 : hand <= f && f <= hand + Fingering::reach )
+                            options[k].push_back({{s, f}, hand});
+    Fingering::Costs costs;
+    uint32_t best = UINT32_MAX;
+    std::vector<size_t> pick(notes.size(), 0);
+    while ( true ) {
+        uint32_t total = Fingering::cost(options[0][pick[0]], options[0][pick[0]], costs);
+        for ( size_t k = 1; k < notes.size(); k++ )
+            total += Fingering::cost(options[k - 1][pick[k - 1]], options[k][pick[k]], costs);
+        best = std::min(best, total);
+        size_t k = 0;
+        while ( k < notes.size() && ++pick[k] == options[k].size() )
+            pick[k++] = 0;
+        if ( k == notes.size() )
+            break;
+    }
+    EXPECT_EQ(path.cost, best);
+
+    EXPECT_TRUE(Fingering::find(guitar, std::vector<Note>{}).positions.empty());
+    EXPECT_THROW(Fingering::find(guitar, std::vector<Note>{"C1"_note}), std::invalid_argument);
+}
+
+TEST(ScaleTest, lazy_views) {
+    const Scale c_major = Scale::major("C");
+    std::vector<Note> expected = {60, 62, 64, 65, 67, 69, 71, 72};
+    EXPECT_EQ(c_major.range(60, 72), expected);
+    EXPECT_EQ(std::vector<Note>(c_major.notes_between(60, 72).begin(), c_major.notes_between(60, 72).end()), expected);
+    EXPECT_EQ(c_major.notes_between(60, 72).size(), 8u);
+    EXPECT_EQ(c_major.notes_between(61, 61).size(), 0u);
+    EXPECT_TRUE(c_major.notes_between(72, 60).empty());
+    EXPECT_EQ(*c_major.notes("C#4"_note).begin(), "D4"_note);
+    EXPECT_EQ(c_major.tones(), (std::vector<Tone>{"C", "D", "E", "F", "G", "A", "B"}));
+
+    // Exercises over the whole MIDI range, for every mode and root,
+    // and over const and temporary chords
+    const Chord triad = Chord::major_triad("C4"_note);
+    size_t before = allocations;
+    size_t notes = 0, counted = 0, tones = 0, sum = 0;
+    for ( uint8_t root = 0; root < 12; root++ ) {
+        for ( Scale s: {Scale::ionian(root), Scale::dorian(root), Scale::phrygian(root), Scale::lydian(root),
+                        Scale::mixolydian(root), Scale::aeolian(root), Scale::locrian(root)} ) {
+            for ( Note n: s.notes() ) {
+                notes++;
+                sum += n.note();
+            }
+            for ( Note n: s.notes_between(0, 127) )
+                sum += n.note();
+            counted += s.notes_between(0, 127).size();
+            for ( Tone t: s.tones() ) {
+                tones++;
+                sum += t.tone();
+            }
+        }
+        for ( Note n: triad )
+            sum += n.note();
+        for ( Note n: Chord::minor_triad(Note(uint8_t(48 + root))) )
+            sum += n.note();
+    }
+    size_t after = allocations;
+    EXPECT_EQ(after, before);
+    EXPECT_EQ(notes, counted);
+    EXPECT_EQ(tones, 12u * 7 * 7);
+    EXPECT_GT(sum, 0u);
+    // 128 notes is 10 octaves and 8 notes; C major has 5 of those 8
+    EXPECT_EQ(c_major.notes().size(), 75u);
+}
+
+TEST(ScaleTest, quantize) {
+    const Scale c_major = Scale::major("C");
+    EXPECT_EQ(c_major.quantize("C#4"_note), "C4"_note);
+    EXPECT_EQ(c_major.quantize("C#4"_note, Scale::Round::Up), "D4"_note);
+    EXPECT_EQ(c_major.quantize("F#4"_note, Scale::Round::Down), "F4"_note);
+    EXPECT_EQ(c_major.quantize("E4"_note, Scale::Round::Up), "E4"_note);
+    // Past the highest G of MIDI, only down is left
+    EXPECT_EQ(c_major.quantize(Note(127), Scale::Round::Up), Note(127));
+    EXPECT_EQ(Scale::major("A").quantize(Note(0), Scale::Round::Down), Note(1));
+
+    // Against searching the nearest note, for every scale, rounding and note
+    for ( uint8_t root = 0; root < 12; root++ ) {
+        for ( Scale s: {Scale::major(root), Scale::minor(root), Scale(root, {0, 3, 5, 7, 10}), Scale(root, {0})} ) {
+            for ( auto round: {Scale::Round::Down, Scale::Round::Up, Scale::Round::Nearest} ) {
+                for ( int n = 0; n < 128; n++ ) {
+                    int best = -1;
+                    for ( int m = 0; m < 128; m++ ) {
+                        if ( !s.contains(Note(uint8_t(m))) )
+                            continue;
+                        bool wrong_way = (round == Scale::Round::Down && m > n) || (round == Scale::Round::Up && m < n);
+                        bool best_wrong_way = best >= 0 && ((round == Scale::Round::Down && best > n) ||
+                                                            (round == Scale::Round::Up && best < n));
+                        // Prefer the right direction, then the closer, then the lower
+                        if ( best < 0 || (best_wrong_way && !wrong_way) ||
+                             (best_wrong_way == wrong_way && std::abs(m - n) < std::abs(best - n)) )
+                            best = m;
+                    }
+                    ASSERT_EQ(s.quantize(Note(uint8_t(n)), round).note(), best) << int(root) << " " << n;
+                }
+            }
+        }
+    }
+
+    // Cached per set of tones, so every mode of C major shares one table
+    EXPECT_EQ(&Scale::dorian("D").quantizer(), &c_major.quantizer());
+    std::vector<Note> notes = {"C#4"_note, "D#4"_note, "F#4"_note, "G#4"_note};
+    std::vector<uint8_t> raw = {61, 63, 66, 68};
+    size_t before = allocations;
+    c_major.quantize(notes, Scale::Round::Up);
+    c_major.quantizer(Scale::Round::Up)(raw);
+    EXPECT_EQ(allocations, before);
+    EXPECT_EQ(notes, (std::vector<Note>{"D4"_note, "E4"_note, "G4"_note, "A4"_note}));
+    EXPECT_EQ(raw, (std::vector<uint8_t>{62, 64, 67, 69}));
+
+    constexpr Scale::Quantizer pentatonic(PcSet::of({0, 2, 4, 7, 9}), Scale::Round::Nearest);
+    static_assert(pentatonic[65] == 64, "Quantizer tables are built at compile time");
+}
+
+template <class L>
+void expect_bulk_matches_notes() {
+    // Every note, with a tail that does not fill a vector
+    std::vector<uint8_t> raw(128 * 3 + 7);
+    for ( size_t i = 0; i < raw.size(); i++ )
+        raw[i] = uint8_t(i * 37 + i / 5);
+
+    for ( int interval: {0, 5, -3, 127, -128, 300} ) {
+        std::vector<uint8_t> moved = raw;
+        BulkNotes::transpose<L>(moved, interval);
+        for ( size_t i = 0; i < raw.size(); i++ ) {
+            Note n(raw[i]);
+            Note by_op = interval < 0 ? n - uint8_t(-interval) : n + uint8_t(interval);
+            ASSERT_EQ(moved[i], by_op.note()) << L::name << " " << interval << " " << int(raw[i]);
+        }
+    }
+
+    std::vector<uint8_t> pcs(raw.size());
+    BulkNotes::pitch_classes<L>(raw, pcs.data());
+    std::array<uint32_t, 12> expected{};
+    for ( size_t i = 0; i < raw.size(); i++ ) {
+        ASSERT_EQ(pcs[i], Note(raw[i]).tone().tone()) << L::name << " " << int(raw[i]);
+        expected[pcs[i]]++;
+    }
+    EXPECT_EQ(BulkNotes::histogram<L>(raw), expected) << L::name;
+    // Long enough for the byte counters to be emptied several times
+    std::vector<uint8_t> many(100000, 61);
+    EXPECT_EQ(BulkNotes::histogram<L>(many)[1], 100000u) << L::name;
+
+    std::vector<int8_t> steps(raw.size() - 1);
+    BulkNotes::intervals<L>(raw, steps.data());
+    for ( size_t i = 0; i + 1 < raw.size(); i++ )
+        ASSERT_EQ(steps[i], Note(raw[i + 1]) - Note(raw[i])) << L::name << " " << i;
+
+    std::vector<uint8_t> clamped = raw;
+    BulkNotes::clamp<L>(clamped, 40, 88);
+    for ( size_t i = 0; i < raw.size(); i++ )
+        ASSERT_EQ(clamped[i], std::min(std::max(Note(raw[i]).note(), uint8_t(40)), uint8_t(88))) << L::name;
+}
+
+TEST(BulkNotesTest, matches_note_arithmetic) {
+    // Wrapping the same way, whether adding or adding to
+    Note high(120);
+    EXPECT_EQ(high + uint8_t(10), Note(2));
+    EXPECT_EQ(high += 10, Note(2));
+    Note low(3);
+    EXPECT_EQ(low - uint8_t(5), Note(126));
+    EXPECT_EQ(low -= 5, Note(126));
+
+    expect_bulk_matches_notes<BulkNotes::Scalar>();
+#ifdef SUPERFRET_SSE2
+    expect_bulk_matches_notes<BulkNotes::Sse2>();
+#endif
+#ifdef SUPERFRET_AVX2
+    expect_bulk_matches_notes<BulkNotes::Avx2>();
+#endif
+
+    std::vector<Note> notes = {"C4"_note, "E4"_note, "G4"_note, "C5"_note, "B7"_note};
+    size_t before = allocations;
+    BulkNotes::transpose(notes, -12);
+    BulkNotes::clamp(notes, "C3"_note, "C6"_note);
+    EXPECT_EQ(allocations, before);
+    EXPECT_EQ(notes, (std::vector<Note>{"C3"_note, "E3"_note, "G3"_note, "C4"_note, "C6"_note}));
+    EXPECT_EQ(BulkNotes::pcset(notes), PcSet::of({0, 4, 7}));
+    EXPECT_EQ(BulkNotes::pcset(notes).interval_vector(), (std::array<uint8_t, 6>{0, 0, 1, 1, 1, 0}));
+}